@@ -0,0 +1,267 @@
+// Benchmark do carregamento da cena sem OpenGL: parse do OBJ com o MTL e a
+// leitura do cache binário (loadMeshSource, a parte de loadSimpleOBJ antes
+// do envio à GPU, com uma soma que percorre vértices e índices), loadMTL,
+// parseSceneConfig (leitura e parse do arquivo; aplicar a cena e carregar os
+// objetos fica de fora), Trajectory::getCurrentPosition
+// e a construção das matrizes model/normal de Transform. Cada medida roda em
+// entradas sintéticas de tamanho crescente, confere o resultado e vai para
+// um JSON (nome, tamanho, min/media/max em ms) para comparar execuções.
+//
+// Uso: AssetPipelineBench [saida.json] [faces_maximas]
+// Padrão: asset_pipeline_bench.json e 1000000 faces.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "BenchUtils.h"
+#include "SceneConfig.h"
+#include "SceneData.h"
+
+using namespace std;
+
+static const glm::vec3 MTL_KD(0.25f, 0.5f, 0.75f);
+
+// Um MTL com `lines` linhas; o último Kd é MTL_KD.
+bool writeMTL(const string& path, long long lines) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    fprintf(f, "newmtl bench\nKa 0.1 0.1 0.1\nKs 0.5 0.5 0.5\nNs 64\nmap_Kd bench.png\n");
+    for (long long i = 5; i < lines; ++i) fprintf(f, "Kd %.6f 0.5 0.5\n", (i % 100) / 100.0);
+    fprintf(f, "Kd %.6f %.6f %.6f\n", MTL_KD.r, MTL_KD.g, MTL_KD.b);
+    fclose(f);
+    return true;
+}
+
+// Grade triangulada com v/vt/vn, `faces` triângulos (arredondado para par)
+// e mtllib apontando para `mtlFile`.
+bool writeGridOBJ(const string& path, const string& mtlFile, long long faces) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    long long n = (long long)ceil(sqrt(faces / 2.0));
+    long long side = n + 1;
+    fprintf(f, "mtllib %s\n", mtlFile.c_str());
+    for (long long j = 0; j < side; ++j) {
+        for (long long i = 0; i < side; ++i) fprintf(f, "v %.6f 0 %.6f\n", i / (double)n, j / (double)n);
+    }
+    for (long long j = 0; j < side; ++j) {
+        for (long long i = 0; i < side; ++i) fprintf(f, "vt %.6f %.6f\n", i / (double)n, j / (double)n);
+    }
+    fprintf(f, "vn 0 1 0\n");
+    for (long long written = 0, cell = 0; written < faces; ++cell, written += 2) {
+        long long a = (cell / n) * side + cell % n + 1, b = a + 1, c = a + side, d = c + 1;
+        fprintf(f, "f %lld/%lld/1 %lld/%lld/1 %lld/%lld/1\n", a, a, c, c, b, b);
+        fprintf(f, "f %lld/%lld/1 %lld/%lld/1 %lld/%lld/1\n", b, b, c, c, d, d);
+    }
+    fclose(f);
+    return true;
+}
+
+// Cena com algumas opções e luzes e `objects` objetos, cada um com 8
+// pontos de trajetória.
+bool writeSceneConfig(const string& path, int objects) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    fprintf(f, "# cena gerada\n[render]\nrenderer = forward\nculling = true\n\n[camera]\nposition = 0, 2, 8\n\n[lights]\n");
+    for (int i = 0; i < 4; ++i) {
+        fprintf(f, "position = %d, 5, 0\ndiffuse = 0.8, 0.8, 0.8\nintensity = 1.0\nend = true\n", i);
+    }
+    fprintf(f, "\n[objects]\n");
+    for (int i = 0; i < objects; ++i) {
+        fprintf(f, "name = Objeto %d\nfile = modelo.obj\ntranslation = %d, 0, %d\nrotation = 0, %d, 0\nscale = 1.5\n",
+                i, i % 100, i / 100, i % 360);
+        fprintf(f, "trajectory_points = 0, 0, 0; 1, 0, 0; 1, 0, 1; 0, 0, 1; 0, 1, 0; 1, 1, 0; 1, 1, 1; 0, 1, 1\n");
+        fprintf(f, "trajectory_speed = 2.0\nend = true\n");
+    }
+    fclose(f);
+    return true;
+}
+
+// O que a checagem usa de uma MeshSource, que não pode ser copiada. A soma
+// lê todos os vértices e índices: sem ela a medida do cache cobriria só o
+// mmap e a validação do cabeçalho, não as páginas da malha.
+struct MeshSummary {
+    bool ok = false;
+    bool fromCache = false;
+    size_t vertexFloatCount = 0;
+    size_t indexCount = 0;
+    double checksum = 0.0;
+    Material material;
+};
+
+MeshSummary loadSummary(const string& path, const MeshLoadOptions& options) {
+    MeshSource source;
+    MeshSummary summary;
+    summary.ok = loadMeshSource(path, options, source);
+    summary.fromCache = source.fromCache;
+    summary.vertexFloatCount = source.vertexFloatCount;
+    summary.indexCount = source.indexCount;
+    summary.material = source.material;
+    for (size_t i = 0; i < source.vertexFloatCount; ++i) summary.checksum += source.vertices[i];
+    for (size_t i = 0; i < source.indexCount; ++i) summary.checksum += source.indices[i];
+    return summary;
+}
+
+int benchMeshes(BenchReport& report, long long maxFaces) {
+    int failures = 0;
+    if (!writeMTL("bench_pipeline.mtl", 8)) return 1;
+    for (long long faces = 1000; faces <= maxFaces; faces *= 10) {
+        string objPath = "bench_pipeline_" + to_string(faces) + ".obj";
+        if (!writeGridOBJ(objPath, "bench_pipeline.mtl", faces)) return failures + 1;
+        int iterations = faces >= 1000000 ? 3 : 10;
+
+        MeshLoadOptions parseOnly = { false, "", nullptr };
+        MeshLoadOptions withCache = { true, "", nullptr };
+        MeshSummary parsed, cached;
+        report.add("loadMeshSource parse", faces, measure([&] { parsed = loadSummary(objPath, parseOnly); }, iterations));
+        // A primeira leitura com cache grava o .meshbin; as seguintes o leem.
+        loadSummary(objPath, withCache);
+        report.add("loadMeshSource cache", faces, measure([&] { cached = loadSummary(objPath, withCache); }, iterations));
+
+        if (!parsed.ok || parsed.fromCache || !cached.fromCache || parsed.indexCount != (size_t)faces * 3 ||
+            cached.indexCount != parsed.indexCount || cached.vertexFloatCount != parsed.vertexFloatCount ||
+            cached.checksum != parsed.checksum ||
+            parsed.material.Kd != MTL_KD || cached.material.Kd != MTL_KD || !cached.material.hasTexture) {
+            fprintf(stderr, "ERRO: malha de %lld faces lida errado (%zu indices, cache %d)\n", faces, parsed.indexCount,
+                    (int)cached.fromCache);
+            failures++;
+        }
+        remove(meshCachePath(objPath, "").c_str());
+        remove(objPath.c_str());
+    }
+    remove("bench_pipeline.mtl");
+    return failures;
+}
+
+int benchMaterials(BenchReport& report) {
+    int failures = 0;
+    for (long long lines = 10; lines <= 100000; lines *= 10) {
+        string path = "bench_pipeline_" + to_string(lines) + ".mtl";
+        if (!writeMTL(path, lines)) return failures + 1;
+        Material material;
+        report.add("loadMTL", lines, measure([&] { material = loadMTL(path); }, 10));
+        if (material.Kd != MTL_KD || material.Ns != 64.0f || material.map_Kd_path != "bench.png") {
+            fprintf(stderr, "ERRO: MTL de %lld linhas lido errado\n", lines);
+            failures++;
+        }
+        remove(path.c_str());
+    }
+    return failures;
+}
+
+int benchSceneConfig(BenchReport& report) {
+    int failures = 0;
+    for (int objects = 10; objects <= 10000; objects *= 10) {
+        string path = "bench_pipeline_" + to_string(objects) + ".txt";
+        if (!writeSceneConfig(path, objects)) return failures + 1;
+        SceneConfig config;
+        report.add("parseSceneConfig leitura+parse", objects, measure([&] { parseSceneConfig(path, config); }, 10));
+        const SceneObjectConfig& last = config.objects.empty() ? SceneObjectConfig() : config.objects.back();
+        if (config.objects.size() != (size_t)objects || config.lights.size() != 4 || config.settings.size() != 3 ||
+            last.trajectory.points.size() != 8 || last.transform.getScale() != 1.5f ||
+            last.transform.getTranslation() != glm::vec3((objects - 1) % 100, 0, (objects - 1) / 100)) {
+            fprintf(stderr, "ERRO: cena com %d objetos lida errado (%zu objetos, %zu luzes, %zu opcoes)\n", objects,
+                    config.objects.size(), config.lights.size(), config.settings.size());
+            failures++;
+        }
+        remove(path.c_str());
+    }
+    return failures;
+}
+
+int benchTrajectories(BenchReport& report) {
+    int failures = 0;
+    const int steps = 1000000;
+    for (int count = 2; count <= 4096; count *= 8) {
+        // Pontos num círculo de raio 5: toda posição interpolada fica dentro dele.
+        Trajectory trajectory;
+        for (int i = 0; i < count; ++i) {
+            float angle = 6.2831853f * i / count;
+            trajectory.addPoint(glm::vec3(5.0f * cos(angle), 0.0f, 5.0f * sin(angle)));
+        }
+        glm::vec3 sum(0.0f);
+        bool inside = true;
+        report.add("getCurrentPosition 1e6 passos", count, measure([&] {
+            for (int i = 0; i < steps; ++i) {
+                glm::vec3 p = trajectory.getCurrentPosition(1.0f / 60.0f);
+                inside = inside && glm::length(p) <= 5.0001f;
+                sum += p;
+            }
+        }, 5));
+        if (!inside || !std::isfinite(sum.x)) {
+            fprintf(stderr, "ERRO: trajetoria com %d pontos saiu do circulo\n", count);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int benchTransforms(BenchReport& report) {
+    int failures = 0;
+    for (int count = 1000; count <= 1000000; count *= 10) {
+        vector<Transform> transforms(count);
+        for (int i = 0; i < count; ++i) {
+            transforms[i].setTranslation(glm::vec3(i % 100, 0.0f, i / 100));
+            transforms[i].setScale(0.5f + (i % 4));
+        }
+        glm::vec4 checksum(0.0f);
+        float angle = 0.0f;
+        // Rotação nova em todos (o caso da cena animada) e só a leitura do cache.
+        report.add("Transform model/normal recalculadas", count, measure([&] {
+            angle += 0.01f;
+            for (Transform& transform : transforms) {
+                transform.setRotation(glm::vec3(angle, 2.0f * angle, 0.0f));
+                checksum += transform.getModelMatrix()[0] + glm::vec4(transform.getNormalMatrix()[0], 0.0f);
+            }
+        }, 10));
+        report.add("Transform model/normal em cache", count, measure([&] {
+            for (Transform& transform : transforms) {
+                checksum += transform.getModelMatrix()[0] + glm::vec4(transform.getNormalMatrix()[0], 0.0f);
+            }
+        }, 10));
+
+        // Referência: T * Rx * Ry * Rz * S, e a normal como transpose(inverse).
+        const Transform& last = transforms.back();
+        glm::mat4 expected = glm::translate(glm::mat4(1.0f), last.getTranslation());
+        expected = glm::rotate(expected, last.getRotation().x, glm::vec3(1.0f, 0.0f, 0.0f));
+        expected = glm::rotate(expected, last.getRotation().y, glm::vec3(0.0f, 1.0f, 0.0f));
+        expected = glm::rotate(expected, last.getRotation().z, glm::vec3(0.0f, 0.0f, 1.0f));
+        expected = glm::scale(expected, glm::vec3(last.getScale()));
+        glm::mat3 expectedNormal = glm::transpose(glm::inverse(glm::mat3(expected))) * last.getScale();
+        float error = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) error = max(error, fabs(transforms.back().getModelMatrix()[c][r] - expected[c][r]));
+            for (int r = 0; c < 3 && r < 3; ++r) {
+                error = max(error, fabs(transforms.back().getNormalMatrix()[c][r] - expectedNormal[c][r]));
+            }
+        }
+        if (error > 1e-4f || !std::isfinite(checksum.x)) {
+            fprintf(stderr, "ERRO: matrizes de Transform diferem da referencia (erro %g)\n", error);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    string jsonPath = argc > 1 ? argv[1] : "asset_pipeline_bench.json";
+    long long maxFaces = argc > 2 ? atoll(argv[2]) : 1000000LL;
+
+    BenchReport report;
+    int failures = 0;
+    failures += benchMeshes(report, maxFaces);
+    failures += benchMaterials(report);
+    failures += benchSceneConfig(report);
+    failures += benchTrajectories(report);
+    failures += benchTransforms(report);
+
+    if (!report.writeJson(jsonPath, "AssetPipelineBench")) {
+        fprintf(stderr, "ERRO: nao foi possivel gravar %s\n", jsonPath.c_str());
+        failures++;
+    } else {
+        printf("\n%zu medidas gravadas em %s\n", report.size(), jsonPath.c_str());
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+// Utilitários compartilhados pelos benchmarks (sem dependência de OpenGL).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BenchResult {
+    double minMs = 0.0;
+    double meanMs = 0.0;
+    double maxMs = 0.0;
+};
+
+// Executa `fn` `iterations` vezes e devolve min/média/máx em milissegundos.
+inline BenchResult measure(const std::function<void()>& fn, int iterations) {
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    BenchResult r;
+    if (samples.empty()) return r;
+    r.minMs = *std::min_element(samples.begin(), samples.end());
+    r.maxMs = *std::max_element(samples.begin(), samples.end());
+    for (double s : samples) r.meanMs += s;
+    r.meanMs /= samples.size();
+    return r;
+}
+
+inline void printResult(const std::string& name, const BenchResult& r) {
+    printf("%-40s min %10.3f ms   media %10.3f ms   max %10.3f ms\n", name.c_str(), r.minMs, r.meanMs, r.maxMs);
+}
+
+// Resultados em formato legível por máquina, para comparar execuções: cada
+// medida leva um nome, o tamanho da entrada e os tempos em milissegundos.
+class BenchReport {
+public:
+    void add(const std::string& name, long long size, const BenchResult& r) {
+        entries.push_back({ name, size, r });
+        printResult(name + " (" + std::to_string(size) + ")", r);
+    }
+
+    size_t size() const { return entries.size(); }
+
+    // {"benchmark": ..., "results": [{"name", "size", "min_ms", "mean_ms", "max_ms"}, ...]}
+    bool writeJson(const std::string& path, const std::string& benchmark) const {
+        FILE* f = fopen(path.c_str(), "w");
+        if (!f) return false;
+        fprintf(f, "{\"benchmark\":\"%s\",\"results\":[", benchmark.c_str());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const Entry& e = entries[i];
+            fprintf(f, "%s\n{\"name\":\"%s\",\"size\":%lld,\"min_ms\":%.6f,\"mean_ms\":%.6f,\"max_ms\":%.6f}",
+                    i == 0 ? "" : ",", e.name.c_str(), e.size, e.result.minMs, e.result.meanMs, e.result.maxMs);
+        }
+        fprintf(f, "\n]}\n");
+        return fclose(f) == 0;
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        long long size;
+        BenchResult result;
+    };
+    std::vector<Entry> entries;
+};
@@ -0,0 +1,145 @@
+// Benchmark da ordenação de draws por chave de estado (src/DrawSort.h) em
+// uma lista sintética de objetos com texturas e materiais misturados.
+// Compara o radix sort com std::stable_sort, confere que os dois produzem
+// a mesma ordem e conta as trocas de textura e de material na ordem do
+// arquivo, na ordem da frente para trás e na ordem da chave de estado.
+//
+// Uso: DrawSortBench [draws] [iteracoes] [texturas] [materiais]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "BenchUtils.h"
+#include "DrawSort.h"
+
+using namespace std;
+
+struct SceneDraw {
+    uint32_t textureID;
+    uint32_t materialID;
+    float depth;
+};
+
+// Texturas e materiais sorteados por objeto, como numa cena montada à mão.
+// Nomes de textura do GL começam em 1; um quarto dos objetos não tem textura.
+static vector<SceneDraw> randomDraws(size_t count, uint32_t textures, uint32_t materials, mt19937& rng) {
+    uniform_int_distribution<uint32_t> texture(0, textures * 4 / 3);
+    uniform_int_distribution<uint32_t> material(1, materials);
+    uniform_real_distribution<float> depth(0.1f, 100.0f);
+    vector<SceneDraw> draws(count);
+    for (auto& draw : draws) {
+        uint32_t t = texture(rng);
+        draw.textureID = t > textures ? 0 : t + 1;
+        draw.materialID = material(rng);
+        draw.depth = depth(rng);
+    }
+    return draws;
+}
+
+static void buildItems(const vector<SceneDraw>& draws, DrawSlotTable& textureSlots, DrawSlotTable& materialSlots,
+                       vector<DrawItem>& items) {
+    items.clear();
+    textureSlots.clear();
+    materialSlots.clear();
+    for (size_t i = 0; i < draws.size(); ++i) {
+        const SceneDraw& draw = draws[i];
+        uint32_t texture = textureSlots.slot(draw.textureID);
+        uint32_t material = materialSlots.slot(draw.materialID);
+        items.push_back({ makeDrawKey(0, 0, texture, material, draw.depth), (uint32_t)i });
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t drawCount = argc > 1 ? (size_t)atoll(argv[1]) : 20000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 100;
+    uint32_t textureCount = argc > 3 ? (uint32_t)atoi(argv[3]) : 16;
+    uint32_t materialCount = argc > 4 ? (uint32_t)atoi(argv[4]) : 64;
+
+    mt19937 rng(42);
+    vector<SceneDraw> draws = randomDraws(drawCount, textureCount, materialCount, rng);
+    DrawSlotTable textureSlots(DRAW_KEY_TEXTURE_BITS), materialSlots(DRAW_KEY_MATERIAL_BITS);
+
+    printf("Draws: %zu   texturas: %u   materiais: %u\n\n", drawCount, textureCount, materialCount);
+
+    vector<DrawItem> items, scratch, reference;
+    buildItems(draws, textureSlots, materialSlots, reference);
+    printResult("montagem das chaves", measure([&] {
+        buildItems(draws, textureSlots, materialSlots, items);
+    }, iterations));
+
+    vector<DrawItem> unsorted = reference;
+    printResult("std::stable_sort", measure([&] {
+        reference = unsorted;
+        stable_sort(reference.begin(), reference.end(), [](const DrawItem& a, const DrawItem& b) { return a.key < b.key; });
+    }, iterations));
+    printResult("radix sort (8 bits por passada)", measure([&] {
+        items = unsorted;
+        radixSortDrawItems(items, scratch);
+    }, iterations));
+
+    int failures = 0;
+    for (size_t i = 0; i < drawCount; ++i) {
+        if (items[i].key != reference[i].key || items[i].index != reference[i].index) {
+            fprintf(stderr, "ERRO: radix sort e std::stable_sort divergem na posicao %zu\n", i);
+            failures++;
+            break;
+        }
+    }
+
+    // Chaves com os campos de estado constantes pulam as passadas altas.
+    vector<DrawItem> depthOnly(drawCount);
+    for (size_t i = 0; i < drawCount; ++i) depthOnly[i] = { makeDrawKey(0, 0, 0, 0, draws[i].depth), (uint32_t)i };
+    vector<DrawItem> depthInput = depthOnly;
+    printResult("radix sort (so profundidade)", measure([&] {
+        depthOnly = depthInput;
+        radixSortDrawItems(depthOnly, scratch);
+    }, iterations));
+    for (size_t i = 1; i < drawCount; ++i) {
+        if (draws[depthOnly[i - 1].index].depth > draws[depthOnly[i].index].depth) {
+            fprintf(stderr, "ERRO: ordenacao por profundidade fora de ordem na posicao %zu\n", i);
+            failures++;
+            break;
+        }
+    }
+
+    printf("\nTrocas de estado por quadro (%zu draws):\n", drawCount);
+    printf("  %-28s %8s %10s %8s\n", "ordem", "texturas", "materiais", "total");
+    printf("  %-28s %8zu %10zu %8zu\n", "sem cache de estado", drawCount, drawCount, 2 * drawCount);
+    buildItems(draws, textureSlots, materialSlots, items);
+    StateChangeCount fileChanges = countStateChanges(items);
+    stable_sort(items.begin(), items.end(), [&](const DrawItem& a, const DrawItem& b) {
+        return draws[a.index].depth < draws[b.index].depth;
+    });
+    StateChangeCount depthChanges = countStateChanges(items);
+    radixSortDrawItems(items, scratch);
+    StateChangeCount sortedChanges = countStateChanges(items);
+    for (const auto& row : { make_pair("arquivo", fileChanges), make_pair("frente para tras", depthChanges),
+                             make_pair("chave de estado", sortedChanges) }) {
+        printf("  %-28s %8zu %10zu %8zu\n", row.first, row.second.textures, row.second.materials,
+               row.second.textures + row.second.materials);
+    }
+
+    // Ordenado por textura e depois material, cada textura troca uma vez e
+    // cada par (textura, material) distinto troca o material uma vez.
+    size_t distinctTextures = 0, distinctPairs = 0;
+    {
+        vector<uint64_t> pairs;
+        for (const SceneDraw& draw : draws) pairs.push_back((uint64_t)draw.textureID << 32 | draw.materialID);
+        sort(pairs.begin(), pairs.end());
+        pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+        distinctPairs = pairs.size();
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            if (i == 0 || (pairs[i] >> 32) != (pairs[i - 1] >> 32)) distinctTextures++;
+        }
+    }
+    if (sortedChanges.textures != distinctTextures || sortedChanges.materials != distinctPairs) {
+        fprintf(stderr, "ERRO: esperado %zu trocas de textura e %zu de material na ordem por estado\n",
+                distinctTextures, distinctPairs);
+        failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+// Benchmark do perfil de quadros (src/FrameProfiler.h): custo de um escopo
+// de CPU aberto e fechado, com o perfil ligado e desligado, e de um quadro
+// com a quantidade de escopos do laço principal do Final. Confere os
+// percentis em dados conhecidos, o aninhamento dos escopos, a posição dos
+// tempos de GPU que chegam atrasados e o trace gravado.
+//
+// Uso: FrameProfilerBench [escopos] [iteracoes]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "BenchUtils.h"
+#include "FrameProfiler.h"
+
+using namespace std;
+
+static const char* const FRAME_SCOPES[] = {
+    "entrada", "trajetorias", "culling", "luzes e uniforms", "submissao",
+    "pre-passe", "passe opaco", "piramide Hi-Z", "visualizacao de trajetorias", "apresentacao",
+};
+
+int main(int argc, char** argv) {
+    int scopeCount = argc > 1 ? atoi(argv[1]) : 1000000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 10;
+    int failures = 0;
+
+    printf("Escopos por medida: %d\n\n", scopeCount);
+
+    FrameProfiler profiler;
+    profiler.setHistory(0);
+    profiler.beginFrame(0);
+    BenchResult enabled = measure([&] {
+        for (int i = 0; i < scopeCount; ++i) {
+            profiler.begin("escopo");
+            profiler.end();
+        }
+    }, iterations);
+    printResult("escopo (perfil ligado)", enabled);
+    profiler.setEnabled(false);
+    printResult("escopo (perfil desligado)", measure([&] {
+        for (int i = 0; i < scopeCount; ++i) {
+            ProfileScope scope(profiler, "escopo");
+        }
+    }, iterations));
+    printf("  %.1f ns por escopo com o perfil ligado\n", 1e6 * enabled.meanMs / scopeCount);
+
+    // Um quadro como o do Final, guardando o trace dos últimos 300.
+    FrameProfiler frames;
+    uint64_t frameIndex = 0;
+    int frameCount = max(1, scopeCount / 10);
+    printResult("quadro com 10 escopos + 3 passes de GPU", measure([&] {
+        for (int i = 0; i < frameCount; ++i) {
+            frames.beginFrame(frameIndex);
+            for (const char* name : FRAME_SCOPES) {
+                frames.begin(name);
+                frames.end();
+            }
+            if (frameIndex >= 2) {
+                for (const char* pass : { "culling", "passe opaco", "piramide Hi-Z" }) frames.addGpuTime(pass, frameIndex - 2, 1e5);
+            }
+            frames.endFrame();
+            frameIndex++;
+        }
+    }, iterations));
+
+    // Percentis pelo posto mais próximo em 1..100.
+    RollingSamples samples(100);
+    for (int i = 100; i >= 1; --i) samples.add(i);
+    if (samples.percentile(50.0) != 50.0 || samples.percentile(95.0) != 95.0 || samples.percentile(99.0) != 99.0 ||
+        samples.percentile(100.0) != 100.0 || samples.average() != 50.5) {
+        fprintf(stderr, "ERRO: percentis de 1..100 errados (p50 %.1f, p95 %.1f, p99 %.1f)\n",
+                samples.percentile(50.0), samples.percentile(95.0), samples.percentile(99.0));
+        failures++;
+    }
+    // A janela guarda só as mais recentes.
+    for (int i = 0; i < 100; ++i) samples.add(1000.0);
+    if (samples.count() != 100 || samples.percentile(1.0) != 1000.0) {
+        fprintf(stderr, "ERRO: a janela de amostras nao descartou as antigas\n");
+        failures++;
+    }
+
+    // Aninhamento e tempos de GPU entregues dois quadros depois.
+    FrameProfiler nested;
+    for (uint64_t frame = 0; frame < 3; ++frame) {
+        nested.beginFrame(frame);
+        nested.begin("externo");
+        nested.begin("interno");
+        nested.end();
+        nested.end();
+        if (frame == 2) nested.addGpuTime("passe", 0, 2e6);
+        nested.endFrame();
+    }
+    const ProfileFrame& first = nested.storedFrame(0);
+    if (nested.storedFrames() != 3 || first.cpu.size() != 2 || first.cpu[0].depth != 1 || first.cpu[1].depth != 0 ||
+        first.cpu[0].start < first.cpu[1].start || first.cpu[0].duration > first.cpu[1].duration) {
+        fprintf(stderr, "ERRO: escopos aninhados registrados errado\n");
+        failures++;
+    }
+    if (first.gpu.size() != 1 || first.gpu[0].start != first.start || first.gpu[0].duration != 2000.0) {
+        fprintf(stderr, "ERRO: tempo de GPU atrasado nao caiu no quadro de origem\n");
+        failures++;
+    }
+    if (nested.gpuFrameTime(0) != 2.0 || nested.gpuFrameTime(1) != -1.0) {
+        fprintf(stderr, "ERRO: soma de GPU por quadro errada (%.3f ms no quadro 0)\n", nested.gpuFrameTime(0));
+        failures++;
+    }
+
+    string tracePath = "frame_profiler_bench_trace.json";
+    if (!frames.writeChromeTrace(tracePath)) {
+        fprintf(stderr, "ERRO: nao foi possivel gravar %s\n", tracePath.c_str());
+        failures++;
+    } else {
+        FILE* f = fopen(tracePath.c_str(), "rb");
+        string text;
+        char buffer[4096];
+        size_t n;
+        while (f && (n = fread(buffer, 1, sizeof(buffer), f)) > 0) text.append(buffer, n);
+        if (f) fclose(f);
+        remove(tracePath.c_str());
+        size_t events = 0;
+        for (size_t pos = 0; (pos = text.find("\"ph\":\"X\"", pos)) != string::npos; ++pos) events++;
+        // Até 300 quadros guardados, cada um com o próprio evento e 10
+        // escopos; os 3 passes de GPU faltam nos 2 últimos.
+        size_t stored = min<size_t>(300, frameIndex);
+        size_t expected = stored * 11 + (stored > 2 ? stored - 2 : 0) * 3;
+        printf("\nTrace: %zu eventos, %zu bytes\n", events, text.size());
+        if (text.compare(0, 2, "{\"") != 0 || text.find("\n]}") == string::npos || events != expected) {
+            fprintf(stderr, "ERRO: trace com %zu eventos, esperado %zu\n", events, expected);
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// Benchmark do frustum culling em uma cena sintética de 100k objetos.
+// Compara o teste ingênuo (8 cantos de cada caixa transformados e testados
+// um a um), o teste escalar no layout SoA e o teste SIMD, e confere que os
+// dois últimos marcam exatamente os mesmos objetos.
+//
+// Uso: FrustumCullingBench [objetos] [iteracoes]
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "BenchUtils.h"
+#include "FrustumCulling.h"
+
+using namespace std;
+
+struct SceneObject {
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    glm::mat4 model;
+};
+
+static vector<SceneObject> randomScene(size_t count, mt19937& rng) {
+    uniform_real_distribution<float> position(-200.0f, 200.0f);
+    uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    uniform_real_distribution<float> scale(0.3f, 2.0f);
+    vector<SceneObject> objects(count);
+    for (auto& object : objects) {
+        // Caixa da Suzanne: o caso típico das cenas do projeto.
+        object.boundsMin = glm::vec3(-1.37f, -0.99f, -0.85f);
+        object.boundsMax = glm::vec3(1.37f, 0.99f, 0.85f);
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), position(rng) * 0.1f, position(rng)));
+        model = glm::rotate(model, angle(rng), glm::vec3(0.0f, 1.0f, 0.0f));
+        object.model = glm::scale(model, glm::vec3(scale(rng)));
+    }
+    return objects;
+}
+
+// Referência sem SoA: transforma os 8 cantos e exige que todos estejam do
+// lado de fora de algum plano para descartar.
+static size_t cullNaive(const Frustum& frustum, const vector<SceneObject>& objects, vector<uint8_t>& visible) {
+    visible.assign(objects.size(), 0);
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const SceneObject& object = objects[i];
+        glm::vec3 corners[8];
+        for (int c = 0; c < 8; ++c) {
+            glm::vec3 local((c & 1) ? object.boundsMax.x : object.boundsMin.x,
+                            (c & 2) ? object.boundsMax.y : object.boundsMin.y,
+                            (c & 4) ? object.boundsMax.z : object.boundsMin.z);
+            corners[c] = glm::vec3(object.model * glm::vec4(local, 1.0f));
+        }
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; ++p) {
+            const glm::vec4& plane = frustum.planes[p];
+            bool anyInside = false;
+            for (int c = 0; c < 8 && !anyInside; ++c) {
+                anyInside = glm::dot(glm::vec3(plane), corners[c]) + plane.w >= 0.0f;
+            }
+            inside = anyInside;
+        }
+        visible[i] = inside;
+        visibleCount += inside;
+    }
+    return visibleCount;
+}
+
+int main(int argc, char** argv) {
+    size_t objectCount = argc > 1 ? (size_t)atoll(argv[1]) : 100000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 100;
+
+    mt19937 rng(42);
+    vector<SceneObject> objects = randomScene(objectCount, rng);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 5.0f, 0.0f), glm::vec3(1.0f, 4.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+    Frustum frustum = Frustum::fromMatrix(projection * view);
+
+    printf("Objetos: %zu   largura SIMD: %d\n\n", objectCount, FRUSTUM_CULLING_WIDTH);
+
+    CullingSet set;
+    set.reserve(objectCount);
+    BenchResult build = measure([&] {
+        set.clear();
+        for (const auto& object : objects) set.add(object.boundsMin, object.boundsMax, object.model);
+    }, iterations);
+    printResult("montagem SoA (transformar AABBs)", build);
+
+    vector<uint8_t> naiveVisible, scalarVisible, simdVisible;
+    size_t naiveCount = 0, scalarCount = 0, simdCount = 0;
+    printResult("ingenuo (8 cantos por objeto)", measure([&] { naiveCount = cullNaive(frustum, objects, naiveVisible); }, iterations));
+    printResult("SoA escalar", measure([&] { scalarCount = cullAABBsScalar(frustum, set, scalarVisible); }, iterations));
+    printResult("SoA SIMD", measure([&] { simdCount = cullAABBs(frustum, set, simdVisible); }, iterations));
+
+    printf("\nVisiveis: %zu   descartados: %zu   (ingenuo: %zu visiveis)\n", simdCount, objectCount - simdCount, naiveCount);
+
+    // O teste por cantos é um pouco mais justo que o da AABB no mundo, então
+    // só se exige que ele nunca veja algo que a AABB descartou.
+    int failures = 0;
+    if (scalarVisible != simdVisible || scalarCount != simdCount) {
+        fprintf(stderr, "ERRO: SIMD e escalar discordam\n");
+        failures++;
+    }
+    for (size_t i = 0; i < objectCount; ++i) {
+        if (naiveVisible[i] && !simdVisible[i]) {
+            fprintf(stderr, "ERRO: objeto %zu visivel no teste ingenuo foi descartado\n", i);
+            failures++;
+            break;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
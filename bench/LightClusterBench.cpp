@@ -0,0 +1,111 @@
+// Benchmark da atribuição de luzes aos clusters (forward clusterizado).
+// Para cada quantidade de luzes mede o tempo de LightClusterBuilder::build e
+// a média de luzes avaliadas por fragmento, comparando com o forward simples
+// (todas as luzes em todo fragmento). Também confere, em pontos aleatórios
+// do frustum, que toda luz que alcança o ponto está na lista do cluster.
+//
+// Uso: LightClusterBench [iteracoes]
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "BenchUtils.h"
+#include "LightClusters.h"
+
+using namespace std;
+
+static vector<ClusterLight> randomLights(size_t count, mt19937& rng) {
+    // Com a atenuação do shader uma luz de intensidade 1 alcança ~90 m; luzes
+    // fracas espalhadas numa área grande dão raios de 5-15 m.
+    uniform_real_distribution<float> position(-60.0f, 60.0f);
+    uniform_real_distribution<float> height(0.0f, 6.0f);
+    uniform_real_distribution<float> intensity(0.008f, 0.04f);
+    vector<ClusterLight> lights(count);
+    for (auto& light : lights) {
+        light.position = glm::vec3(position(rng), height(rng), position(rng));
+        light.radius = lightRadius(intensity(rng), glm::vec3(1.0f), glm::vec3(1.0f));
+    }
+    return lights;
+}
+
+// Sorteia pontos dentro do frustum e confere que nenhuma luz que alcança o
+// ponto ficou fora do cluster correspondente. Retorna o número de falhas.
+static int validate(const LightClusterBuilder& builder, const vector<ClusterLight>& lights,
+                    const glm::mat4& view, const ClusterGrid& grid, mt19937& rng) {
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+    glm::mat4 invView = glm::inverse(view);
+    float tanY = tan(grid.fovY * 0.5f);
+    float tanX = tanY * grid.aspect;
+    const auto& ranges = builder.clusterRanges();
+    const auto& indices = builder.lightIndices();
+
+    int failures = 0;
+    for (int sample = 0; sample < 20000; ++sample) {
+        float u = unit(rng), v = unit(rng);
+        float depth = LightClusterBuilder::sliceDepth(0, grid) *
+                      pow(grid.farPlane / grid.nearPlane, unit(rng) * 0.999f);
+        glm::vec3 viewPoint((u * 2.0f - 1.0f) * depth * tanX, (v * 2.0f - 1.0f) * depth * tanY, -depth);
+        glm::vec3 worldPoint = glm::vec3(invView * glm::vec4(viewPoint, 1.0f));
+
+        uint32_t x = min((uint32_t)(u * grid.gridX), grid.gridX - 1);
+        uint32_t y = min((uint32_t)(v * grid.gridY), grid.gridY - 1);
+        uint32_t z = (uint32_t)clamp((int)floor(log(depth / grid.nearPlane) / log(grid.farPlane / grid.nearPlane) * grid.gridZ),
+                                     0, (int)grid.gridZ - 1);
+        uint32_t c = LightClusterBuilder::clusterIndex(x, y, z, grid);
+
+        for (uint32_t li = 0; li < lights.size(); ++li) {
+            if (glm::length(lights[li].position - worldPoint) >= lights[li].radius) continue;
+            bool listed = false;
+            for (uint32_t k = 0; k < ranges[c * 2 + 1] && !listed; ++k) {
+                listed = indices[ranges[c * 2] + k] == li;
+            }
+            if (!listed) failures++;
+        }
+    }
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+
+    ClusterGrid grid;
+    grid.aspect = 800.0f / 600.0f;
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 3.0f, 60.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    mt19937 rng(1234);
+
+    printf("Grade de clusters: %ux%ux%u (%u clusters)\n\n", grid.gridX, grid.gridY, grid.gridZ, grid.clusterCount());
+    printf("%8s %12s %12s %16s %14s %10s\n", "luzes", "build (ms)", "max (ms)", "luzes/cluster", "max/cluster", "falhas");
+
+    int failures = 0;
+    for (size_t count = 8; count <= 1024; count *= 2) {
+        vector<ClusterLight> lights = randomLights(count, rng);
+        LightClusterBuilder builder;
+        BenchResult r = measure([&] { builder.build(lights, view, grid); }, iterations);
+
+        // Média sobre os clusters que têm alguma luz: é o que um fragmento
+        // avalia no forward clusterizado, contra `count` no forward simples.
+        const auto& ranges = builder.clusterRanges();
+        size_t occupied = 0, total = 0;
+        uint32_t maxPerCluster = 0;
+        for (size_t c = 0; c < grid.clusterCount(); ++c) {
+            uint32_t n = ranges[c * 2 + 1];
+            if (n == 0) continue;
+            occupied++;
+            total += n;
+            maxPerCluster = max(maxPerCluster, n);
+        }
+        double average = occupied ? (double)total / occupied : 0.0;
+
+        int fails = validate(builder, lights, view, grid, rng);
+        failures += fails;
+        printf("%8zu %12.3f %12.3f %16.2f %14u %10d\n", count, r.meanMs, r.maxMs, average, maxPerCluster, fails);
+    }
+
+    if (failures) fprintf(stderr, "\nERRO: %d luzes ausentes de clusters que elas alcançam\n", failures);
+    return failures == 0 ? 0 : 1;
+}
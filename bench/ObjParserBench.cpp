@@ -0,0 +1,371 @@
+// Compara o leitor OBJ mapeado em memória (ObjParser.h), sequencial e
+// paralelo, com o carregador original baseado em getline/istringstream, e
+// mede a leitura do cache binário (MeshCache.h).
+//
+// Uso: ObjParserBench [pasta_dos_modelos] [faces_da_malha_gerada]
+// Padrão: assets/Modelos3D e 10000000 faces.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchUtils.h"
+#include "MeshCache.h"
+#include "ObjParser.h"
+
+using namespace std;
+
+// Cópia do laço de parse de loadSimpleOBJ anterior, sem as chamadas OpenGL.
+bool legacyLoadOBJ(const string& filePath, ObjMeshData& out) {
+    std::vector<glm::vec3> temp_vertices;
+    std::vector<glm::vec2> temp_texCoords;
+    std::vector<glm::vec3> temp_normals;
+    std::map<string, uint32_t> vertex_to_index_map;
+    uint32_t next_index = 0;
+
+    out = ObjMeshData();
+    std::ifstream file(filePath);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    while (getline(file, line)) {
+        std::istringstream ss(line);
+        std::string word;
+        ss >> word;
+
+        if (word == "mtllib") {
+            ss >> out.mtlPath;
+            out.mtlPath = objparser::directoryOf(filePath) + out.mtlPath;
+        } else if (word == "v") {
+            glm::vec3 vert;
+            ss >> vert.x >> vert.y >> vert.z;
+            temp_vertices.push_back(vert);
+            out.boundsMin = glm::min(out.boundsMin, vert);
+            out.boundsMax = glm::max(out.boundsMax, vert);
+        } else if (word == "vt") {
+            glm::vec2 tex;
+            ss >> tex.x >> tex.y;
+            temp_texCoords.push_back(tex);
+        } else if (word == "vn") {
+            glm::vec3 norm;
+            ss >> norm.x >> norm.y >> norm.z;
+            temp_normals.push_back(norm);
+        } else if (word == "f") {
+            for (int i = 0; i < 3; ++i) {
+                ss >> word;
+                if (vertex_to_index_map.find(word) == vertex_to_index_map.end()) {
+                    vertex_to_index_map[word] = next_index;
+
+                    size_t p_slash1 = word.find('/');
+                    size_t p_slash2 = word.find('/', p_slash1 + 1);
+                    int vIndex = stoi(word.substr(0, p_slash1)) - 1;
+                    out.vertices.push_back(temp_vertices[vIndex].x);
+                    out.vertices.push_back(temp_vertices[vIndex].y);
+                    out.vertices.push_back(temp_vertices[vIndex].z);
+
+                    int vnIndex = -1;
+                    if (p_slash2 != string::npos && p_slash2 + 1 < word.length()) {
+                        vnIndex = stoi(word.substr(p_slash2 + 1)) - 1;
+                    }
+                    if (vnIndex >= 0 && vnIndex < (int)temp_normals.size()) {
+                        out.vertices.push_back(temp_normals[vnIndex].x);
+                        out.vertices.push_back(temp_normals[vnIndex].y);
+                        out.vertices.push_back(temp_normals[vnIndex].z);
+                    } else {
+                        out.vertices.push_back(0.0f); out.vertices.push_back(1.0f); out.vertices.push_back(0.0f);
+                    }
+
+                    int vtIndex = -1;
+                    if (p_slash1 != string::npos && p_slash1 + 1 < word.length() && (p_slash2 == string::npos || p_slash1 + 1 != p_slash2)) {
+                        if (p_slash2 != string::npos) {
+                            vtIndex = stoi(word.substr(p_slash1 + 1, p_slash2 - (p_slash1 + 1))) - 1;
+                        } else {
+                            vtIndex = stoi(word.substr(p_slash1 + 1)) - 1;
+                        }
+                    }
+                    if (vtIndex >= 0 && vtIndex < (int)temp_texCoords.size()) {
+                        out.vertices.push_back(temp_texCoords[vtIndex].x);
+                        out.vertices.push_back(temp_texCoords[vtIndex].y);
+                    } else {
+                        out.vertices.push_back(0.0f); out.vertices.push_back(0.0f);
+                    }
+                    next_index++;
+                }
+                out.indices.push_back(vertex_to_index_map[word]);
+            }
+        }
+    }
+    return true;
+}
+
+// Gera uma grade triangulada com v/vt/vn e pelo menos `faces` triângulos.
+bool writeGridOBJ(const string& path, long long faces) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    long long n = (long long)ceil(sqrt(faces / 2.0));
+    long long side = n + 1;
+    for (long long j = 0; j < side; ++j) {
+        for (long long i = 0; i < side; ++i) {
+            fprintf(f, "v %.6f %.6f %.6f\n", i / (double)n, 0.05 * sin(i * 0.1) * cos(j * 0.1), j / (double)n);
+        }
+    }
+    for (long long j = 0; j < side; ++j) {
+        for (long long i = 0; i < side; ++i) {
+            fprintf(f, "vt %.6f %.6f\n", i / (double)n, j / (double)n);
+        }
+    }
+    fprintf(f, "vn 0.000000 1.000000 0.000000\n");
+    long long written = 0;
+    for (long long j = 0; j < n && written < faces; ++j) {
+        for (long long i = 0; i < n && written < faces; ++i) {
+            long long a = j * side + i + 1, b = a + 1, c = a + side, d = c + 1;
+            fprintf(f, "f %lld/%lld/1 %lld/%lld/1 %lld/%lld/1\n", a, a, c, c, b, b);
+            if (++written < faces) {
+                fprintf(f, "f %lld/%lld/1 %lld/%lld/1 %lld/%lld/1\n", b, b, c, c, d, d);
+                ++written;
+            }
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+bool sameOutput(const ObjMeshData& a, const ObjMeshData& b) {
+    return a.vertices.size() == b.vertices.size() && a.indices.size() == b.indices.size() &&
+           memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(float)) == 0 &&
+           memcmp(a.indices.data(), b.indices.data(), a.indices.size() * sizeof(uint32_t)) == 0 &&
+           a.boundsMin == b.boundsMin && a.boundsMax == b.boundsMax && a.mtlPath == b.mtlPath;
+}
+
+int benchFile(const string& path, int iterations) {
+    ObjMeshData legacy, mapped;
+    if (!legacyLoadOBJ(path, legacy) || !loadOBJData(path, mapped)) {
+        fprintf(stderr, "Erro ao abrir OBJ: %s\n", path.c_str());
+        return 1;
+    }
+    printf("\n%s: %zu vertices, %zu indices\n", path.c_str(), mapped.vertices.size() / 8, mapped.indices.size());
+    printResult("getline/istringstream", measure([&] { legacyLoadOBJ(path, legacy); }, iterations));
+    printResult("mmap/from_chars", measure([&] { loadOBJData(path, mapped); }, iterations));
+    if (!sameOutput(legacy, mapped)) {
+        fprintf(stderr, "ERRO: buffers diferentes entre os carregadores para %s\n", path.c_str());
+        return 1;
+    }
+
+    MappedFile file(path);
+    for (unsigned threads : { 1u, 2u, 4u, 8u, 16u }) {
+        ThreadPool pool(threads);
+        ObjMeshData parallel;
+        printResult("mmap/from_chars " + to_string(threads) + " threads",
+                    measure([&] { parseOBJParallel(file.data(), file.size(), path, parallel, pool); }, iterations));
+        if (!sameOutput(mapped, parallel)) {
+            fprintf(stderr, "ERRO: parse paralelo (%u threads) difere do sequencial para %s\n", threads, path.c_str());
+            return 1;
+        }
+    }
+    printf("buffers identicos\n");
+    return 0;
+}
+
+size_t allocatedBytes = 0;
+
+// Alocador que contabiliza os bytes usados pelos nós do std::map.
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+    CountingAllocator() = default;
+    template <typename U> CountingAllocator(const CountingAllocator<U>&) {}
+    T* allocate(size_t n) {
+        allocatedBytes += n * sizeof(T);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) {
+        allocatedBytes -= n * sizeof(T);
+        ::operator delete(p);
+    }
+    template <typename U> bool operator==(const CountingAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+// Isola a deduplicação: mapa ordenado por string (carregador original)
+// contra a tabela hash por trinca inteira (CornerHashTable).
+int benchDedup(const string& path, int iterations) {
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        fprintf(stderr, "Erro ao abrir OBJ: %s\n", path.c_str());
+        return 1;
+    }
+
+    vector<string> tokens;
+    vector<objparser::FaceCorner> corners;
+    size_t nV = 0, nVT = 0, nVN = 0;
+    const char* end = file.data() + file.size();
+    for (const char* p = file.data(), *next = nullptr; p < end; p = next) {
+        const char* lineEnd = nullptr;
+        const char* rest = nullptr;
+        next = objparser::nextLine(p, end, lineEnd);
+        switch (objparser::classifyLine(p, lineEnd, rest)) {
+        case objparser::ObjRecord::Position: nV++; break;
+        case objparser::ObjRecord::TexCoord: nVT++; break;
+        case objparser::ObjRecord::Normal: nVN++; break;
+        case objparser::ObjRecord::Face: {
+            string_view face[3];
+            if (!objparser::splitFaceTokens(rest, lineEnd, face)) break;
+            for (const string_view& token : face) {
+                tokens.emplace_back(token);
+                corners.push_back(objparser::parseCorner(token.data(), token.data() + token.size(), nV, nVT, nVN));
+            }
+            break;
+        }
+        default: break;
+        }
+    }
+
+    size_t mapBytes = 0, mapUnique = 0;
+    BenchResult mapResult = measure([&] {
+        using StringMap = map<string, uint32_t, less<string>, CountingAllocator<pair<const string, uint32_t>>>;
+        StringMap vertexMap;
+        uint32_t next = 0;
+        for (const string& token : tokens) {
+            if (vertexMap.find(token) == vertexMap.end()) vertexMap[token] = next++;
+        }
+        mapBytes = allocatedBytes;
+        mapUnique = vertexMap.size();
+    }, iterations);
+
+    size_t tableBytes = 0, tableUnique = 0;
+    BenchResult tableResult = measure([&] {
+        objparser::CornerHashTable table;
+        uint32_t next = 0;
+        for (const objparser::FaceCorner& corner : corners) {
+            bool inserted = false;
+            table.findOrInsert(corner, next, inserted);
+            if (inserted) next++;
+        }
+        tableBytes = table.memoryBytes();
+        tableUnique = table.size();
+    }, iterations);
+
+    printf("\nDeduplicacao em %s (%zu vertices de face)\n", path.c_str(), tokens.size());
+    printResult("std::map<string, GLuint>", mapResult);
+    printf("%-40s %zu unicos, %zu bytes\n", "", mapUnique, mapBytes);
+    printResult("CornerHashTable (v, vt, vn)", tableResult);
+    printf("%-40s %zu unicos, %zu bytes\n", "", tableUnique, tableBytes);
+
+    const char zeroPadded[] = "v 0 0 0\nvt 0 0\nvn 0 1 0\nf 1/1/1 01/1/1 1/01/001\n";
+    ObjMeshData padded;
+    parseOBJ(zeroPadded, sizeof(zeroPadded) - 1, "", padded);
+    if (padded.vertices.size() != 8) {
+        fprintf(stderr, "ERRO: \"1/1/1\" e \"01/1/1\" deveriam gerar o mesmo vertice\n");
+        return 1;
+    }
+    return 0;
+}
+
+// Data de modificação do OBJ gravada no cache (a primeira dependência).
+int64_t cachedSourceTime(const string& cachePath) {
+    using namespace meshcache;
+    MappedFile raw(cachePath);
+    if (raw.size() < sizeof(Header)) return -1;
+    const char* p = raw.data() + sizeof(Header);
+    const char* end = raw.data() + raw.size();
+    string text;
+    Dependency dep;
+    if (!readString(p, end, text) || !readString(p, end, text) || !readString(p, end, text) ||
+        end - p < (ptrdiff_t)sizeof(dep)) {
+        return -1;
+    }
+    memcpy(&dep, p, sizeof(dep));
+    return dep.mtime;
+}
+
+// Mede a leitura de um cache .meshbin aquecido (mapeamento + validação +
+// cópia dos buffers, que simula o glBufferData) e testa a invalidação.
+int benchCache(long long faces) {
+    string objPath = "bench_cache_" + to_string(faces) + ".obj";
+    string cachePath = meshCachePath(objPath, "");
+    if (!writeGridOBJ(objPath, faces)) return 1;
+
+    int failures = 0;
+    ObjMeshData mesh;
+    loadOBJData(objPath, mesh);
+    printf("\nCache .meshbin: %zu triangulos, %zu vertices\n", mesh.indices.size() / 3, mesh.vertices.size() / 8);
+    printResult("parse do OBJ", measure([&] { loadOBJData(objPath, mesh); }, 1));
+    printResult("gravacao do cache", measure([&] { writeMeshCache(cachePath, objPath, mesh, MeshCacheMaterial()); }, 1));
+
+    vector<float> vbo(mesh.vertices.size());
+    vector<uint32_t> ebo(mesh.indices.size());
+    bool hit = true;
+    BenchResult warm = measure([&] {
+        MappedFile file;
+        MeshCacheData cached;
+        hit = hit && readMeshCache(cachePath, objPath, file, cached);
+        if (hit) {
+            memcpy(vbo.data(), cached.vertices, cached.vertexFloatCount * sizeof(float));
+            memcpy(ebo.data(), cached.indices, cached.indexCount * sizeof(uint32_t));
+        }
+    }, 10);
+    printResult("leitura do cache aquecido", warm);
+    if (!hit || memcmp(vbo.data(), mesh.vertices.data(), vbo.size() * sizeof(float)) != 0 ||
+        memcmp(ebo.data(), mesh.indices.data(), ebo.size() * sizeof(uint32_t)) != 0) {
+        fprintf(stderr, "ERRO: cache nao corresponde ao OBJ\n");
+        failures++;
+    }
+
+    std::filesystem::last_write_time(objPath, std::filesystem::last_write_time(objPath) + std::chrono::seconds(5));
+    MappedFile file;
+    MeshCacheData cached;
+    if (!readMeshCache(cachePath, objPath, file, cached)) {
+        fprintf(stderr, "ERRO: cache invalidado so por mudanca de data\n");
+        failures++;
+    }
+    file.close();
+    uint64_t objSize = 0;
+    int64_t objTime = 0;
+    meshcache::statFile(objPath, objSize, objTime);
+    if (cachedSourceTime(cachePath) != objTime) {
+        fprintf(stderr, "ERRO: data nova do OBJ nao foi gravada no cache\n");
+        failures++;
+    }
+
+    FILE* f = fopen(objPath.c_str(), "r+b");
+    fputc('#', f);
+    fclose(f);
+    if (readMeshCache(cachePath, objPath, file, cached)) {
+        fprintf(stderr, "ERRO: cache aceito apos alteracao do OBJ\n");
+        failures++;
+    }
+    file.close();
+
+    remove(objPath.c_str());
+    remove(cachePath.c_str());
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    string assetDir = argc > 1 ? argv[1] : "assets/Modelos3D";
+    long long generatedFaces = argc > 2 ? atoll(argv[2]) : 10000000LL;
+
+    int failures = 0;
+    failures += benchFile(assetDir + "/Suzanne.obj", 20);
+    failures += benchFile(assetDir + "/SuzanneSubdiv1.obj", 20);
+    failures += benchDedup(assetDir + "/SuzanneSubdiv1.obj", 50);
+
+    string generatedPath = "bench_grid_" + to_string(generatedFaces) + ".obj";
+    printf("\nGerando malha com %lld faces em %s...\n", generatedFaces, generatedPath.c_str());
+    if (!writeGridOBJ(generatedPath, generatedFaces)) {
+        fprintf(stderr, "Erro ao gerar %s\n", generatedPath.c_str());
+        return 1;
+    }
+    failures += benchFile(generatedPath, 1);
+    remove(generatedPath.c_str());
+
+    failures += benchCache(1000000);
+
+    return failures == 0 ? 0 : 1;
+}
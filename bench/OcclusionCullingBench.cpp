@@ -0,0 +1,307 @@
+// Benchmark e testes do culling por oclusão na CPU (MaskedOcclusionBuffer).
+// Primeiro roda casos pequenos com resposta conhecida (objeto atrás de uma
+// parede, na frente dela, parcialmente descoberto, cruzando o near plane).
+// Depois monta uma cena sintética com paredes e prédios subdivididos como
+// oclusores e 100k objetos, mede a rasterização e o teste das caixas com 1
+// thread e com o pool inteiro, e confere que:
+//   - o resultado não depende do número de threads;
+//   - todo objeto dado como oculto também está oculto num buffer de
+//     referência com a profundidade exata de cada pixel (conservador).
+//
+// Uso: OcclusionCullingBench [objetos] [iteracoes] [threads]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "BenchUtils.h"
+#include "FrustumCulling.h"
+#include "SoftwareOcclusion.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+static const int BUFFER_WIDTH = 256;
+static const int BUFFER_HEIGHT = 192;
+
+// Cubo [-1, 1]^3 com cada face dividida em n x n quadrados, triângulos no
+// sentido anti-horário vistos de fora.
+static OccluderMesh makeBox(int n) {
+    static const glm::vec3 normals[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    static const glm::vec3 tangentsU[6] = { { 0, 1, 0 }, { 0, 0, 1 }, { 0, 0, 1 }, { 1, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 } };
+    static const glm::vec3 tangentsV[6] = { { 0, 0, 1 }, { 0, 1, 0 }, { 1, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 }, { 1, 0, 0 } };
+    OccluderMesh mesh;
+    for (int f = 0; f < 6; ++f) {
+        uint32_t base = (uint32_t)mesh.positions.size();
+        for (int j = 0; j <= n; ++j) {
+            for (int i = 0; i <= n; ++i) {
+                float s = -1.0f + 2.0f * i / n;
+                float t = -1.0f + 2.0f * j / n;
+                mesh.positions.push_back(normals[f] + s * tangentsU[f] + t * tangentsV[f]);
+            }
+        }
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                uint32_t a = base + j * (n + 1) + i;
+                uint32_t b = a + 1;
+                uint32_t c = a + (n + 1) + 1;
+                uint32_t d = a + (n + 1);
+                mesh.indices.insert(mesh.indices.end(), { a, b, c, a, c, d });
+            }
+        }
+    }
+    return mesh;
+}
+
+static glm::mat4 boxModel(const glm::vec3& center, const glm::vec3& halfSize) {
+    return glm::scale(glm::translate(glm::mat4(1.0f), center), halfSize);
+}
+
+struct Occluder {
+    const OccluderMesh* mesh;
+    glm::mat4 model;
+};
+
+// Buffer de referência: profundidade exata no centro de cada pixel, com as
+// mesmas regras de projeção do MaskedOcclusionBuffer.
+class ReferenceDepthBuffer {
+public:
+    void render(const vector<Occluder>& occluders, const glm::mat4& viewProjection) {
+        this->viewProjection = viewProjection;
+        depth.assign((size_t)BUFFER_WIDTH * BUFFER_HEIGHT, 1.0f);
+        for (const Occluder& occluder : occluders) {
+            glm::mat4 mvp = viewProjection * occluder.model;
+            const OccluderMesh& mesh = *occluder.mesh;
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+                glm::vec3 v[3];
+                bool usable = true;
+                for (int k = 0; k < 3 && usable; ++k) {
+                    glm::vec4 clip = mvp * glm::vec4(mesh.positions[mesh.indices[i + k]], 1.0f);
+                    usable = clip.w > 0.0f && clip.z >= -clip.w;
+                    v[k] = toScreen(clip);
+                }
+                if (usable) drawTriangle(v);
+            }
+        }
+    }
+
+    bool isOccluded(const glm::vec3& center, const glm::vec3& extent) const {
+        float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, nearest = 1e30f;
+        for (int c = 0; c < 8; ++c) {
+            glm::vec3 corner = center + glm::vec3((c & 1) ? extent.x : -extent.x,
+                                                  (c & 2) ? extent.y : -extent.y,
+                                                  (c & 4) ? extent.z : -extent.z);
+            glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+            if (clip.w <= 0.0f || clip.z < -clip.w) return false;
+            glm::vec3 p = toScreen(clip);
+            minX = min(minX, p.x);
+            maxX = max(maxX, p.x);
+            minY = min(minY, p.y);
+            maxY = max(maxY, p.y);
+            nearest = min(nearest, p.z);
+        }
+        int x0 = (int)floor(minX) - 1, x1 = (int)floor(maxX) + 1;
+        int y0 = (int)floor(minY) - 1, y1 = (int)floor(maxY) + 1;
+        if (x0 < 0 || y0 < 0 || x1 >= BUFFER_WIDTH || y1 >= BUFFER_HEIGHT) return false;
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                if (nearest <= depth[(size_t)y * BUFFER_WIDTH + x]) return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static glm::vec3 toScreen(const glm::vec4& clip) {
+        float invW = 1.0f / clip.w;
+        return glm::vec3((clip.x * invW + 1.0f) * 0.5f * BUFFER_WIDTH,
+                         (clip.y * invW + 1.0f) * 0.5f * BUFFER_HEIGHT,
+                         clip.z * invW * 0.5f + 0.5f);
+    }
+
+    void drawTriangle(const glm::vec3 v[3]) {
+        float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+        if (area <= 0.0f) return;
+        int x0 = max(0, (int)floor(min({ v[0].x, v[1].x, v[2].x })));
+        int x1 = min(BUFFER_WIDTH - 1, (int)floor(max({ v[0].x, v[1].x, v[2].x })));
+        int y0 = max(0, (int)floor(min({ v[0].y, v[1].y, v[2].y })));
+        int y1 = min(BUFFER_HEIGHT - 1, (int)floor(max({ v[0].y, v[1].y, v[2].y })));
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                glm::vec2 p(x + 0.5f, y + 0.5f);
+                float w[3];
+                bool inside = true;
+                for (int e = 0; e < 3 && inside; ++e) {
+                    // Mesma orientação canônica das arestas do buffer testado.
+                    const glm::vec3* a = &v[(e + 1) % 3];
+                    const glm::vec3* b = &v[(e + 2) % 3];
+                    bool flipped = b->x < a->x || (b->x == a->x && b->y < a->y);
+                    if (flipped) swap(a, b);
+                    double edge = ((double)b->x - a->x) * ((double)p.y - a->y) - ((double)b->y - a->y) * ((double)p.x - a->x);
+                    w[e] = (float)(flipped ? -edge : edge);
+                    inside = w[e] >= 0.0f;
+                }
+                if (!inside) continue;
+                float z = (w[0] * v[0].z + w[1] * v[1].z + w[2] * v[2].z) / area;
+                float& stored = depth[(size_t)y * BUFFER_WIDTH + x];
+                stored = min(stored, z);
+            }
+        }
+    }
+
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    vector<float> depth;
+};
+
+static int failures = 0;
+
+static void expect(bool condition, const char* description) {
+    printf("  %-56s %s\n", description, condition ? "ok" : "FALHOU");
+    if (!condition) failures++;
+}
+
+// Parede de 4 x 4 m a 10 m da câmera, que olha para -z a partir da origem.
+static void runUnitTests(const glm::mat4& projection) {
+    printf("Casos de teste:\n");
+    OccluderMesh box = makeBox(1);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 viewProjection = projection * view;
+
+    MaskedOcclusionBuffer buffer;
+    buffer.resize(BUFFER_WIDTH, BUFFER_HEIGHT);
+    buffer.begin(viewProjection);
+    buffer.rasterize();
+    expect(!buffer.isOccluded(glm::vec3(0.0f, 0.0f, -30.0f), glm::vec3(1.0f)), "buffer vazio nao oculta nada");
+
+    buffer.begin(viewProjection);
+    buffer.addOccluder(box, boxModel(glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(2.0f, 2.0f, 0.25f)));
+    buffer.rasterize();
+    expect(buffer.triangleCount() == 2, "so a face de frente vira triangulos");
+    expect(buffer.isOccluded(glm::vec3(0.0f, 0.0f, -30.0f), glm::vec3(1.0f)), "objeto atras da parede e ocultado");
+    expect(buffer.isOccluded(glm::vec3(0.5f, -0.5f, -12.0f), glm::vec3(0.5f)), "objeto logo atras da parede e ocultado");
+    expect(!buffer.isOccluded(glm::vec3(0.0f, 0.0f, -5.0f), glm::vec3(0.5f)), "objeto na frente da parede e visivel");
+    expect(!buffer.isOccluded(glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(0.5f)), "objeto atravessando a parede e visivel");
+    expect(!buffer.isOccluded(glm::vec3(6.0f, 0.0f, -30.0f), glm::vec3(1.0f)), "objeto na borda da parede e visivel");
+    expect(!buffer.isOccluded(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f)), "objeto cruzando o near plane e visivel");
+
+    // Duas metades em profundidades diferentes que só juntas cobrem o
+    // objeto: exige a mescla das máscaras nos blocos da emenda.
+    buffer.begin(viewProjection);
+    buffer.addOccluder(box, boxModel(glm::vec3(-1.0f, 0.0f, -10.0f), glm::vec3(1.0f, 2.0f, 0.25f)));
+    buffer.addOccluder(box, boxModel(glm::vec3(1.0f, 0.0f, -12.0f), glm::vec3(1.0f, 2.0f, 0.25f)));
+    buffer.rasterize();
+    expect(buffer.isOccluded(glm::vec3(0.0f, 0.0f, -30.0f), glm::vec3(1.0f)), "duas metades de parede ocultam juntas");
+    expect(!buffer.isOccluded(glm::vec3(0.5f, 0.0f, -11.0f), glm::vec3(0.5f, 0.5f, 0.2f)), "objeto entre as duas metades e visivel");
+
+    // Parede com um vão de 1 m no meio.
+    buffer.begin(viewProjection);
+    buffer.addOccluder(box, boxModel(glm::vec3(-1.5f, 0.0f, -10.0f), glm::vec3(1.0f, 2.0f, 0.25f)));
+    buffer.addOccluder(box, boxModel(glm::vec3(1.5f, 0.0f, -10.0f), glm::vec3(1.0f, 2.0f, 0.25f)));
+    buffer.rasterize();
+    expect(!buffer.isOccluded(glm::vec3(0.0f, 0.0f, -30.0f), glm::vec3(1.0f)), "objeto atras do vao e visivel");
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    size_t objectCount = argc > 1 ? (size_t)atoll(argv[1]) : 100000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 50;
+    unsigned threads = argc > 3 ? (unsigned)atoi(argv[3]) : 0;
+
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 200.0f);
+    runUnitTests(projection);
+
+    // Rua de prédios: caixas subdivididas (malhas "de verdade") e muros
+    // simples ao longo do eixo -z.
+    mt19937 rng(42);
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+    OccluderMesh building = makeBox(24);
+    OccluderMesh wall = makeBox(1);
+    vector<Occluder> occluders;
+    for (int i = 0; i < 24; ++i) {
+        float side = (i % 2) ? 1.0f : -1.0f;
+        glm::vec3 half(3.0f + 3.0f * unit(rng), 4.0f + 8.0f * unit(rng), 3.0f + 3.0f * unit(rng));
+        glm::vec3 center(side * (half.x + 4.0f + 6.0f * unit(rng)), half.y - 1.0f, -12.0f - i * 6.0f);
+        occluders.push_back({ &building, boxModel(center, half) });
+    }
+    for (int i = 0; i < 40; ++i) {
+        glm::vec3 half(1.0f + 4.0f * unit(rng), 0.5f + 2.0f * unit(rng), 0.2f);
+        glm::vec3 center(-30.0f + 60.0f * unit(rng), half.y - 1.0f, -8.0f - 80.0f * unit(rng));
+        occluders.push_back({ &wall, boxModel(center, half) });
+    }
+    size_t occluderTriangles = 0;
+    for (const Occluder& occluder : occluders) occluderTriangles += occluder.mesh->indices.size() / 3;
+
+    CullingSet set;
+    set.reserve(objectCount);
+    for (size_t i = 0; i < objectCount; ++i) {
+        glm::vec3 center(-80.0f + 160.0f * unit(rng), 2.0f * unit(rng), -150.0f * unit(rng));
+        set.add(glm::vec3(-1.37f, -0.99f, -0.85f), glm::vec3(1.37f, 0.99f, 0.85f),
+                glm::translate(glm::mat4(1.0f), center));
+    }
+
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 1.7f, 5.0f), glm::vec3(0.0f, 1.7f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 viewProjection = projection * view;
+    vector<uint8_t> frustumVisible;
+    size_t inFrustum = cullAABBs(Frustum::fromMatrix(viewProjection), set, frustumVisible);
+
+    ThreadPool pool(threads);
+    printf("Oclusores: %zu (%zu triangulos)   objetos: %zu (%zu no frustum)   buffer: %dx%d   threads: %u\n\n",
+           occluders.size(), occluderTriangles, objectCount, inFrustum, BUFFER_WIDTH, BUFFER_HEIGHT, pool.size());
+
+    MaskedOcclusionBuffer single, parallel;
+    single.resize(BUFFER_WIDTH, BUFFER_HEIGHT);
+    parallel.resize(BUFFER_WIDTH, BUFFER_HEIGHT);
+    auto render = [&](MaskedOcclusionBuffer& buffer, ThreadPool* threadPool) {
+        buffer.begin(viewProjection);
+        for (const Occluder& occluder : occluders) buffer.addOccluder(*occluder.mesh, occluder.model);
+        buffer.rasterize(threadPool);
+    };
+
+    printResult("rasterizar oclusores (1 thread)", measure([&] { render(single, nullptr); }, iterations));
+    printResult("rasterizar oclusores (pool)", measure([&] { render(parallel, &pool); }, iterations));
+
+    vector<uint8_t> singleVisible, parallelVisible;
+    size_t singleCulled = 0, parallelCulled = 0;
+    printResult("testar caixas (1 thread)", measure([&] {
+        singleVisible = frustumVisible;
+        singleCulled = single.cullOccluded(set, singleVisible);
+    }, iterations));
+    printResult("testar caixas (pool)", measure([&] {
+        parallelVisible = frustumVisible;
+        parallelCulled = parallel.cullOccluded(set, parallelVisible, &pool);
+    }, iterations));
+
+    ReferenceDepthBuffer reference;
+    reference.render(occluders, viewProjection);
+    size_t referenceCulled = 0, notConservative = 0;
+    for (size_t i = 0; i < objectCount; ++i) {
+        if (!frustumVisible[i]) continue;
+        glm::vec3 center(set.centerX[i], set.centerY[i], set.centerZ[i]);
+        glm::vec3 extent(set.extentX[i], set.extentY[i], set.extentZ[i]);
+        bool occluded = reference.isOccluded(center, extent);
+        referenceCulled += occluded;
+        if (!singleVisible[i] && !occluded) notConservative++;
+    }
+
+    printf("\nBlocos com oclusor: %.1f%%\n", single.coverage() * 100.0f);
+    printf("Ocultos: %zu de %zu no frustum   (referencia por pixel: %zu)\n", singleCulled, inFrustum, referenceCulled);
+
+    if (singleVisible != parallelVisible || singleCulled != parallelCulled) {
+        fprintf(stderr, "ERRO: resultado com 1 thread e com o pool discordam\n");
+        failures++;
+    }
+    if (notConservative > 0) {
+        fprintf(stderr, "ERRO: %zu objetos ocultados estao visiveis na referencia\n", notConservative);
+        failures++;
+    }
+    if (singleCulled == 0) {
+        fprintf(stderr, "ERRO: nenhum objeto ocultado na cena de teste\n");
+        failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+// Ordenação dos draws por chave de estado. Cada draw vira uma chave de 64
+// bits em que os campos mais significativos são os estados mais caros de
+// trocar, de modo que ordenar as chaves agrupa os draws que compartilham
+// programa, textura e material e, dentro de cada grupo, os ordena da frente
+// para trás. A ordenação é um radix sort LSD estável. Não faz chamadas
+// OpenGL.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Layout da chave, do bit mais significativo para o menos:
+//   63-62  passe (opaco, ...)
+//   61-56  permutação de shader
+//   55-44  textura (slot denso, ver DrawSlotTable)
+//   43-32  material
+//   31-0   profundidade na view (bits do float, crescentes para d >= 0)
+const uint32_t DRAW_KEY_PASS_BITS = 2;
+const uint32_t DRAW_KEY_PERMUTATION_BITS = 6;
+const uint32_t DRAW_KEY_TEXTURE_BITS = 12;
+const uint32_t DRAW_KEY_MATERIAL_BITS = 12;
+const uint32_t DRAW_KEY_DEPTH_BITS = 32;
+
+const uint32_t DRAW_KEY_MATERIAL_SHIFT = DRAW_KEY_DEPTH_BITS;
+const uint32_t DRAW_KEY_TEXTURE_SHIFT = DRAW_KEY_MATERIAL_SHIFT + DRAW_KEY_MATERIAL_BITS;
+const uint32_t DRAW_KEY_PERMUTATION_SHIFT = DRAW_KEY_TEXTURE_SHIFT + DRAW_KEY_TEXTURE_BITS;
+const uint32_t DRAW_KEY_PASS_SHIFT = DRAW_KEY_PERMUTATION_SHIFT + DRAW_KEY_PERMUTATION_BITS;
+
+static_assert(DRAW_KEY_PASS_SHIFT + DRAW_KEY_PASS_BITS == 64, "a chave de draw deve ocupar 64 bits");
+
+struct DrawItem {
+    uint64_t key;
+    uint32_t index;
+};
+
+// Profundidades negativas (atrás da câmera, mas dentro da caixa de culling)
+// e NaN viram zero; para floats não negativos a ordem dos bits é a ordem
+// dos valores.
+inline uint32_t drawKeyDepth(float depth) {
+    if (!(depth > 0.0f)) return 0;
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    return bits;
+}
+
+inline uint64_t makeDrawKey(uint32_t pass, uint32_t permutation, uint32_t texture, uint32_t material, float depth) {
+    auto field = [](uint32_t value, uint32_t bits, uint32_t shift) {
+        return (uint64_t)(value & ((1u << bits) - 1u)) << shift;
+    };
+    return field(pass, DRAW_KEY_PASS_BITS, DRAW_KEY_PASS_SHIFT)
+         | field(permutation, DRAW_KEY_PERMUTATION_BITS, DRAW_KEY_PERMUTATION_SHIFT)
+         | field(texture, DRAW_KEY_TEXTURE_BITS, DRAW_KEY_TEXTURE_SHIFT)
+         | field(material, DRAW_KEY_MATERIAL_BITS, DRAW_KEY_MATERIAL_SHIFT)
+         | drawKeyDepth(depth);
+}
+
+inline uint32_t drawKeyTexture(uint64_t key) {
+    return (uint32_t)(key >> DRAW_KEY_TEXTURE_SHIFT) & ((1u << DRAW_KEY_TEXTURE_BITS) - 1u);
+}
+
+inline uint32_t drawKeyMaterial(uint64_t key) {
+    return (uint32_t)(key >> DRAW_KEY_MATERIAL_SHIFT) & ((1u << DRAW_KEY_MATERIAL_BITS) - 1u);
+}
+
+// Converte identificadores esparsos (nomes de textura, VAOs) em slots
+// densos que cabem nos campos da chave, na ordem em que aparecem. O slot 0
+// fica reservado para "nenhum". Identificadores além da capacidade do
+// campo dividem o último slot: a ordenação continua correta, só agrupa pior.
+class DrawSlotTable {
+public:
+    explicit DrawSlotTable(uint32_t bits) : maxSlot((1u << bits) - 1u) {}
+
+    void clear() { slots.clear(); }
+
+    uint32_t slot(uint32_t id) {
+        if (id == 0) return 0;
+        auto it = slots.find(id);
+        if (it != slots.end()) return it->second;
+        uint32_t value = (uint32_t)slots.size() + 1;
+        if (value > maxSlot) value = maxSlot;
+        slots.emplace(id, value);
+        return value;
+    }
+
+private:
+    uint32_t maxSlot;
+    std::unordered_map<uint32_t, uint32_t> slots;
+};
+
+// Radix sort LSD de 8 bits por passada, estável. Passadas em que todas as
+// chaves têm o mesmo byte são puladas, então chaves com campos constantes
+// (um único passe, nenhuma permutação) custam menos que as 8 passadas.
+// `scratch` é reaproveitado entre quadros.
+inline void radixSortDrawItems(std::vector<DrawItem>& items, std::vector<DrawItem>& scratch) {
+    size_t n = items.size();
+    if (n < 2) return;
+    scratch.resize(n);
+
+    size_t counts[8][256] = {};
+    for (const DrawItem& item : items) {
+        for (int pass = 0; pass < 8; ++pass) {
+            counts[pass][(item.key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    DrawItem* source = items.data();
+    DrawItem* target = scratch.data();
+    for (int pass = 0; pass < 8; ++pass) {
+        size_t* count = counts[pass];
+        if (count[(source[0].key >> (pass * 8)) & 0xFF] == n) continue;
+
+        size_t offset = 0;
+        for (int bucket = 0; bucket < 256; ++bucket) {
+            size_t c = count[bucket];
+            count[bucket] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            const DrawItem& item = source[i];
+            target[count[(item.key >> (pass * 8)) & 0xFF]++] = item;
+        }
+        std::swap(source, target);
+    }
+    if (source != items.data()) std::memcpy(items.data(), source, n * sizeof(DrawItem));
+}
+
+struct StateChangeCount {
+    size_t textures = 0;
+    size_t materials = 0;
+};
+
+// Trocas de textura e de material que um cache de estado veria ao submeter
+// os draws na ordem de `items` (cada campo conta quando difere do anterior).
+inline StateChangeCount countStateChanges(const std::vector<DrawItem>& items) {
+    StateChangeCount changes;
+    for (size_t i = 0; i < items.size(); ++i) {
+        uint64_t key = items[i].key;
+        if (i == 0 || drawKeyTexture(key) != drawKeyTexture(items[i - 1].key)) changes.textures++;
+        if (i == 0 || drawKeyMaterial(key) != drawKeyMaterial(items[i - 1].key)) changes.materials++;
+    }
+    return changes;
+}
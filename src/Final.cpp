@@ -4,19 +4,48 @@
 #include <string>
 #include <vector>
 #include <algorithm>
-#include <map>
+#include <unordered_map>
 #include <cmath>
+#include <memory>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <filesystem>
 
 #include <glad/glad.h>
 
 #include <GLFW/glfw3.h>
 
+#ifdef FINAL_HEADLESS_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#include "ObjParser.h"
+#include "MeshCache.h"
+#include "LightClusters.h"
+#include "FrustumCulling.h"
+#include "SoftwareOcclusion.h"
+#include "RangeAllocator.h"
+#include "DrawSort.h"
+#include "ProgramCache.h"
+#include "FrameProfiler.h"
+#include "PerfHud.h"
+#include "SceneData.h"
+#include "SceneConfig.h"
+#include "StartupProfiler.h"
 
 using namespace std;
 
@@ -27,6 +56,10 @@ void processInput(GLFWwindow *window);
 
 const GLuint WIDTH = 1200, HEIGHT = 900;
 
+// Carrega as funções do GL que o glad (4.0) não cobre. Com janela vêm do
+// GLFW; no modo headless, do eglGetProcAddress.
+GLADloadproc loadGLFunction = (GLADloadproc)glfwGetProcAddress;
+
 class Camera {
 public:
     glm::vec3 Position;
@@ -86,6 +119,12 @@ public:
         updateCameraVectors();
     }
 
+    void SetOrientation(float yaw, float pitch) {
+        Yaw = yaw;
+        Pitch = pitch;
+        updateCameraVectors();
+    }
+
     void ProcessMouseScroll(float yoffset) {
         Fov -= (float)yoffset;
         if (Fov < 1.0f) Fov = 1.0f;
@@ -105,79 +144,111 @@ private:
     }
 };
 
-struct TrajectoryPoint {
-    glm::vec3 position;
-    TrajectoryPoint(glm::vec3 pos) : position(pos) {}
+struct InstanceData {
+    glm::mat4 model;
+    glm::mat3 normalMatrix;
+    float selected;
 };
 
-struct Trajectory {
-    std::vector<TrajectoryPoint> points;
-    int currentPointIndex = 0;
-    float t = 0.0f;
-    float speed = 2.0f;
-    bool isActive = false;
-    
-    void addPoint(glm::vec3 point) {
-        points.push_back(TrajectoryPoint(point));
-        if (points.size() >= 2) {
-            isActive = true;
-        }
-    }
-    
-    glm::vec3 getCurrentPosition(float deltaTime) {
-        if (points.empty()) return glm::vec3(0.0f);
-        if (points.size() == 1) return points[0].position;
-        
-        int nextIndex = (currentPointIndex + 1) % points.size();
-        float segmentDistance = glm::distance(points[currentPointIndex].position, points[nextIndex].position);
-        
-        float tIncrement = (segmentDistance > 0.0f) ? (speed * deltaTime) / segmentDistance : 1.0f;
-        
-        t += tIncrement;
-        
-        if (t >= 1.0f) {
-            t = 0.0f;
-            currentPointIndex = (currentPointIndex + 1) % points.size();
-        }
-        
-        nextIndex = (currentPointIndex + 1) % points.size();
-        return glm::mix(points[currentPointIndex].position, points[nextIndex].position, t);
-    }
-    
-    void clear() {
-        points.clear();
-        currentPointIndex = 0;
-        t = 0.0f;
-        isActive = false;
-    }
+const GLuint LIGHT_BLOCK_BINDING = 0;
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
+
+// Até MAX_FIXED_LIGHTS luzes ligadas, os programas especializados as
+// percorrem direto pela lista activeLights, sem consultar os clusters.
+const int MAX_FIXED_LIGHTS = 4;
+
+// Espelho em layout std140 do bloco LightBlock do fragment shader. As luzes
+// ficam no texture buffer lightData (3 texels RGBA32F por luz) e a lista de
+// luzes de cada cluster em clusterRanges/lightIndices.
+struct LightBlock {
+    glm::vec4 ambientSum;
+    GLint clusterGrid[4];
+    float clusterParams[4];
+    // O GLSL declara `ivec4 activeLights`: mudar MAX_FIXED_LIGHTS exige
+    // mudar o shader junto (o static_assert abaixo só pega o tamanho).
+    GLint activeLights[MAX_FIXED_LIGHTS];
 };
 
-struct Material {
-    glm::vec3 Ka = glm::vec3(0.1f);
-    glm::vec3 Kd = glm::vec3(0.7f);
-    glm::vec3 Ks = glm::vec3(0.2f);
-    float Ns = 32.0f;
-    string map_Kd_path = "";
-    bool hasTexture = false;
+static_assert(sizeof(LightBlock) == 64, "LightBlock deve seguir o layout std140");
+
+struct TextureBuffer {
+    GLuint buffer = 0;
+    GLuint texture = 0;
 };
 
-struct Light {
-    glm::vec3 position = glm::vec3(0.0f);
-    glm::vec3 ambient = glm::vec3(0.2f);
-    glm::vec3 diffuse = glm::vec3(0.8f);
-    glm::vec3 specular = glm::vec3(1.0f);
-    bool enabled = true;
-    float intensity = 1.0f;
+// Entradas do caminho multi-draw indireto. GPUInstance e GPUMaterial
+// espelham os structs std430 DrawInstance e PackedMaterial dos shaders.
+const GLuint INSTANCE_BUFFER_BINDING = 1;
+const GLuint MATERIAL_BUFFER_BINDING = 2;
+const GLuint DRAW_INSTANCE_ATTRIB = 11;
+
+// Buffers do culling na GPU: caixas locais de cada objeto, comandos
+// indiretos (escritos pelo compute shader) e lista compactada de instâncias
+// visíveis, indexada pelo baseInstance de cada comando.
+const GLuint CULL_OBJECT_BINDING = 3;
+const GLuint COMMAND_BUFFER_BINDING = 4;
+const GLuint VISIBLE_BUFFER_BINDING = 5;
+const GLuint CULL_STATS_BINDING = 6;
+const GLuint CULL_WORKGROUP_SIZE = 64;
+
+// Pirâmide de profundidade (Hi-Z) para o teste de oclusão no culling na GPU.
+const GLuint HIZ_TEXTURE_UNIT = 4;
+const GLuint HIZ_WORKGROUP_SIZE = 8;
+
+// Primeira unidade de textura dos anexos do G-buffer no caminho deferred.
+const GLuint GBUFFER_TEXTURE_UNIT = 5;
+
+// Resolução do buffer de oclusão na CPU (múltiplos do bloco de 8x4).
+const int SOFTWARE_OCCLUSION_WIDTH = 256;
+const int SOFTWARE_OCCLUSION_HEIGHT = 192;
+
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+struct GPUInstance {
+    glm::mat4 model;
+    glm::vec4 normalMatrix[3];
+    GLuint materialIndex;
+    float selected;
+    float padding[2];
+};
+
+struct GPUMaterial {
+    glm::vec4 Ka;
+    glm::vec4 Kd;
+    glm::vec4 KsNs;
+    GLuint hasTexture;
+    GLuint padding[3];
+};
+
+struct GPUCullObject {
+    glm::vec4 boundsMin;
+    glm::vec4 boundsMax;
+    GLuint commandIndex;
+    GLuint padding[3];
 };
 
+static_assert(sizeof(GPUInstance) == 128, "GPUInstance deve seguir o layout std430");
+static_assert(sizeof(GPUMaterial) == 64, "GPUMaterial deve seguir o layout std430");
+static_assert(sizeof(GPUCullObject) == 48, "GPUCullObject deve seguir o layout std430");
+
+// A geometria fica na GeometryArena: o VAO de cada malha aponta para o
+// trecho dela no VBO compartilhado (baseVertex) e os índices começam em
+// firstIndex no EBO compartilhado.
 struct Mesh {
     GLuint VAO = 0;
-    GLuint VBO = 0;
-    GLuint EBO = 0;
+    GLuint instanceVBO = 0;
     int nIndices = 0;
-    glm::vec3 translation = glm::vec3(0.0f);
-    glm::vec3 rotation = glm::vec3(0.0f);
-    float scale = 1.0f;
+    GLint baseVertex = 0;
+    GLuint firstIndex = 0;
+    GLuint vertexCount = 0;
+    Transform transform;
     GLuint textureID = 0;
     Material material;
     glm::vec3 boundingBoxMin = glm::vec3(0.0f);
@@ -185,12 +256,29 @@ struct Mesh {
     Trajectory trajectory;
     string name = "";
     bool isSelected = false;
+    string assetPath = "";
+    int instanceCount = 1;
+    float instanceSpacing = 2.5f;
+    bool occluder = false;
+    std::shared_ptr<const OccluderMesh> occluderMesh;
+};
+
+struct InstanceGroup {
+    Mesh* mesh = nullptr;
+    std::vector<InstanceData> instances;
+    float nearestDepth = 0.0f;
 };
 
 Camera camera(glm::vec3(0.0f, 2.0f, 5.0f));
 std::vector<Mesh> meshes;
 std::vector<Light> lights;
 int selectedMesh = 0;
+unsigned objLoaderThreads = 0;
+bool meshCacheEnabled = true;
+string meshCacheDir = "";
+bool shaderCacheEnabled = true;
+string shaderCompileMode = "auto";
+string shaderCacheDir = "shadercache";
 
 bool firstMouse = true;
 float lastX = WIDTH / 2.0f;
@@ -199,6 +287,77 @@ float lastY = HEIGHT / 2.0f;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+GLuint lightUBO = 0;
+TextureBuffer lightDataTBO, clusterRangesTBO, lightIndicesTBO;
+LightClusterBuilder lightClusters;
+ClusterGrid clusterGrid;
+std::vector<ClusterLight> clusterLights;
+bool lightsDirty = true;
+// Tamanho do viewport em que os clusters foram montados; findCluster divide
+// gl_FragCoord por ele (clusterParams.zw).
+GLint clusterViewportWidth = 0, clusterViewportHeight = 0;
+size_t activeLightCount = 0;
+
+bool instancedRendering = true;
+bool multiDrawIndirect = true;
+bool frustumCulling = true;
+bool gpuCullingEnabled = false;
+bool occlusionCulling = true;
+bool validateGpuCulling = false;
+bool softwareOcclusion = false;
+bool depthPrepass = false;
+bool frontToBackSort = true;
+bool showOverdraw = false;
+bool deferredShading = false;
+bool stateSort = true;
+bool shaderPermutations = true;
+MaskedOcclusionBuffer occlusionBuffer;
+std::unique_ptr<ThreadPool> occlusionThreads;
+// Threads do parse de OBJ, criadas no primeiro arquivo e compartilhadas por
+// toda a carga da cena (threads = 1 em [loader] dispensa o pool).
+std::unique_ptr<ThreadPool> loaderThreads;
+size_t softwareOccludedCount = 0;
+CullingSet cullingSet;
+std::vector<uint8_t> meshVisible;
+size_t visibleMeshCount = 0;
+DrawSlotTable textureSlots(DRAW_KEY_TEXTURE_BITS);
+DrawSlotTable materialSlots(DRAW_KEY_MATERIAL_BITS);
+std::vector<DrawItem> drawItems, drawItemScratch;
+bool vsyncEnabled = true;
+// Framebuffer em que o quadro final é desenhado: o padrão da janela ou, no
+// modo headless, o FBO de OffscreenTarget.
+GLuint sceneFramebuffer = 0;
+
+// Modo headless (--headless, seção [headless]): número de quadros, passo de
+// tempo fixo, caminho da câmera e para onde vão os tempos e as imagens.
+int headlessFrames = 300;
+float headlessTimestep = 1.0f / 60.0f;
+Trajectory cameraPath;
+bool cameraLookAt = false;
+glm::vec3 cameraTarget = glm::vec3(0.0f);
+string timingCsvPath = "frame_timings.csv";
+string pngDir = "";
+int pngEvery = 0;
+float frameTimeAccum = 0.0f;
+// Escopos de CPU e passes de GPU de cada quadro (seção [profiler]).
+FrameProfiler profiler;
+bool profilerEnabled = true;
+int profilerHistory = 300;
+string traceFile = "frame_trace.json";
+// Tempos da partida até o primeiro quadro, por fase e por recurso (seção
+// [startup]). Com sync, cada envio à GPU espera o driver terminar, para o
+// tempo não escorregar para a fase seguinte ou para o primeiro quadro.
+StartupProfiler startupProfiler;
+string startupJsonFile = "startup_profile.json";
+bool startupSync = false;
+// HUD de desempenho (tecla F1, chave hud em [render]) e os contadores que
+// os draws e as alocações alimentam.
+bool hudEnabled = false;
+RenderCounters renderCounters;
+GpuMemoryCounter gpuMemory;
+int frameTimeSamples = 0;
+double submitTimeAccum = 0.0;
+
 GLuint pointVAO, pointVBO;
 GLuint lineVAO, lineVBO;
 GLuint previewPointVAO, previewPointVBO;
@@ -208,34 +367,79 @@ const char* vertexShaderSource = R"(
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in mat4 instanceModel;
+layout (location = 7) in mat3 instanceNormalMatrix;
+layout (location = 10) in float instanceSelected;
+layout (location = 11) in uint drawInstance;
+
+struct DrawInstance {
+    mat4 model;
+    mat3 normalMatrix;
+    uint materialIndex;
+    float selected;
+};
+
+layout (std430, binding = 1) readonly buffer InstanceBuffer {
+    DrawInstance drawInstances[];
+};
+
+layout (std430, binding = 5) readonly buffer VisibleBuffer {
+    uint visibleInstances[];
+};
 
 out vec3 fragPos_world;
 out vec3 fragNormal_world;
 out vec2 fragTexCoord;
+out float fragViewDepth;
+flat out int fragSelected;
+flat out int fragMaterial;
+
+// O pré-passe de profundidade calcula gl_Position em outro programa; sem
+// invariant o passe com GL_EQUAL poderia perder pixels por arredondamento.
+invariant gl_Position;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 uniform mat3 normalMatrix;
 uniform bool useOverride;
-uniform vec3 overrideColor;
+uniform bool useInstancing;
+uniform bool useDrawBuffers;
+uniform bool useVisibleList;
 
 void main() {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    fragPos_world = vec3(model * vec4(aPos, 1.0));
-    fragNormal_world = normalize(normalMatrix * aNormal);
+    mat4 modelMatrix = useInstancing ? instanceModel : model;
+    mat3 normalMat = useInstancing ? instanceNormalMatrix : normalMatrix;
+    fragSelected = useInstancing ? int(instanceSelected) : int(useOverride);
+    fragMaterial = -1;
+    if (useDrawBuffers) {
+        uint index = useVisibleList ? visibleInstances[drawInstance] : drawInstance;
+        DrawInstance instance = drawInstances[index];
+        modelMatrix = instance.model;
+        normalMat = instance.normalMatrix;
+        fragSelected = int(instance.selected);
+        fragMaterial = int(instance.materialIndex);
+    }
+    vec4 worldPos = modelMatrix * vec4(aPos, 1.0);
+    vec4 viewPos = view * worldPos;
+    gl_Position = projection * viewPos;
+    fragPos_world = vec3(worldPos);
+    fragNormal_world = normalize(normalMat * aNormal);
     fragTexCoord = aTexCoord;
+    fragViewDepth = -viewPos.z;
 }
 )";
 
-const char* fragmentShaderSource = R"(
+// Os fragment shaders são montados a partir de trechos em comum, passados
+// juntos para glShaderSource: materialShaderSource (sempre o primeiro, com a
+// diretiva #version), surfaceShaderSource (material e cor da superfície a
+// partir das entradas do vertex shader) e phongLightingSource (luzes,
+// clusters e Phong). Assim os caminhos forward e deferred iluminam com
+// exatamente a mesma conta. Entre o primeiro trecho e os demais podem vir
+// #defines de permutação (ver ShaderPermutation); sem eles o shader decide
+// tudo por fragmento, como um uber-shader.
+const char* materialShaderSource = R"(
 #version 450 core
-in vec3 fragPos_world;
-in vec3 fragNormal_world;
-in vec2 fragTexCoord;
-
-out vec4 FragColor;
-
 struct Material {
     vec3 Ka;
     vec3 Kd;
@@ -243,31 +447,102 @@ struct Material {
     float Ns;
     bool hasTexture;
 };
+)";
 
-struct Light {
-    vec3 position_world;
-    vec3 ambient_color;
-    vec3 diffuse_color;
-    vec3 specular_color;
-    bool enabled;
-    float intensity;
+const char* surfaceShaderSource = R"(
+in vec3 fragPos_world;
+in vec3 fragNormal_world;
+in vec2 fragTexCoord;
+in float fragViewDepth;
+flat in int fragSelected;
+flat in int fragMaterial;
+
+struct PackedMaterial {
+    vec4 Ka;
+    vec4 Kd;
+    vec4 KsNs;
+    uint hasTexture;
+};
+
+layout (std430, binding = 2) readonly buffer MaterialBuffer {
+    PackedMaterial drawMaterials[];
 };
 
 uniform Material material;
-uniform Light lights[8];
-uniform int numLights;
-uniform vec3 viewPos_world;
 uniform sampler2D textureSampler;
-uniform bool useOverride;
 uniform vec3 overrideColor;
 
-vec3 calculatePhongLighting(Light light, vec3 fragPos, vec3 normal, vec3 viewDir, vec3 materialColor) {
-    if (!light.enabled) {
-        return vec3(0.0);
+Material currentMaterial() {
+    if (fragMaterial < 0) return material;
+    PackedMaterial source = drawMaterials[fragMaterial];
+    return Material(source.Ka.rgb, source.Kd.rgb, source.KsNs.rgb, source.KsNs.w, source.hasTexture != 0u);
+}
+
+// TEXTURED e SELECTED, quando definidos, fixam na compilação o que o
+// uber-shader lê de mat.hasTexture e fragSelected.
+vec3 surfaceColor(Material mat) {
+#if defined(SELECTED)
+#if SELECTED
+    return overrideColor;
+#endif
+#endif
+    vec3 materialColor = mat.Kd;
+#if defined(TEXTURED)
+#if TEXTURED
+    materialColor *= texture(textureSampler, fragTexCoord).rgb;
+#endif
+#else
+    if (mat.hasTexture) {
+        materialColor *= texture(textureSampler, fragTexCoord).rgb;
     }
-    
-    vec3 ambient = light.ambient_color * material.Ka * light.intensity;
-    
+#endif
+
+#if !defined(SELECTED)
+    if (fragSelected != 0) {
+        materialColor = overrideColor;
+    }
+#endif
+    return materialColor;
+}
+)";
+
+const char* phongLightingSource = R"(
+struct Light {
+    vec3 position_world;
+    float intensity;
+    vec3 diffuse_color;
+    vec3 specular_color;
+};
+
+layout (std140, binding = 0) uniform LightBlock {
+    vec4 ambientSum;
+    ivec4 clusterGrid;
+    vec4 clusterParams;
+    ivec4 activeLights;
+};
+
+uniform samplerBuffer lightData;
+uniform usamplerBuffer clusterRanges;
+uniform usamplerBuffer lightIndices;
+
+Light fetchLight(int index) {
+    Light light;
+    vec4 positionIntensity = texelFetch(lightData, index * 3);
+    light.position_world = positionIntensity.xyz;
+    light.intensity = positionIntensity.w;
+    light.diffuse_color = texelFetch(lightData, index * 3 + 1).rgb;
+    light.specular_color = texelFetch(lightData, index * 3 + 2).rgb;
+    return light;
+}
+
+int findCluster(float viewDepth) {
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / clusterParams.zw * vec2(clusterGrid.xy)), ivec2(0), clusterGrid.xy - 1);
+    float slice = log(viewDepth / clusterParams.x) / log(clusterParams.y / clusterParams.x) * float(clusterGrid.z);
+    int z = clamp(int(floor(slice)), 0, clusterGrid.z - 1);
+    return (z * clusterGrid.y + tile.y) * clusterGrid.x + tile.x;
+}
+
+vec3 calculatePhongLighting(Light light, Material mat, vec3 fragPos, vec3 normal, vec3 viewDir, vec3 materialColor) {
     vec3 lightDir = normalize(light.position_world - fragPos);
     float distance = length(light.position_world - fragPos);
     float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * distance * distance);
@@ -276,30 +551,128 @@ vec3 calculatePhongLighting(Light light, vec3 fragPos, vec3 normal, vec3 viewDir
     vec3 diffuse = light.diffuse_color * diff * materialColor * attenuation * light.intensity;
     
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec_intensity = pow(max(dot(viewDir, reflectDir), 0.0), material.Ns);
-    vec3 specular = light.specular_color * spec_intensity * material.Ks * attenuation * light.intensity;
+    float spec_intensity = pow(max(dot(viewDir, reflectDir), 0.0), mat.Ns);
+    vec3 specular = light.specular_color * spec_intensity * mat.Ks * attenuation * light.intensity;
     
-    return ambient + diffuse + specular;
+    return diffuse + specular;
+}
+
+// Ambiente não sofre atenuação: a soma vem pronta no LightBlock. Com
+// LIGHT_COUNT definido, o laço tem tamanho fixo e percorre as luzes ligadas
+// (activeLights) sem consultar os clusters; fora do raio de cada luz a
+// contribuição fica abaixo de 1/256.
+vec3 shadeFragment(Material mat, vec3 fragPos, vec3 normal, vec3 viewDir, vec3 materialColor, float viewDepth) {
+    vec3 finalColor = ambientSum.rgb * mat.Ka;
+#if defined(LIGHT_COUNT)
+    for (int i = 0; i < LIGHT_COUNT; ++i) {
+        finalColor += calculatePhongLighting(fetchLight(activeLights[i]), mat, fragPos, normal, viewDir, materialColor);
+    }
+#else
+    uvec2 range = texelFetch(clusterRanges, findCluster(viewDepth)).xy;
+    for (uint i = 0u; i < range.y; ++i) {
+        int lightIndex = int(texelFetch(lightIndices, int(range.x + i)).r);
+        finalColor += calculatePhongLighting(fetchLight(lightIndex), mat, fragPos, normal, viewDir, materialColor);
+    }
+#endif
+    return finalColor;
 }
+)";
+
+const char* fragmentShaderSource = R"(
+out vec4 FragColor;
+
+uniform vec3 viewPos_world;
+uniform bool showOverdraw;
 
 void main() {
+    // Visualização de overdraw: com blending aditivo, cada fragmento
+    // sombreado soma um degrau de cor ao pixel.
+    if (showOverdraw) {
+        FragColor = vec4(0.125, 0.05, 0.02, 1.0);
+        return;
+    }
+
     vec3 norm = normalize(fragNormal_world);
     vec3 viewDir = normalize(viewPos_world - fragPos_world);
-    
-    vec3 materialColor = material.Kd;
-    if (material.hasTexture) {
-        materialColor *= texture(textureSampler, fragTexCoord).rgb;
-    }
-    
-    if (useOverride) {
-        materialColor = overrideColor;
+    Material mat = currentMaterial();
+    vec3 finalColor = shadeFragment(mat, fragPos_world, norm, viewDir, surfaceColor(mat), fragViewDepth);
+    FragColor = vec4(finalColor, 1.0);
+}
+)";
+
+// Passe de geometria do caminho deferred: grava no G-buffer o que o Phong
+// precisa por pixel. A profundidade na view vai junto da posição e marca
+// os pixels com geometria (o fundo fica com zero).
+const char* gbufferFragmentShaderSource = R"(
+layout (location = 0) out vec4 gPosition;
+layout (location = 1) out vec4 gNormal;
+layout (location = 2) out vec4 gAlbedo;
+layout (location = 3) out vec4 gAmbient;
+layout (location = 4) out vec4 gSpecular;
+
+uniform bool showOverdraw;
+
+void main() {
+    gPosition = vec4(fragPos_world, fragViewDepth);
+    if (showOverdraw) {
+        gNormal = vec4(0.0);
+        gAlbedo = vec4(0.125, 0.05, 0.02, 1.0);
+        gAmbient = vec4(0.0);
+        gSpecular = vec4(0.0);
+        return;
     }
-    
-    vec3 finalColor = vec3(0.0);
-    for (int i = 0; i < numLights && i < 8; ++i) {
-        finalColor += calculatePhongLighting(lights[i], fragPos_world, norm, viewDir, materialColor);
+
+    Material mat = currentMaterial();
+    gNormal = vec4(normalize(fragNormal_world), 0.0);
+    gAlbedo = vec4(surfaceColor(mat), 1.0);
+    gAmbient = vec4(mat.Ka, 1.0);
+    gSpecular = vec4(mat.Ks, mat.Ns);
+}
+)";
+
+// Passe de iluminação do caminho deferred: um triângulo que cobre a tela,
+// gerado a partir de gl_VertexID, sem buffers de vértices.
+const char* deferredVertexShaderSource = R"(
+#version 450 core
+void main() {
+    vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// Cada pixel refaz o Material a partir do G-buffer e avalia só as luzes do
+// seu cluster, com o mesmo shadeFragment do caminho forward. A
+// profundidade do G-buffer é copiada para o framebuffer padrão, onde a
+// pirâmide Hi-Z e as visualizações de trajetória a encontram.
+const char* deferredLightingShaderSource = R"(
+out vec4 FragColor;
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedo;
+uniform sampler2D gAmbient;
+uniform sampler2D gSpecular;
+uniform sampler2D gDepth;
+uniform vec3 viewPos_world;
+uniform bool showOverdraw;
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec4 positionDepth = texelFetch(gPosition, pixel, 0);
+    if (positionDepth.w == 0.0) discard;
+    gl_FragDepth = texelFetch(gDepth, pixel, 0).r;
+
+    vec3 albedo = texelFetch(gAlbedo, pixel, 0).rgb;
+    if (showOverdraw) {
+        FragColor = vec4(albedo, 1.0);
+        return;
     }
-    
+
+    vec4 specular = texelFetch(gSpecular, pixel, 0);
+    Material mat = Material(texelFetch(gAmbient, pixel, 0).rgb, albedo, specular.rgb, specular.a, false);
+    vec3 normal = normalize(texelFetch(gNormal, pixel, 0).xyz);
+    vec3 viewDir = normalize(viewPos_world - positionDepth.xyz);
+    vec3 finalColor = shadeFragment(mat, positionDepth.xyz, normal, viewDir, albedo, positionDepth.w);
     FragColor = vec4(finalColor, 1.0);
 }
 )";
@@ -328,6 +701,261 @@ void main() {
 }
 )";
 
+// HUD de desempenho: posições em pixels a partir do canto superior
+// esquerdo, cor por vértice e cobertura lida do atlas de glifos (R8).
+const char* hudVertexShaderSource = R"(
+#version 450 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+
+uniform vec2 screenSize;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+void main() {
+    gl_Position = vec4(aPos.x / screenSize.x * 2.0 - 1.0, 1.0 - aPos.y / screenSize.y * 2.0, 0.0, 1.0);
+    TexCoord = aTexCoord;
+    Color = aColor;
+}
+)";
+
+const char* hudFragmentShaderSource = R"(
+#version 450 core
+in vec2 TexCoord;
+in vec4 Color;
+out vec4 FragColor;
+
+uniform sampler2D atlas;
+
+void main() {
+    FragColor = vec4(Color.rgb, Color.a * texture(atlas, TexCoord).r);
+}
+)";
+
+// Pré-passe de profundidade: só a posição entra no vertex shader, e a
+// transformação repete a do vertexShaderSource expressão por expressão
+// (com invariant), para que o passe de iluminação com GL_EQUAL encontre
+// exatamente a mesma profundidade.
+const char* depthVertexShaderSource = R"(
+#version 450 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 instanceModel;
+layout (location = 11) in uint drawInstance;
+
+struct DrawInstance {
+    mat4 model;
+    mat3 normalMatrix;
+    uint materialIndex;
+    float selected;
+};
+
+layout (std430, binding = 1) readonly buffer InstanceBuffer {
+    DrawInstance drawInstances[];
+};
+
+layout (std430, binding = 5) readonly buffer VisibleBuffer {
+    uint visibleInstances[];
+};
+
+invariant gl_Position;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform bool useInstancing;
+uniform bool useDrawBuffers;
+uniform bool useVisibleList;
+
+void main() {
+    mat4 modelMatrix = useInstancing ? instanceModel : model;
+    if (useDrawBuffers) {
+        uint index = useVisibleList ? visibleInstances[drawInstance] : drawInstance;
+        modelMatrix = drawInstances[index].model;
+    }
+    vec4 worldPos = modelMatrix * vec4(aPos, 1.0);
+    vec4 viewPos = view * worldPos;
+    gl_Position = projection * viewPos;
+}
+)";
+
+const char* depthFragmentShaderSource = R"(
+#version 450 core
+void main() {
+}
+)";
+
+// Culling na GPU: uma invocação por objeto. A caixa local é levada ao mundo
+// como em CullingSet::add e testada contra os seis planos como em
+// cullAABBsScalar; os objetos visíveis ganham uma vaga no comando da sua
+// malha (atomicAdd em instanceCount) e entram na lista compactada a partir
+// do baseInstance desse comando.
+const char* cullComputeShaderSource = R"(
+#version 450 core
+layout (local_size_x = 64) in;
+
+struct DrawInstance {
+    mat4 model;
+    mat3 normalMatrix;
+    uint materialIndex;
+    float selected;
+};
+
+struct CullObject {
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uint commandIndex;
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 1) readonly buffer InstanceBuffer {
+    DrawInstance drawInstances[];
+};
+
+layout (std430, binding = 3) readonly buffer CullObjectBuffer {
+    CullObject cullObjects[];
+};
+
+layout (std430, binding = 4) buffer CommandBuffer {
+    DrawCommand commands[];
+};
+
+layout (std430, binding = 5) writeonly buffer VisibleBuffer {
+    uint visibleInstances[];
+};
+
+layout (std430, binding = 6) buffer CullStats {
+    uint frustumCulled;
+    uint occluded;
+};
+
+uniform vec4 frustumPlanes[6];
+uniform uint objectCount;
+uniform bool cullingEnabled;
+
+uniform bool occlusionEnabled;
+uniform sampler2D hizPyramid;
+uniform mat4 hizViewProjection;
+uniform int hizMaxLevel;
+uniform ivec2 hizSize;
+
+// Projeta a caixa com a view-projection do quadro em que a pirâmide foi
+// gerada e compara a profundidade mais próxima da caixa com a mais
+// distante da região de tela que ela cobre, no nível em que essa região
+// ocupa no máximo 2x2 texels. Os tamanhos dos níveis vêm de hizSize e não
+// de textureSize(), que no llvmpipe devolve o tamanho do nível 0.
+bool occludedByHiZ(vec3 worldCenter, vec3 worldExtent) {
+    vec3 ndcMin = vec3(1e30);
+    vec3 ndcMax = vec3(-1e30);
+    for (int c = 0; c < 8; ++c) {
+        vec3 signs = vec3((c & 1) != 0 ? 1.0 : -1.0, (c & 2) != 0 ? 1.0 : -1.0, (c & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip = hizViewProjection * vec4(worldCenter + worldExtent * signs, 1.0);
+        if (clip.w <= 0.0) return false;
+        vec3 ndc = clip.xyz / clip.w;
+        ndcMin = min(ndcMin, ndc);
+        ndcMax = max(ndcMax, ndc);
+    }
+    float nearestDepth = ndcMin.z * 0.5 + 0.5;
+
+    ivec2 baseSize = hizSize;
+    ivec2 pixelMin = clamp(ivec2(floor((ndcMin.xy * 0.5 + 0.5) * vec2(baseSize))), ivec2(0), baseSize - 1);
+    ivec2 pixelMax = clamp(ivec2(floor((ndcMax.xy * 0.5 + 0.5) * vec2(baseSize))), ivec2(0), baseSize - 1);
+    int level = 0;
+    while (level < hizMaxLevel && any(greaterThan((pixelMax >> level) - (pixelMin >> level), ivec2(1)))) level++;
+
+    ivec2 levelSize = max(baseSize >> level, ivec2(1));
+    ivec2 texelMin = min(pixelMin >> level, levelSize - 1);
+    ivec2 texelMax = min(pixelMax >> level, levelSize - 1);
+    float farthestDepth = 0.0;
+    for (int y = texelMin.y; y <= texelMax.y; ++y) {
+        for (int x = texelMin.x; x <= texelMax.x; ++x) {
+            farthestDepth = max(farthestDepth, texelFetch(hizPyramid, ivec2(x, y), level).r);
+        }
+    }
+    return nearestDepth > farthestDepth;
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= objectCount) return;
+
+    CullObject object = cullObjects[index];
+    mat4 model = drawInstances[index].model;
+    vec3 center = (object.boundsMin.xyz + object.boundsMax.xyz) * 0.5;
+    vec3 extent = (object.boundsMax.xyz - object.boundsMin.xyz) * 0.5;
+    vec3 worldCenter = vec3(model * vec4(center, 1.0));
+    vec3 worldExtent = abs(model[0].xyz) * extent.x + abs(model[1].xyz) * extent.y + abs(model[2].xyz) * extent.z;
+
+    bool visible = true;
+    for (int p = 0; p < 6 && visible && cullingEnabled; ++p) {
+        vec4 plane = frustumPlanes[p];
+        float distance = dot(plane.xyz, worldCenter) + plane.w;
+        float radius = dot(abs(plane.xyz), worldExtent);
+        visible = distance + radius >= 0.0;
+    }
+    if (!visible) {
+        atomicAdd(frustumCulled, 1u);
+        return;
+    }
+    if (occlusionEnabled && occludedByHiZ(worldCenter, worldExtent)) {
+        atomicAdd(occluded, 1u);
+        return;
+    }
+
+    uint slot = atomicAdd(commands[object.commandIndex].instanceCount, 1u);
+    visibleInstances[commands[object.commandIndex].baseInstance + slot] = index;
+}
+)";
+
+// Redução da pirâmide Hi-Z: o nível 0 copia a profundidade do quadro e
+// cada nível seguinte guarda a maior profundidade (a mais distante) dos
+// texels que cobre no nível anterior. Em dimensões ímpares o último texel
+// de cada linha/coluna absorve também a sobra.
+const char* hizReduceShaderSource = R"(
+#version 450 core
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (r32f, binding = 0) uniform writeonly image2D destination;
+uniform sampler2D source;
+uniform int sourceLevel;
+uniform ivec2 sourceSize;
+uniform bool copyLevel;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(destination);
+    if (any(greaterThanEqual(texel, size))) return;
+
+    float depth = 0.0;
+    if (copyLevel) {
+        depth = texelFetch(source, texel, 0).r;
+    } else {
+        ivec2 first = texel * 2;
+        ivec2 last = first + 1;
+        if (texel.x == size.x - 1) last.x = sourceSize.x - 1;
+        if (texel.y == size.y - 1) last.y = sourceSize.y - 1;
+        for (int y = first.y; y <= last.y; ++y) {
+            for (int x = first.x; x <= last.x; ++x) {
+                depth = max(depth, texelFetch(source, ivec2(x, y), sourceLevel).r);
+            }
+        }
+    }
+    imageStore(destination, texel, vec4(depth));
+}
+)";
+
+void startupGpuSync() {
+    if (startupSync && startupProfiler.enabled() && !startupProfiler.finished()) glFinish();
+}
+
 GLuint loadTexture(const string& texturePath) {
     GLuint textureID;
     glGenTextures(1, &textureID);
@@ -340,15 +968,28 @@ GLuint loadTexture(const string& texturePath) {
 
     int width, height, nrChannels;
     stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(texturePath.c_str(), &width, &height, &nrChannels, 0);
+    unsigned char* data = nullptr;
+    {
+        StartupScope scope(startupProfiler, STARTUP_PHASE_IMAGE_DECODE, texturePath);
+        data = stbi_load(texturePath.c_str(), &width, &height, &nrChannels, 0);
+    }
     if (data) {
         GLenum format = GL_RGB;
         if (nrChannels == 1) format = GL_RED;
         else if (nrChannels == 3) format = GL_RGB;
         else if (nrChannels == 4) format = GL_RGBA;
         
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        {
+            StartupScope scope(startupProfiler, STARTUP_PHASE_GPU_UPLOAD, texturePath);
+            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+            startupGpuSync();
+        }
+        {
+            StartupScope scope(startupProfiler, STARTUP_PHASE_MIPMAPS, texturePath);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            startupGpuSync();
+        }
+        gpuMemory.set(GPU_MEMORY_TEXTURE, textureID, mipmappedTextureBytes(width, height, nrChannels));
     } else {
         cerr << "Falha ao carregar textura: " << texturePath << endl;
         textureID = 0;
@@ -358,255 +999,2647 @@ GLuint loadTexture(const string& texturePath) {
     return textureID;
 }
 
-Material loadMTL(const string& mtlPath) {
-    Material material;
-    std::ifstream file(mtlPath);
-    if (!file.is_open()) {
-        cerr << "Erro ao abrir MTL: " << mtlPath << endl;
-        return material;
-    }
-
-    string line;
-    while (getline(file, line)) {
-        istringstream ss(line);
-        string word;
-        ss >> word;
-
-        if (word == "Ka") {
-            ss >> material.Ka.r >> material.Ka.g >> material.Ka.b;
-        } else if (word == "Kd") {
-            ss >> material.Kd.r >> material.Kd.g >> material.Kd.b;
-        } else if (word == "Ks") {
-            ss >> material.Ks.r >> material.Ks.g >> material.Ks.b;
-        } else if (word == "Ns") {
-            ss >> material.Ns;
-        } else if (word == "map_Kd") {
-            string textureFile;
-            ss >> textureFile;
-            size_t lastSlash = mtlPath.find_last_of("\\/");
-            string basePath = (lastSlash == string::npos) ? "" : mtlPath.substr(0, lastSlash + 1);
-            material.map_Kd_path = basePath + textureFile;
-            material.hasTexture = true;
-        }
-    }
-    file.close();
-    return material;
-}
+// Um VBO e um EBO únicos onde todas as malhas são suballocadas. Crescer
+// copia o conteúdo por um buffer temporário e mantém os nomes dos buffers,
+// então os VAOs já criados sobre eles continuam válidos.
+class GeometryArena {
+public:
+    static const size_t VERTEX_STRIDE = 8 * sizeof(GLfloat);
 
-bool loadSimpleOBJ(const string& filePath, Mesh& outMesh) {
-    std::vector<glm::vec3> temp_vertices;
-    std::vector<glm::vec2> temp_texCoords;
-    std::vector<glm::vec3> temp_normals;
+    static const size_t POSITION_STRIDE = 3 * sizeof(GLfloat);
 
-    std::vector<GLfloat> vBuffer_data;
-    std::vector<GLuint> indices_data;
-    std::map<string, GLuint> vertex_to_index_map;
-    GLuint next_index = 0;
+    void init(size_t vertexCapacity, size_t indexCapacity) {
+        glGenBuffers(1, &vbo);
+        glGenBuffers(1, &positionVbo);
+        glGenBuffers(1, &ebo);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * VERTEX_STRIDE, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, positionVbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * POSITION_STRIDE, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+        glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        gpuMemory.set(GPU_MEMORY_BUFFER, vbo, vertexCapacity * VERTEX_STRIDE);
+        gpuMemory.set(GPU_MEMORY_BUFFER, positionVbo, vertexCapacity * POSITION_STRIDE);
+        gpuMemory.set(GPU_MEMORY_BUFFER, ebo, indexCapacity * sizeof(GLuint));
+        vertexRanges.grow(vertexCapacity);
+        indexRanges.grow(indexCapacity);
 
-    string mtlFilePath = "";
-    
-    glm::vec3 minBounds = glm::vec3(FLT_MAX);
-    glm::vec3 maxBounds = glm::vec3(-FLT_MAX);
-    
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        cerr << "Erro ao abrir OBJ: " << filePath << endl;
-        return false;
-    }
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+        bindVertexFormat(0);
+        glBindVertexArray(0);
 
-    std::string line;
-    while (getline(file, line)) {
-        std::istringstream ss(line);
-        std::string word;
-        ss >> word;
-
-        if (word == "mtllib") {
-            ss >> mtlFilePath;
-            size_t lastSlash = filePath.find_last_of("\\/");
-            string basePath = (lastSlash == string::npos) ? "" : filePath.substr(0, lastSlash + 1);
-            mtlFilePath = basePath + mtlFilePath;
-        } else if (word == "v") {
-            glm::vec3 vert;
-            ss >> vert.x >> vert.y >> vert.z;
-            temp_vertices.push_back(vert);
-            
-            minBounds = glm::min(minBounds, vert);
-            maxBounds = glm::max(maxBounds, vert);
-        } else if (word == "vt") {
-            glm::vec2 tex;
-            ss >> tex.x >> tex.y;
-            temp_texCoords.push_back(tex);
-        } else if (word == "vn") {
-            glm::vec3 norm;
-            ss >> norm.x >> norm.y >> norm.z;
-            temp_normals.push_back(norm);
-        } else if (word == "f") {
-            for (int i = 0; i < 3; ++i) {
-                ss >> word;
-                
-                if (vertex_to_index_map.find(word) == vertex_to_index_map.end()) {
-                    vertex_to_index_map[word] = next_index;
-
-                    size_t p_slash1 = word.find('/');
-                    size_t p_slash2 = word.find('/', p_slash1 + 1);
-
-                    int vIndex = stoi(word.substr(0, p_slash1)) - 1;
-                    
-                    vBuffer_data.push_back(temp_vertices[vIndex].x);
-                    vBuffer_data.push_back(temp_vertices[vIndex].y);
-                    vBuffer_data.push_back(temp_vertices[vIndex].z);
-                    
-                    int vnIndex = -1;
-                    if (p_slash2 != string::npos && p_slash2 + 1 < word.length()){
-                        vnIndex = stoi(word.substr(p_slash2 + 1)) - 1;
-                    }
+        glGenVertexArrays(1, &positionVao);
+        glBindVertexArray(positionVao);
+        glBindBuffer(GL_ARRAY_BUFFER, positionVbo);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, POSITION_STRIDE, (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBindVertexArray(0);
+    }
 
-                    if (vnIndex >= 0 && vnIndex < temp_normals.size()) {
-                        vBuffer_data.push_back(temp_normals[vnIndex].x);
-                        vBuffer_data.push_back(temp_normals[vnIndex].y);
-                        vBuffer_data.push_back(temp_normals[vnIndex].z);
-                    } else {
-                        vBuffer_data.push_back(0.0f); vBuffer_data.push_back(1.0f); vBuffer_data.push_back(0.0f);
-                    }
+    void destroy() {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteVertexArrays(1, &positionVao);
+        for (GLuint buffer : { vbo, positionVbo, ebo }) gpuMemory.release(GPU_MEMORY_BUFFER, buffer);
+        glDeleteBuffers(1, &vbo);
+        glDeleteBuffers(1, &positionVbo);
+        glDeleteBuffers(1, &ebo);
+    }
 
-                    int vtIndex = -1;
-                    if (p_slash1 != string::npos && p_slash1 + 1 < word.length() && (p_slash2 == string::npos || p_slash1 + 1 != p_slash2) ) {
-                         if (p_slash2 != string::npos) {
-                             vtIndex = stoi(word.substr(p_slash1 + 1, p_slash2 - (p_slash1 + 1))) - 1;
-                         } else {
-                             vtIndex = stoi(word.substr(p_slash1 + 1)) - 1;
-                         }
-                    }
-                    
-                    if (vtIndex >= 0 && vtIndex < temp_texCoords.size()) {
-                        vBuffer_data.push_back(temp_texCoords[vtIndex].x);
-                        vBuffer_data.push_back(temp_texCoords[vtIndex].y);
-                    } else {
-                        vBuffer_data.push_back(0.0f); vBuffer_data.push_back(0.0f);
-                    }
-                    next_index++;
-                }
-                indices_data.push_back(vertex_to_index_map[word]);
-            }
+    // Reserva espaço e envia a malha; baseVertex/firstIndex são contados em
+    // vértices e índices, não em bytes. As posições também vão, compactadas,
+    // para um VBO paralelo no mesmo deslocamento, lido pelo pré-passe de
+    // profundidade.
+    bool upload(const GLfloat* vertices, size_t vertexCount, const GLuint* indices, size_t indexCount,
+                GLint& baseVertex, GLuint& firstIndex) {
+        size_t vertexOffset = allocate(vertexRanges, { { vbo, VERTEX_STRIDE }, { positionVbo, POSITION_STRIDE } }, vertexCount);
+        size_t indexOffset = allocate(indexRanges, { { ebo, sizeof(GLuint) } }, indexCount);
+        if (vertexOffset == RangeAllocator::INVALID || indexOffset == RangeAllocator::INVALID) {
+            vertexRanges.free(vertexOffset, vertexCount);
+            indexRanges.free(indexOffset, indexCount);
+            return false;
         }
+        positions.resize(vertexCount * 3);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            for (int k = 0; k < 3; ++k) positions[v * 3 + k] = vertices[v * 8 + k];
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, vertexOffset * VERTEX_STRIDE, vertexCount * VERTEX_STRIDE, vertices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, positionVbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, vertexOffset * POSITION_STRIDE, vertexCount * POSITION_STRIDE, positions.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset * sizeof(GLuint), indexCount * sizeof(GLuint), indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        baseVertex = (GLint)vertexOffset;
+        firstIndex = (GLuint)indexOffset;
+        return true;
+    }
+
+    void free(GLint baseVertex, size_t vertexCount, GLuint firstIndex, size_t indexCount) {
+        vertexRanges.free((size_t)baseVertex, vertexCount);
+        indexRanges.free(firstIndex, indexCount);
+    }
+
+    // Liga o VBO da arena aos atributos 0-2 (posição, normal, UV) e o EBO ao
+    // VAO atual, começando no vértice `baseVertex`.
+    void bindVertexFormat(GLint baseVertex) const {
+        size_t offset = (size_t)baseVertex * VERTEX_STRIDE;
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, (void*)offset);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, (void*)(offset + 3 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, (void*)(offset + 6 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(2);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    }
+
+    // VAO com a arena inteira a partir do vértice 0, usado pelo multi-draw.
+    GLuint vertexArray() const { return vao; }
+    // Mesmo endereçamento, mas só com as posições (atributo 0).
+    GLuint positionArray() const { return positionVao; }
+    size_t vertexBytesUsed() const { return vertexRanges.used() * VERTEX_STRIDE; }
+    size_t indexBytesUsed() const { return indexRanges.used() * sizeof(GLuint); }
+
+private:
+    // Os buffers listados compartilham os deslocamentos de `ranges` (cada um
+    // com seu tamanho de elemento) e crescem juntos.
+    static size_t allocate(RangeAllocator& ranges, std::initializer_list<std::pair<GLuint, size_t>> buffers, size_t count) {
+        size_t offset = ranges.allocate(count);
+        if (offset != RangeAllocator::INVALID) return offset;
+
+        size_t oldCapacity = ranges.capacity();
+        size_t newCapacity = max(oldCapacity * 2, oldCapacity + count);
+        for (const auto& buffer : buffers) {
+            size_t elementSize = buffer.second;
+            GLuint temp = 0;
+            glGenBuffers(1, &temp);
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer.first);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, temp);
+            glBufferData(GL_COPY_WRITE_BUFFER, oldCapacity * elementSize, nullptr, GL_STREAM_COPY);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldCapacity * elementSize);
+            glBufferData(GL_COPY_READ_BUFFER, newCapacity * elementSize, nullptr, GL_STATIC_DRAW);
+            glCopyBufferSubData(GL_COPY_WRITE_BUFFER, GL_COPY_READ_BUFFER, 0, 0, oldCapacity * elementSize);
+            gpuMemory.set(GPU_MEMORY_BUFFER, buffer.first, newCapacity * elementSize);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            glDeleteBuffers(1, &temp);
+        }
+
+        ranges.grow(newCapacity);
+        return ranges.allocate(count);
+    }
+
+    GLuint vao = 0;
+    GLuint positionVao = 0;
+    GLuint vbo = 0;
+    GLuint positionVbo = 0;
+    GLuint ebo = 0;
+    std::vector<GLfloat> positions;
+    RangeAllocator vertexRanges;
+    RangeAllocator indexRanges;
+};
+
+GeometryArena geometryArena;
+
+// Registro de recursos compartilhados: cada OBJ e cada textura é carregado
+// uma única vez por caminho canônico e liberado quando o último objeto que o
+// referencia é descartado. Os objetos da cena só guardam transformação,
+// trajetória e seleção próprias.
+class AssetRegistry {
+public:
+    bool acquireMesh(const string& filePath, Mesh& outMesh);
+    void releaseMesh(Mesh& mesh);
+    bool acquireOccluder(Mesh& mesh);
+
+    void retainMesh(const Mesh& mesh) {
+        auto it = meshAssets.find(mesh.assetPath);
+        if (it != meshAssets.end()) it->second.refCount++;
+    }
+
+    GLuint acquireTexture(const string& texturePath) {
+        string key = meshcache::canonicalPath(texturePath);
+        auto it = textures.find(key);
+        if (it == textures.end()) {
+            GLuint textureID = loadTexture(texturePath);
+            if (textureID == 0) return 0;
+            it = textures.emplace(key, TextureAsset{ textureID, 0 }).first;
+        }
+        it->second.refCount++;
+        return it->second.textureID;
+    }
+
+    void releaseTexture(const string& texturePath) {
+        auto it = textures.find(meshcache::canonicalPath(texturePath));
+        if (it == textures.end() || --it->second.refCount > 0) return;
+        gpuMemory.release(GPU_MEMORY_TEXTURE, it->second.textureID);
+        glDeleteTextures(1, &it->second.textureID);
+        textures.erase(it);
+    }
+
+    size_t meshCount() const { return meshAssets.size(); }
+    size_t textureCount() const { return textures.size(); }
+
+private:
+    struct MeshAsset {
+        Mesh prototype;
+        int refCount = 0;
+        string sourcePath;
+        std::shared_ptr<const OccluderMesh> occluder;
+    };
+
+    struct TextureAsset {
+        GLuint textureID = 0;
+        int refCount = 0;
+    };
+
+    unordered_map<string, MeshAsset> meshAssets;
+    unordered_map<string, TextureAsset> textures;
+};
+
+AssetRegistry assets;
+
+void setupMeshMaterial(Mesh& outMesh, const Material& material) {
+    outMesh.material = material;
+    if (outMesh.material.hasTexture && !outMesh.material.map_Kd_path.empty()) {
+        outMesh.textureID = assets.acquireTexture(outMesh.material.map_Kd_path);
+        if (outMesh.textureID == 0) {
+            outMesh.material.hasTexture = false;
+        }
+    } else {
+         outMesh.material.hasTexture = false;
+    }
+}
+
+bool uploadMeshBuffers(Mesh& outMesh, const GLfloat* vertices, size_t vertexFloatCount, const GLuint* indices, size_t indexCount) {
+    outMesh.vertexCount = (GLuint)(vertexFloatCount / 8);
+    if (!geometryArena.upload(vertices, outMesh.vertexCount, indices, indexCount, outMesh.baseVertex, outMesh.firstIndex)) {
+        cerr << "Erro: malha vazia ou sem espaco na arena de geometria" << endl;
+        if (outMesh.textureID != 0) assets.releaseTexture(outMesh.material.map_Kd_path);
+        return false;
+    }
+
+    glGenVertexArrays(1, &outMesh.VAO);
+    glBindVertexArray(outMesh.VAO);
+    geometryArena.bindVertexFormat(outMesh.baseVertex);
+
+    InstanceData identity = { glm::mat4(1.0f), glm::mat3(1.0f), 0.0f };
+    glGenBuffers(1, &outMesh.instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, outMesh.instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData), &identity, GL_DYNAMIC_DRAW);
+    gpuMemory.set(GPU_MEMORY_BUFFER, outMesh.instanceVBO, sizeof(InstanceData));
+    for (int i = 0; i < 4; ++i) {
+        glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(i * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + i);
+        glVertexAttribDivisor(3 + i, 1);
+    }
+    for (int i = 0; i < 3; ++i) {
+        glVertexAttribPointer(7 + i, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(sizeof(glm::mat4) + i * sizeof(glm::vec3)));
+        glEnableVertexAttribArray(7 + i);
+        glVertexAttribDivisor(7 + i, 1);
+    }
+    glVertexAttribPointer(10, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(sizeof(glm::mat4) + sizeof(glm::mat3)));
+    glEnableVertexAttribArray(10);
+    glVertexAttribDivisor(10, 1);
+
+    glBindVertexArray(0);
+
+    outMesh.nIndices = indexCount;
+    return true;
+}
+
+ThreadPool* loaderPool() {
+    if (objLoaderThreads == 1) return nullptr;
+    if (!loaderThreads) loaderThreads.reset(new ThreadPool(objLoaderThreads));
+    return loaderThreads.get();
+}
+
+bool loadSimpleOBJ(const string& filePath, Mesh& outMesh) {
+    MeshSource source;
+    if (!loadMeshSource(filePath, { meshCacheEnabled, meshCacheDir, loaderPool() }, source)) return false;
+    if (source.fromCache) {
+        startupProfiler.add(STARTUP_PHASE_MESH_CACHE, filePath, source.readMs);
+    } else {
+        startupProfiler.add(STARTUP_PHASE_OBJ_PARSE, filePath, source.readMs);
+        startupProfiler.add(STARTUP_PHASE_MTL_PARSE, filePath, source.materialMs);
+        if (meshCacheEnabled) startupProfiler.add(STARTUP_PHASE_MESH_CACHE, filePath, source.cacheWriteMs);
+    }
+    outMesh.boundingBoxMin = source.boundsMin;
+    outMesh.boundingBoxMax = source.boundsMax;
+    setupMeshMaterial(outMesh, source.material);
+    StartupScope scope(startupProfiler, STARTUP_PHASE_GPU_UPLOAD, filePath);
+    bool uploaded = uploadMeshBuffers(outMesh, source.vertices, source.vertexFloatCount, source.indices, source.indexCount);
+    startupGpuSync();
+    return uploaded;
+}
+
+// Copia só as posições (os 3 primeiros floats de cada vértice) e os índices.
+void extractOccluderMesh(const GLfloat* vertices, size_t vertexFloatCount, const GLuint* indices, size_t indexCount, OccluderMesh& out) {
+    out.positions.resize(vertexFloatCount / 8);
+    for (size_t i = 0; i < out.positions.size(); ++i) {
+        out.positions[i] = glm::vec3(vertices[i * 8], vertices[i * 8 + 1], vertices[i * 8 + 2]);
+    }
+    out.indices.assign(indices, indices + indexCount);
+}
+
+bool loadOccluderMesh(const string& filePath, OccluderMesh& out) {
+    MappedFile cacheFile;
+    MeshCacheData cached;
+    auto start = std::chrono::steady_clock::now();
+    if (meshCacheEnabled && readMeshCache(meshCachePath(filePath, meshCacheDir), filePath, cacheFile, cached)) {
+        startupProfiler.add(STARTUP_PHASE_MESH_CACHE, filePath, millisecondsSince(start));
+        extractOccluderMesh(cached.vertices, cached.vertexFloatCount, cached.indices, cached.indexCount, out);
+        return true;
+    }
+    ObjMeshData objData;
+    if (!loadOBJData(filePath, objData, loaderPool())) {
+        cerr << "Erro ao abrir OBJ do oclusor: " << filePath << endl;
+        return false;
+    }
+    startupProfiler.add(STARTUP_PHASE_OBJ_PARSE, filePath, millisecondsSince(start));
+    extractOccluderMesh(objData.vertices.data(), objData.vertices.size(), objData.indices.data(), objData.indices.size(), out);
+    return true;
+}
+
+bool AssetRegistry::acquireMesh(const string& filePath, Mesh& outMesh) {
+    string key = meshcache::canonicalPath(filePath);
+    auto it = meshAssets.find(key);
+    if (it == meshAssets.end()) {
+        MeshAsset asset;
+        if (!loadSimpleOBJ(filePath, asset.prototype)) return false;
+        asset.sourcePath = filePath;
+        it = meshAssets.emplace(key, asset).first;
+    }
+    it->second.refCount++;
+
+    const Mesh& prototype = it->second.prototype;
+    outMesh.VAO = prototype.VAO;
+    outMesh.instanceVBO = prototype.instanceVBO;
+    outMesh.nIndices = prototype.nIndices;
+    outMesh.baseVertex = prototype.baseVertex;
+    outMesh.firstIndex = prototype.firstIndex;
+    outMesh.vertexCount = prototype.vertexCount;
+    outMesh.textureID = prototype.textureID;
+    outMesh.material = prototype.material;
+    outMesh.boundingBoxMin = prototype.boundingBoxMin;
+    outMesh.boundingBoxMax = prototype.boundingBoxMax;
+    outMesh.assetPath = key;
+    return true;
+}
+
+// A geometria de oclusão não fica na GPU: é lida de novo (do cache ou do
+// OBJ) na primeira vez que uma malha é marcada como oclusora e depois
+// compartilhada por todas as cópias.
+bool AssetRegistry::acquireOccluder(Mesh& mesh) {
+    auto it = meshAssets.find(mesh.assetPath);
+    if (it == meshAssets.end()) return false;
+    if (!it->second.occluder) {
+        auto occluder = std::make_shared<OccluderMesh>();
+        if (!loadOccluderMesh(it->second.sourcePath, *occluder)) return false;
+        it->second.occluder = occluder;
+    }
+    mesh.occluderMesh = it->second.occluder;
+    return true;
+}
+
+void AssetRegistry::releaseMesh(Mesh& mesh) {
+    auto it = meshAssets.find(mesh.assetPath);
+    mesh.assetPath = "";
+    if (it == meshAssets.end() || --it->second.refCount > 0) return;
+
+    Mesh& prototype = it->second.prototype;
+    glDeleteVertexArrays(1, &prototype.VAO);
+    gpuMemory.release(GPU_MEMORY_BUFFER, prototype.instanceVBO);
+    glDeleteBuffers(1, &prototype.instanceVBO);
+    geometryArena.free(prototype.baseVertex, prototype.vertexCount, prototype.firstIndex, prototype.nIndices);
+    if (prototype.textureID != 0) {
+        releaseTexture(prototype.material.map_Kd_path);
+    }
+    meshAssets.erase(it);
+}
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+// Binários dos programas linkados (glGetProgramBinary, GL 4.1), gravados em
+// `shader_cache_dir` com ProgramCache.h. buildProgram pede primeiro o
+// binário ao cache e só compila o GLSL quando não há binário para a chave
+// atual (código dos shaders + driver) ou o driver o recusa.
+class ProgramBinaryCache {
+public:
+    void init(bool enable, const string& dir) {
+        getProgramBinary = (GetProgramBinaryProc)loadGLFunction("glGetProgramBinary");
+        programBinary = (ProgramBinaryProc)loadGLFunction("glProgramBinary");
+        programParameteri = (ProgramParameteriProc)loadGLFunction("glProgramParameteri");
+        GLint formats = 0;
+        if (getProgramBinary && programBinary && programParameteri) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        enabled = enable && formats > 0;
+        if (enable && !enabled) cout << "Cache de shaders indisponivel: o driver nao exporta binarios de programa" << endl;
+        cacheDir = dir;
+        driver.clear();
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const GLubyte* value = glGetString(name);
+            driver += value ? (const char*)value : "";
+            driver += '\n';
+        }
+    }
+
+    bool active() const { return enabled; }
+    size_t loaded() const { return loadedCount; }
+    size_t compiled() const { return compiledCount; }
+
+    // Programa já linkado a partir do binário de `name`, ou 0 quando é
+    // preciso compilar. `sources` são os trechos de todos os estágios.
+    GLuint load(const string& name, const std::vector<const char*>& sources) {
+        if (!enabled) return 0;
+        uint32_t format = 0;
+        std::vector<char> binary;
+        if (!readProgramCache(programCachePath(cacheDir, name), programCacheKey(sources, driver), format, binary)) return 0;
+        GLuint program = glCreateProgram();
+        programBinary(program, format, binary.data(), (GLsizei)binary.size());
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glDeleteProgram(program);
+            return 0;
+        }
+        loadedCount++;
+        return program;
+    }
+
+    // Chamado antes de glLinkProgram, para o driver manter o binário.
+    void prepare(GLuint program) {
+        if (enabled) programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // Grava o binário de `program`, que acabou de ser linkado com sucesso.
+    void store(const string& name, const std::vector<const char*>& sources, GLuint program) {
+        compiledCount++;
+        if (!enabled) return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        getProgramBinary(program, length, nullptr, &format, binary.data());
+        if (!writeProgramCache(programCachePath(cacheDir, name), programCacheKey(sources, driver), format, binary)) {
+            cerr << "Aviso: nao foi possivel gravar o cache do programa " << name << endl;
+        }
+    }
+
+private:
+    GetProgramBinaryProc getProgramBinary = nullptr;
+    ProgramBinaryProc programBinary = nullptr;
+    ProgramParameteriProc programParameteri = nullptr;
+    bool enabled = false;
+    string cacheDir;
+    string driver;
+    size_t loadedCount = 0;
+    size_t compiledCount = 0;
+};
+
+ProgramBinaryCache programCache;
+
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+
+// Um estágio do programa: os trechos vão juntos para glShaderSource, na
+// ordem dada.
+struct ShaderStage {
+    GLenum type;
+    std::vector<const char*> sources;
+};
+
+// Programa linkado com os estágios dados, do cache de binários ou compilado
+// e gravado nele. `name` identifica o programa no cache e nas mensagens de
+// erro. Devolve 0 (sem deixar objetos GL para trás) se algum estágio não
+// compilar ou o programa não linkar.
+GLuint buildProgram(const char* name, const std::vector<ShaderStage>& stages) {
+    std::vector<const char*> cacheSources;
+    for (const ShaderStage& stage : stages) cacheSources.insert(cacheSources.end(), stage.sources.begin(), stage.sources.end());
+    if (GLuint cached = programCache.load(name, cacheSources)) return cached;
+
+    GLuint program = glCreateProgram();
+    bool compiled = true;
+    for (const ShaderStage& stage : stages) {
+        GLuint shader = glCreateShader(stage.type);
+        glShaderSource(shader, (GLsizei)stage.sources.size(), stage.sources.data(), NULL);
+        glCompileShader(shader);
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char log[512];
+            glGetShaderInfoLog(shader, 512, NULL, log);
+            const char* type = stage.type == GL_VERTEX_SHADER ? "VERTEX" : stage.type == GL_FRAGMENT_SHADER ? "FRAGMENT" : "COMPUTE";
+            cerr << "Erro de compilacao do shader (" << type << ", " << name << "): " << log << endl;
+            compiled = false;
+        }
+        glAttachShader(program, shader);
+        // Só é apagado de fato quando o programa for.
+        glDeleteShader(shader);
+    }
+    if (!compiled) {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    programCache.prepare(program);
+    glLinkProgram(program);
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char log[512];
+        glGetProgramInfoLog(program, 512, NULL, log);
+        cerr << "Erro de linkagem do programa " << name << ": " << log << endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    programCache.store(name, cacheSources, program);
+    return program;
+}
+
+// `fragmentSources` são os trechos do fragment shader, na ordem em que vão
+// para glShaderSource (ver materialShaderSource). `cacheName` identifica o
+// programa no cache de binários.
+GLuint createShaderProgram(const char* cacheName, const std::vector<const char*>& fragmentSources) {
+    return buildProgram(cacheName, { { GL_VERTEX_SHADER, { vertexShaderSource } }, { GL_FRAGMENT_SHADER, fragmentSources } });
+}
+
+GLuint createSimpleShaderProgram() {
+    return buildProgram("simples", { { GL_VERTEX_SHADER, { simpleVertexShaderSource } },
+                                     { GL_FRAGMENT_SHADER, { simpleFragmentShaderSource } } });
+}
+
+// Programa do pré-passe de profundidade e as posições dos seus uniforms.
+struct DepthPrepassProgram {
+    GLuint program = 0;
+    GLint modelLoc = -1;
+    GLint viewLoc = -1;
+    GLint projLoc = -1;
+    GLint useInstancingLoc = -1;
+    GLint useDrawBuffersLoc = -1;
+    GLint useVisibleListLoc = -1;
+};
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+bool hasGLExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const GLubyte* extension = glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (extension && strcmp((const char*)extension, name) == 0) return true;
+    }
+    return false;
+}
+
+// Compila programas sem bloquear o quadro. Com GL_KHR_parallel_shader_compile
+// (ou a versão ARB) o driver compila e linka nas threads dele e o término é
+// consultado com GL_COMPLETION_STATUS_KHR. Sem a extensão, uma thread com um
+// contexto compartilhado (janela invisível) compila e linka; o programa só
+// é entregue depois do glFinish dessa thread. Se nenhum dos dois estiver
+// disponível, ou com shader_compile = sync, compila na hora, como antes.
+class ShaderCompileQueue {
+public:
+    enum Mode { SYNC, PARALLEL, WORKER };
+
+    // `mode`: "auto", "parallel", "worker" ou "sync".
+    void init(GLFWwindow* mainWindow, const string& mode) {
+        if (mode == "auto" || mode == "parallel") {
+            maxCompilerThreads = (MaxShaderCompilerThreadsProc)loadGLFunction("glMaxShaderCompilerThreadsKHR");
+            if (!maxCompilerThreads) maxCompilerThreads = (MaxShaderCompilerThreadsProc)loadGLFunction("glMaxShaderCompilerThreadsARB");
+            bool supported = hasGLExtension("GL_KHR_parallel_shader_compile") || hasGLExtension("GL_ARB_parallel_shader_compile");
+            if (supported && maxCompilerThreads) {
+                // 0xFFFFFFFF: o driver escolhe quantas threads usar.
+                maxCompilerThreads(0xFFFFFFFFu);
+                active = PARALLEL;
+                return;
+            }
+        }
+        if (mode == "auto" || mode == "parallel" || mode == "worker") {
+            // No modo headless não há janela com quem compartilhar.
+            if (mainWindow) {
+                glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+                workerWindow = glfwCreateWindow(1, 1, "", nullptr, mainWindow);
+                glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+                glfwMakeContextCurrent(mainWindow);
+            }
+            if (workerWindow) {
+                active = WORKER;
+                worker = std::thread([this] { workerLoop(); });
+                return;
+            }
+            cout << "Contexto compartilhado indisponivel; shaders compilados na thread principal" << endl;
+        }
+        active = SYNC;
+    }
+
+    void shutdown() {
+        if (worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wakeWorker.notify_all();
+            worker.join();
+        }
+        if (workerWindow) glfwDestroyWindow(workerWindow);
+        workerWindow = nullptr;
+        for (auto& job : jobs) {
+            if (job && job->program) glDeleteProgram(job->program);
+        }
+        jobs.clear();
+    }
+
+    Mode mode() const { return active; }
+
+    // Tempo que submit e poll passaram na thread principal.
+    double blockedTime() const { return blockedSeconds; }
+
+    const char* modeName() const {
+        return active == PARALLEL ? "GL_KHR_parallel_shader_compile"
+             : active == WORKER ? "contexto compartilhado" : "sincrona";
+    }
+
+    // Começa a compilar e devolve o identificador do pedido.
+    size_t submit(const string& name, const std::vector<const char*>& vertexSources,
+                  const std::vector<const char*>& fragmentSources) {
+        double start = glfwGetTime();
+        auto job = std::make_unique<Job>();
+        job->name = name;
+        job->vertex.assign(vertexSources.begin(), vertexSources.end());
+        job->fragment.assign(fragmentSources.begin(), fragmentSources.end());
+        Job* raw = job.get();
+        jobs.push_back(std::move(job));
+
+        if (active == WORKER) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(raw);
+            }
+            wakeWorker.notify_one();
+        } else {
+            // No modo PARALLEL as chamadas retornam sem esperar o driver.
+            startJob(*raw);
+            if (active == SYNC) finishJob(*raw);
+        }
+        blockedSeconds += glfwGetTime() - start;
+        return jobs.size() - 1;
+    }
+
+    // Verdadeiro quando o pedido terminou; `program` recebe o programa
+    // linkado, ou 0 se a compilação falhou. O pedido é descartado.
+    bool poll(size_t ticket, GLuint& program) {
+        Job* job = jobs[ticket].get();
+        if (!job) return false;
+        if (active == PARALLEL && !job->done) {
+            GLint complete = 0;
+            glGetProgramiv(job->program, GL_COMPLETION_STATUS_KHR, &complete);
+            if (!complete) return false;
+            double start = glfwGetTime();
+            finishJob(*job);
+            blockedSeconds += glfwGetTime() - start;
+        }
+        if (!job->done.load()) return false;
+        program = job->program;
+        jobs[ticket].reset();
+        return true;
+    }
+
+private:
+    struct Job {
+        string name;
+        std::vector<string> vertex, fragment;
+        GLuint vs = 0, fs = 0, program = 0;
+        std::atomic<bool> done{ false };
+    };
+
+    static GLuint createShader(GLenum type, const std::vector<string>& sources) {
+        std::vector<const char*> pointers;
+        for (const string& source : sources) pointers.push_back(source.c_str());
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, (GLsizei)pointers.size(), pointers.data(), NULL);
+        glCompileShader(shader);
+        return shader;
+    }
+
+    // Status e logs só são lidos em finishJob: no modo PARALLEL consultar
+    // GL_COMPILE_STATUS antes do fim bloquearia a thread principal.
+    static void startJob(Job& job) {
+        job.vs = createShader(GL_VERTEX_SHADER, job.vertex);
+        job.fs = createShader(GL_FRAGMENT_SHADER, job.fragment);
+        job.program = glCreateProgram();
+        glAttachShader(job.program, job.vs);
+        glAttachShader(job.program, job.fs);
+        programCache.prepare(job.program);
+        glLinkProgram(job.program);
+    }
+
+    static void finishJob(Job& job) {
+        GLint success = 0;
+        glGetProgramiv(job.program, GL_LINK_STATUS, &success);
+        if (!success) {
+            char log[512];
+            for (GLuint shader : { job.vs, job.fs }) {
+                glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+                if (success) continue;
+                glGetShaderInfoLog(shader, 512, NULL, log);
+                cerr << "Erro de compilacao do shader (" << job.name << "): " << log << endl;
+            }
+            glGetProgramInfoLog(job.program, 512, NULL, log);
+            cerr << "Erro de linkagem do programa " << job.name << ": " << log << endl;
+            glDeleteProgram(job.program);
+            job.program = 0;
+        }
+        glDeleteShader(job.vs);
+        glDeleteShader(job.fs);
+        job.done = true;
+    }
+
+    void workerLoop() {
+        glfwMakeContextCurrent(workerWindow);
+        while (true) {
+            Job* job = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeWorker.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (stopping) break;
+                job = queue.front();
+                queue.pop_front();
+            }
+            startJob(*job);
+            // Objetos de outro contexto só podem ser usados depois que os
+            // comandos que os criaram terminaram.
+            glFinish();
+            finishJob(*job);
+        }
+        glfwMakeContextCurrent(nullptr);
+    }
+
+    Mode active = SYNC;
+    MaxShaderCompilerThreadsProc maxCompilerThreads = nullptr;
+    GLFWwindow* workerWindow = nullptr;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wakeWorker;
+    std::deque<Job*> queue;
+    bool stopping = false;
+    std::vector<std::unique_ptr<Job>> jobs;
+    double blockedSeconds = 0.0;
+};
+
+ShaderCompileQueue shaderCompiler;
+
+// Devolve program = 0 se a compilação falhar; o pré-passe fica desativado.
+DepthPrepassProgram createDepthPrepassProgram() {
+    DepthPrepassProgram depth;
+    GLuint program = buildProgram("profundidade", { { GL_VERTEX_SHADER, { depthVertexShaderSource } },
+                                                    { GL_FRAGMENT_SHADER, { depthFragmentShaderSource } } });
+    if (!program) return depth;
+
+    depth.program = program;
+    depth.modelLoc = glGetUniformLocation(program, "model");
+    depth.viewLoc = glGetUniformLocation(program, "view");
+    depth.projLoc = glGetUniformLocation(program, "projection");
+    depth.useInstancingLoc = glGetUniformLocation(program, "useInstancing");
+    depth.useDrawBuffersLoc = glGetUniformLocation(program, "useDrawBuffers");
+    depth.useVisibleListLoc = glGetUniformLocation(program, "useVisibleList");
+    return depth;
+}
+
+// Programa do passe de iluminação deferred; devolve 0 se falhar.
+GLuint createDeferredLightingProgram() {
+    return buildProgram("iluminacao_deferred",
+                        { { GL_VERTEX_SHADER, { deferredVertexShaderSource } },
+                          { GL_FRAGMENT_SHADER, { materialShaderSource, phongLightingSource, deferredLightingShaderSource } } });
+}
+
+GLuint createHudProgram() {
+    return buildProgram("hud", { { GL_VERTEX_SHADER, { hudVertexShaderSource } }, { GL_FRAGMENT_SHADER, { hudFragmentShaderSource } } });
+}
+
+// Devolve 0 se o compute shader não compilar ou não linkar. `cacheName`
+// identifica o programa no cache de binários.
+GLuint createComputeProgram(const char* source, const char* cacheName) {
+    return buildProgram(cacheName, { { GL_COMPUTE_SHADER, { source } } });
+}
+
+TextureBuffer createTextureBuffer(GLenum format) {
+    TextureBuffer tbo;
+    glGenBuffers(1, &tbo.buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, tbo.buffer);
+    glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_DYNAMIC_DRAW);
+    gpuMemory.set(GPU_MEMORY_BUFFER, tbo.buffer, 16);
+    glGenTextures(1, &tbo.texture);
+    glBindTexture(GL_TEXTURE_BUFFER, tbo.texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, tbo.buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    return tbo;
+}
+
+// O buffer nunca fica vazio: um texture buffer sem armazenamento é
+// incompleto e o texelFetch passa a ter resultado indefinido.
+void uploadTextureBuffer(const TextureBuffer& tbo, const void* data, size_t bytes) {
+    glBindBuffer(GL_TEXTURE_BUFFER, tbo.buffer);
+    glBufferData(GL_TEXTURE_BUFFER, max(bytes, (size_t)16), nullptr, GL_STREAM_DRAW);
+    gpuMemory.set(GPU_MEMORY_BUFFER, tbo.buffer, max(bytes, (size_t)16));
+    if (bytes > 0) glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void deleteTextureBuffer(TextureBuffer& tbo) {
+    gpuMemory.release(GPU_MEMORY_BUFFER, tbo.buffer);
+    glDeleteTextures(1, &tbo.texture);
+    glDeleteBuffers(1, &tbo.buffer);
+}
+
+void setupLightBuffers() {
+    glGenBuffers(1, &lightUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlock), nullptr, GL_DYNAMIC_DRAW);
+    gpuMemory.set(GPU_MEMORY_BUFFER, lightUBO, sizeof(LightBlock));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, lightUBO);
+
+    lightDataTBO = createTextureBuffer(GL_RGBA32F);
+    clusterRangesTBO = createTextureBuffer(GL_RG32UI);
+    lightIndicesTBO = createTextureBuffer(GL_R32UI);
+}
+
+// Liga o LightBlock e os samplers de luzes de `program` aos pontos usados
+// por bindLightBuffers. Programas sem iluminação (o do G-buffer) são ignorados.
+void setupLightUniforms(GLuint program) {
+    GLuint blockIndex = glGetUniformBlockIndex(program, "LightBlock");
+    if (blockIndex == GL_INVALID_INDEX) return;
+    glUniformBlockBinding(program, blockIndex, LIGHT_BLOCK_BINDING);
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "lightData"), 1);
+    glUniform1i(glGetUniformLocation(program, "clusterRanges"), 2);
+    glUniform1i(glGetUniformLocation(program, "lightIndices"), 3);
+    glUseProgram(0);
+}
+
+void bindLightBuffers() {
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, lightDataTBO.texture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, clusterRangesTBO.texture);
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_BUFFER, lightIndicesTBO.texture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+// Reenvia as luzes só quando alguma mudou (carga da cena, teclas 1-8).
+// Luzes desligadas ficam com raio zero e não entram em nenhum cluster nem
+// na lista activeLights.
+void uploadLightsIfDirty() {
+    if (!lightsDirty) return;
+
+    LightBlock block = {};
+    activeLightCount = 0;
+    std::vector<glm::vec4> lightData;
+    lightData.reserve(lights.size() * 3);
+    clusterLights.assign(lights.size(), ClusterLight());
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const Light& light = lights[i];
+        lightData.push_back(glm::vec4(light.position, light.intensity));
+        lightData.push_back(glm::vec4(light.diffuse, 0.0f));
+        lightData.push_back(glm::vec4(light.specular, 0.0f));
+        if (!light.enabled) continue;
+
+        if (activeLightCount < MAX_FIXED_LIGHTS) block.activeLights[activeLightCount] = (GLint)i;
+        activeLightCount++;
+        block.ambientSum += glm::vec4(light.ambient * light.intensity, 0.0f);
+        clusterLights[i].position = light.position;
+        clusterLights[i].radius = lightRadius(light.intensity, light.diffuse, light.specular);
+    }
+    uploadTextureBuffer(lightDataTBO, lightData.data(), lightData.size() * sizeof(glm::vec4));
+
+    block.clusterGrid[0] = (GLint)clusterGrid.gridX;
+    block.clusterGrid[1] = (GLint)clusterGrid.gridY;
+    block.clusterGrid[2] = (GLint)clusterGrid.gridZ;
+    block.clusterGrid[3] = (GLint)lights.size();
+    block.clusterParams[0] = clusterGrid.nearPlane;
+    block.clusterParams[1] = clusterGrid.farPlane;
+    block.clusterParams[2] = (float)clusterViewportWidth;
+    block.clusterParams[3] = (float)clusterViewportHeight;
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightBlock), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    lightsDirty = false;
+}
+
+// Acompanha o tamanho real do viewport (HiDPI, FBO do modo headless): os
+// tiles dos clusters seguem o framebuffer, não WIDTH x HEIGHT. O aspecto do
+// frustum dos clusters continua o da projeção da câmera.
+void updateClusterViewport() {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLint width = max(1, viewport[2]), height = max(1, viewport[3]);
+    if (width == clusterViewportWidth && height == clusterViewportHeight) return;
+    clusterViewportWidth = width;
+    clusterViewportHeight = height;
+    lightsDirty = true;
+}
+
+// Reatribui as luzes aos clusters; roda a cada quadro porque depende da câmera.
+void updateLightClusters(const glm::mat4& view) {
+    clusterGrid.fovY = glm::radians(camera.Fov);
+    lightClusters.build(clusterLights, view, clusterGrid);
+    const auto& ranges = lightClusters.clusterRanges();
+    const auto& indices = lightClusters.lightIndices();
+    uploadTextureBuffer(clusterRangesTBO, ranges.data(), ranges.size() * sizeof(uint32_t));
+    uploadTextureBuffer(lightIndicesTBO, indices.data(), indices.size() * sizeof(uint32_t));
+}
+
+// Marca em meshVisible os objetos que tocam o frustum de
+// projection * view. Com o culling desligado todos são marcados como visíveis.
+// Com a oclusão na CPU ligada, os oclusores visíveis são rasterizados no
+// MaskedOcclusionBuffer e os objetos que sobraram são testados contra ele.
+void cullMeshes(const glm::mat4& viewProjection) {
+    cullingSet.clear();
+    for (auto& mesh : meshes) {
+        cullingSet.add(mesh.boundingBoxMin, mesh.boundingBoxMax, mesh.transform.getModelMatrix());
+    }
+    softwareOccludedCount = 0;
+    if (frustumCulling) {
+        visibleMeshCount = cullAABBs(Frustum::fromMatrix(viewProjection), cullingSet, meshVisible);
+    } else {
+        meshVisible.assign(meshes.size(), 1);
+        visibleMeshCount = meshes.size();
+        return;
+    }
+
+    if (!softwareOcclusion) return;
+    if (!occlusionThreads) {
+        occlusionThreads.reset(new ThreadPool());
+        occlusionBuffer.resize(SOFTWARE_OCCLUSION_WIDTH, SOFTWARE_OCCLUSION_HEIGHT);
+    }
+    occlusionBuffer.begin(viewProjection);
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        Mesh& mesh = meshes[i];
+        if (mesh.occluderMesh && meshVisible[i]) occlusionBuffer.addOccluder(*mesh.occluderMesh, mesh.transform.getModelMatrix());
+    }
+    if (occlusionBuffer.triangleCount() == 0) return;
+    occlusionBuffer.rasterize(occlusionThreads.get());
+    softwareOccludedCount = occlusionBuffer.cullOccluded(cullingSet, meshVisible, occlusionThreads.get());
+    visibleMeshCount -= softwareOccludedCount;
+}
+
+// Agrupa os objetos visíveis por geometria (e portanto material)
+// compartilhada. Os vetores de instâncias são reaproveitados entre quadros.
+void buildInstanceGroups(std::vector<InstanceGroup>& groups, unordered_map<GLuint, size_t>& groupByVAO) {
+    for (auto& group : groups) group.instances.clear();
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        if (!meshVisible[i]) continue;
+        Mesh& mesh = meshes[i];
+        auto it = groupByVAO.find(mesh.VAO);
+        if (it == groupByVAO.end()) {
+            it = groupByVAO.emplace(mesh.VAO, groups.size()).first;
+            groups.emplace_back();
+        }
+        InstanceGroup& group = groups[it->second];
+        group.mesh = &mesh;
+        group.instances.push_back({ mesh.transform.getModelMatrix(), mesh.transform.getNormalMatrix(), mesh.isSelected ? 1.0f : 0.0f });
+    }
+}
+
+// Distância de um ponto do mundo até a câmera ao longo da direção de visão.
+float viewDepth(const glm::mat4& view, const glm::vec3& point) {
+    return -(view[0][2] * point.x + view[1][2] * point.y + view[2][2] * point.z + view[3][2]);
+}
+
+// Ordena as instâncias de cada grupo da mais próxima para a mais distante
+// (pela origem do objeto) e os grupos pela instância mais próxima, para o
+// teste de profundidade descartar cedo o que fica atrás. groupByVAO é
+// refeito porque os grupos mudam de posição.
+void sortInstanceGroups(std::vector<InstanceGroup>& groups, unordered_map<GLuint, size_t>& groupByVAO, const glm::mat4& view) {
+    static std::vector<std::pair<float, size_t>> keys;
+    static std::vector<InstanceData> sorted;
+    for (auto& group : groups) {
+        keys.clear();
+        for (size_t i = 0; i < group.instances.size(); ++i) {
+            keys.push_back({ viewDepth(view, glm::vec3(group.instances[i].model[3])), i });
+        }
+        std::sort(keys.begin(), keys.end());
+        sorted.clear();
+        for (const auto& key : keys) sorted.push_back(group.instances[key.second]);
+        group.instances.swap(sorted);
+        group.nearestDepth = keys.empty() ? FLT_MAX : keys.front().first;
+    }
+    std::stable_sort(groups.begin(), groups.end(), [](const InstanceGroup& a, const InstanceGroup& b) {
+        return a.nearestDepth < b.nearestDepth;
+    });
+    for (size_t g = 0; g < groups.size(); ++g) groupByVAO[groups[g].mesh->VAO] = g;
+}
+
+// Ordem do caminho de um draw por objeto, pela chave de 64 bits de
+// DrawSort.h. Com stateSort a chave agrupa variante de shader, textura e
+// material (um por malha carregada, então também o VAO); com
+// frontToBackSort cada grupo vai da frente para trás. Sem nenhum dos dois
+// fica a ordem do arquivo.
+void buildDrawOrder(std::vector<size_t>& order, const glm::mat4& view) {
+    order.clear();
+    if (!stateSort && !frontToBackSort) {
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            if (meshVisible[i]) order.push_back(i);
+        }
+        return;
+    }
+
+    drawItems.clear();
+    textureSlots.clear();
+    materialSlots.clear();
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        if (!meshVisible[i]) continue;
+        const Mesh& mesh = meshes[i];
+        float depth = 0.0f;
+        if (frontToBackSort) {
+            depth = viewDepth(view, glm::vec3(cullingSet.centerX[i], cullingSet.centerY[i], cullingSet.centerZ[i]));
+        }
+        uint32_t permutation = 0, texture = 0, material = 0;
+        if (stateSort) {
+            // Mesmos eixos de ShaderPermutation que variam entre os draws.
+            permutation = (mesh.isSelected ? 2 : 0) | (mesh.material.hasTexture ? 1 : 0);
+            texture = mesh.material.hasTexture ? textureSlots.slot(mesh.textureID) : 0;
+            material = materialSlots.slot(mesh.VAO);
+        }
+        drawItems.push_back({ makeDrawKey(0, permutation, texture, material, depth), (uint32_t)i });
+    }
+    radixSortDrawItems(drawItems, drawItemScratch);
+    for (const DrawItem& item : drawItems) order.push_back(item.index);
+}
+
+void uploadInstanceGroup(const InstanceGroup& group) {
+    glBindBuffer(GL_ARRAY_BUFFER, group.mesh->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, group.instances.size() * sizeof(InstanceData), group.instances.data(), GL_STREAM_DRAW);
+    gpuMemory.set(GPU_MEMORY_BUFFER, group.mesh->instanceVBO, group.instances.size() * sizeof(InstanceData));
+}
+
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+
+// Último estado enviado ao GL pelos caminhos instanciado e de um draw por
+// objeto. Só as trocas que mudam algo chegam ao driver; as demais são
+// contadas como evitadas. invalidate() vale para quando outro código mexe
+// nesses estados (fim do passe, outros programas).
+class GLStateCache {
+public:
+    void invalidate() {
+        program = INVALID;
+        vertexArray = INVALID;
+        texture = INVALID;
+        overrideFlag = -1;
+        hasMaterial = false;
+    }
+
+    // Uniforms são estado do programa: ao trocar de programa, material e
+    // destaque precisam ser reenviados. Devolve true quando houve troca.
+    bool useProgram(GLuint id) {
+        if (id == program) { skipped++; return false; }
+        glUseProgram(id);
+        program = id;
+        overrideFlag = -1;
+        hasMaterial = false;
+        changes++;
+        return true;
+    }
+
+    void bindVertexArray(GLuint vao) {
+        if (vao == vertexArray) { skipped++; return; }
+        glBindVertexArray(vao);
+        vertexArray = vao;
+        changes++;
+    }
+
+    void bindTexture(GLuint id) {
+        if (id == texture) { skipped++; return; }
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, id);
+        texture = id;
+        changes++;
+    }
+
+    // Devolve true quando os uniforms do material precisam ser reenviados.
+    bool useMaterial(const Material& m) {
+        if (hasMaterial && m.Ka == material.Ka && m.Kd == material.Kd && m.Ks == material.Ks &&
+            m.Ns == material.Ns && m.hasTexture == material.hasTexture) {
+            skipped++;
+            return false;
+        }
+        material = m;
+        hasMaterial = true;
+        changes++;
+        return true;
+    }
+
+    // Devolve true quando o uniform de destaque precisa ser reenviado.
+    bool useOverride(bool enabled) {
+        if (overrideFlag == (int)enabled) { skipped++; return false; }
+        overrideFlag = enabled;
+        changes++;
+        return true;
+    }
+
+    size_t changes = 0;
+    size_t skipped = 0;
+
+private:
+    static const GLuint INVALID = ~0u;
+    GLuint program = INVALID;
+    GLuint vertexArray = INVALID;
+    GLuint texture = INVALID;
+    int overrideFlag = -1;
+    bool hasMaterial = false;
+    Material material;
+};
+
+GLStateCache stateCache;
+
+// Permutação do programa principal. Cada eixo fica dinâmico (-1: o shader
+// decide por fragmento, como o uber-shader) ou é fixado na compilação pelos
+// #defines TEXTURED, SELECTED e LIGHT_COUNT.
+struct ShaderPermutation {
+    int textured = -1;
+    int selected = -1;
+    int lightCount = -1;
+
+    static const uint32_t COUNT = 3 * 3 * (MAX_FIXED_LIGHTS + 2);
+
+    uint32_t index() const {
+        return (uint32_t)((textured + 1) + 3 * (selected + 1) + 9 * (lightCount + 1));
+    }
+
+    string defines() const {
+        string text;
+        if (textured >= 0) text += "#define TEXTURED " + to_string(textured) + "\n";
+        if (selected >= 0) text += "#define SELECTED " + to_string(selected) + "\n";
+        if (lightCount >= 0) text += "#define LIGHT_COUNT " + to_string(lightCount) + "\n";
+        return text;
+    }
+
+    // Sufixo do nome no cache de binários ("_t1_s0_l3"; vazio no uber-shader).
+    string suffix() const {
+        string text;
+        if (textured >= 0) text += "_t" + to_string(textured);
+        if (selected >= 0) text += "_s" + to_string(selected);
+        if (lightCount >= 0) text += "_l" + to_string(lightCount);
+        return text;
+    }
+};
+
+// Uniforms comuns a todos os draws do passe opaco.
+struct FrameUniforms {
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::vec3 viewPos = glm::vec3(0.0f);
+    glm::vec3 overrideColor = glm::vec3(0.8f, 0.8f, 1.0f);
+    bool useInstancing = false;
+    bool useDrawBuffers = false;
+    bool useVisibleList = false;
+    bool showOverdraw = false;
+};
+
+struct MainProgram {
+    GLuint program = 0;
+    GLint modelLoc = -1, normalMatrixLoc = -1, viewLoc = -1, projLoc = -1, viewPosLoc = -1;
+    GLint useOverrideLoc = -1, overrideColorLoc = -1, useInstancingLoc = -1;
+    GLint useDrawBuffersLoc = -1, useVisibleListLoc = -1, showOverdrawLoc = -1;
+    GLint matKaLoc = -1, matKdLoc = -1, matKsLoc = -1, matNsLoc = -1, matHasTextureLoc = -1;
+    GLint textureSamplerLoc = -1;
+    uint64_t frame = 0;  // último quadro em que recebeu os FrameUniforms
+    bool failed = false;
+    bool pending = false;  // pedida ao ShaderCompileQueue, ainda compilando
+    size_t ticket = 0;
+    ShaderPermutation permutation;
+};
+
+// Variantes do programa principal (forward ou G-buffer), guardadas por
+// índice. Uma variante é pedida ao ShaderCompileQueue na primeira vez em que
+// algum draw a usa; até ficar pronta, esses draws usam o uber-shader, que é
+// compilado na partida. Cada variante recebe os FrameUniforms na primeira
+// vez que é ligada no quadro. Com as permutações desligadas, todos os draws
+// usam o uber-shader.
+class ShaderPermutationCache {
+public:
+    // `fragmentSources` é o fragment shader sem permutação; o primeiro
+    // trecho, com o #version, deve ser materialShaderSource.
+    bool init(const char* name, const std::vector<const char*>& fragmentSources) {
+        baseName = name;
+        sources = fragmentSources;
+        variants.assign(ShaderPermutation::COUNT, MainProgram());
+        MainProgram& uber = variants[ShaderPermutation().index()];
+        GLuint id = createShaderProgram(name, sources);
+        if (!id) return false;
+        setup(uber, id);
+        return true;
+    }
+
+    // Recolhe as variantes que terminaram de compilar.
+    void beginFrame(const FrameUniforms& uniforms) {
+        frameUniforms = uniforms;
+        frameIndex++;
+        size_t pending = 0;
+        for (MainProgram& program : variants) {
+            if (program.pending) poll(program);
+            pending += program.pending;
+        }
+        if (hadPending && pending == 0) {
+            cout << "Permutacoes de shader prontas: " << compiledCount() << " variantes, "
+                 << (1000.0 * shaderCompiler.blockedTime()) << " ms bloqueados na thread principal ("
+                 << shaderCompiler.modeName() << ")" << endl;
+        }
+        hadPending = pending > 0;
+    }
+
+    // Liga a variante de `permutation` pelo cache de estado.
+    const MainProgram& use(ShaderPermutation permutation) {
+        MainProgram& program = variant(shaderPermutations ? permutation : ShaderPermutation());
+        stateCache.useProgram(program.program);
+        if (program.frame != frameIndex) {
+            program.frame = frameIndex;
+            glUniformMatrix4fv(program.viewLoc, 1, GL_FALSE, glm::value_ptr(frameUniforms.view));
+            glUniformMatrix4fv(program.projLoc, 1, GL_FALSE, glm::value_ptr(frameUniforms.projection));
+            glUniform3fv(program.viewPosLoc, 1, glm::value_ptr(frameUniforms.viewPos));
+            glUniform3fv(program.overrideColorLoc, 1, glm::value_ptr(frameUniforms.overrideColor));
+            glUniform1i(program.useInstancingLoc, frameUniforms.useInstancing);
+            glUniform1i(program.useDrawBuffersLoc, frameUniforms.useDrawBuffers);
+            glUniform1i(program.useVisibleListLoc, frameUniforms.useVisibleList);
+            glUniform1i(program.showOverdrawLoc, frameUniforms.showOverdraw);
+        }
+        return program;
     }
-    file.close();
-    
-    outMesh.boundingBoxMin = minBounds;
-    outMesh.boundingBoxMax = maxBounds;
-
-    if (!mtlFilePath.empty()) {
-        outMesh.material = loadMTL(mtlFilePath);
-        if (outMesh.material.hasTexture && !outMesh.material.map_Kd_path.empty()) {
-            outMesh.textureID = loadTexture(outMesh.material.map_Kd_path);
-            if (outMesh.textureID == 0) {
-                outMesh.material.hasTexture = false;
+
+    size_t compiledCount() const {
+        size_t count = 0;
+        for (const MainProgram& program : variants) count += program.program != 0 && !program.failed;
+        return count;
+    }
+
+    size_t pendingCount() const {
+        size_t count = 0;
+        for (const MainProgram& program : variants) count += program.pending;
+        return count;
+    }
+
+    void destroy() {
+        for (MainProgram& program : variants) {
+            if (program.program && !program.failed) glDeleteProgram(program.program);
+        }
+        variants.clear();
+    }
+
+private:
+    string variantName(ShaderPermutation permutation) const { return baseName + permutation.suffix(); }
+
+    // Trechos do vertex e do fragment shader da variante, na ordem do cache
+    // de binários. `defines` precisa viver enquanto os ponteiros forem usados.
+    std::vector<const char*> variantSources(ShaderPermutation permutation, string& defines) const {
+        defines = permutation.defines();
+        std::vector<const char*> fragmentSources = sources;
+        fragmentSources.insert(fragmentSources.begin() + 1, defines.c_str());
+        return fragmentSources;
+    }
+
+    // A variante pronta, ou o uber-shader enquanto ela não fica.
+    MainProgram& variant(ShaderPermutation permutation) {
+        MainProgram& program = variants[permutation.index()];
+        if (program.program) return program;
+        MainProgram& uber = variants[ShaderPermutation().index()];
+        if (program.pending) return uber;
+
+        string defines;
+        std::vector<const char*> fragmentSources = variantSources(permutation, defines);
+        std::vector<const char*> cacheSources = { vertexShaderSource };
+        cacheSources.insert(cacheSources.end(), fragmentSources.begin(), fragmentSources.end());
+        string name = variantName(permutation);
+        program.permutation = permutation;
+        if (GLuint cached = programCache.load(name, cacheSources)) {
+            setup(program, cached);
+            return program;
+        }
+
+        program.ticket = shaderCompiler.submit(name, { vertexShaderSource }, fragmentSources);
+        program.pending = true;
+        hadPending = true;
+        // No modo síncrono o pedido já terminou.
+        poll(program);
+        return program.program ? program : uber;
+    }
+
+    void poll(MainProgram& program) {
+        GLuint id = 0;
+        if (!shaderCompiler.poll(program.ticket, id)) return;
+        program.pending = false;
+        string name = variantName(program.permutation);
+        if (!id) {
+            cerr << "Permutacao " << name << " indisponivel; usando o uber-shader" << endl;
+            program = variants[ShaderPermutation().index()];
+            program.failed = true;
+            return;
+        }
+        string defines;
+        std::vector<const char*> cacheSources = { vertexShaderSource };
+        std::vector<const char*> fragmentSources = variantSources(program.permutation, defines);
+        cacheSources.insert(cacheSources.end(), fragmentSources.begin(), fragmentSources.end());
+        programCache.store(name, cacheSources, id);
+        setup(program, id);
+    }
+
+    void setup(MainProgram& program, GLuint id) {
+        program.program = id;
+        program.modelLoc = glGetUniformLocation(id, "model");
+        program.normalMatrixLoc = glGetUniformLocation(id, "normalMatrix");
+        program.viewLoc = glGetUniformLocation(id, "view");
+        program.projLoc = glGetUniformLocation(id, "projection");
+        program.viewPosLoc = glGetUniformLocation(id, "viewPos_world");
+        program.useOverrideLoc = glGetUniformLocation(id, "useOverride");
+        program.overrideColorLoc = glGetUniformLocation(id, "overrideColor");
+        program.useInstancingLoc = glGetUniformLocation(id, "useInstancing");
+        program.useDrawBuffersLoc = glGetUniformLocation(id, "useDrawBuffers");
+        program.useVisibleListLoc = glGetUniformLocation(id, "useVisibleList");
+        program.showOverdrawLoc = glGetUniformLocation(id, "showOverdraw");
+        program.matKaLoc = glGetUniformLocation(id, "material.Ka");
+        program.matKdLoc = glGetUniformLocation(id, "material.Kd");
+        program.matKsLoc = glGetUniformLocation(id, "material.Ks");
+        program.matNsLoc = glGetUniformLocation(id, "material.Ns");
+        program.matHasTextureLoc = glGetUniformLocation(id, "material.hasTexture");
+        program.textureSamplerLoc = glGetUniformLocation(id, "textureSampler");
+
+        setupLightUniforms(id);
+        glUseProgram(id);
+        glUniform1i(program.textureSamplerLoc, 0);
+        stateCache.invalidate();
+    }
+
+    string baseName;
+    std::vector<const char*> sources;
+    std::vector<MainProgram> variants;
+    FrameUniforms frameUniforms;
+    uint64_t frameIndex = 0;
+    bool hadPending = false;
+};
+
+ShaderPermutationCache mainPrograms;
+
+GPUMaterial packMaterial(const Mesh& mesh) {
+    GPUMaterial material = {};
+    material.Ka = glm::vec4(mesh.material.Ka, 0.0f);
+    material.Kd = glm::vec4(mesh.material.Kd, 0.0f);
+    material.KsNs = glm::vec4(mesh.material.Ks, mesh.material.Ns);
+    material.hasTexture = mesh.material.hasTexture && mesh.textureID != 0;
+    return material;
+}
+
+GPUInstance packInstance(const glm::mat4& model, const glm::mat3& normalMatrix, GLuint materialIndex, float selected) {
+    GPUInstance instance = {};
+    instance.model = model;
+    for (int c = 0; c < 3; ++c) instance.normalMatrix[c] = glm::vec4(normalMatrix[c], 0.0f);
+    instance.materialIndex = materialIndex;
+    instance.selected = selected;
+    return instance;
+}
+
+// Comandos consecutivos do buffer indireto que usam a mesma textura.
+struct IndirectBatch {
+    GLuint textureID;
+    size_t firstCommand;
+    size_t commandCount;
+};
+
+typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+// Caminho multi-draw indireto: todos os grupos visíveis viram comandos em um
+// único buffer indireto sobre o VAO da arena, e transformações e materiais
+// vão para SSBOs. O índice da instância chega ao shader por um atributo
+// instanciado (0, 1, 2, ...) deslocado pelo baseInstance de cada comando,
+// o que dispensa gl_DrawID (GLSL 4.60 ou ARB_shader_draw_parameters).
+// Grupos com texturas diferentes precisam de binds diferentes, então há
+// um glMultiDrawElementsIndirect por textura distinta.
+class MultiDrawRenderer {
+public:
+    // glMultiDrawElementsIndirect é do GL 4.3 e o glad do projeto carrega
+    // só até o 4.0, então a função é buscada direto no contexto.
+    bool init(const GeometryArena& arena) {
+        multiDrawElementsIndirect = (MultiDrawElementsIndirectProc)loadGLFunction("glMultiDrawElementsIndirect");
+        if (!multiDrawElementsIndirect) return false;
+
+        glGenBuffers(1, &indirectBuffer);
+        glGenBuffers(1, &instanceBuffer);
+        glGenBuffers(1, &materialBuffer);
+        glGenBuffers(1, &drawInstanceBuffer);
+
+        vao = arena.vertexArray();
+        depthVao = arena.positionArray();
+        for (GLuint target : { vao, depthVao }) {
+            glBindVertexArray(target);
+            glBindBuffer(GL_ARRAY_BUFFER, drawInstanceBuffer);
+            glVertexAttribIPointer(DRAW_INSTANCE_ATTRIB, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+            glEnableVertexAttribArray(DRAW_INSTANCE_ATTRIB);
+            glVertexAttribDivisor(DRAW_INSTANCE_ATTRIB, 1);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return true;
+    }
+
+    bool available() const { return multiDrawElementsIndirect != nullptr; }
+    size_t lastCommandCount() const { return commands.size(); }
+    size_t lastBatchCount() const { return batchCount; }
+
+    void destroy() {
+        if (!available()) return;
+        for (GLuint buffer : { indirectBuffer, instanceBuffer, materialBuffer, drawInstanceBuffer }) {
+            gpuMemory.release(GPU_MEMORY_BUFFER, buffer);
+        }
+        glDeleteBuffers(1, &indirectBuffer);
+        glDeleteBuffers(1, &instanceBuffer);
+        glDeleteBuffers(1, &materialBuffer);
+        glDeleteBuffers(1, &drawInstanceBuffer);
+    }
+
+    void draw(const std::vector<InstanceGroup>& groups, GLint textureSamplerLoc) {
+        prepare(groups);
+        drawPrepared(textureSamplerLoc);
+    }
+
+    // Monta e envia comandos, instâncias e materiais dos grupos, sem
+    // desenhar; drawDepth() e drawPrepared() reaproveitam o resultado.
+    void prepare(const std::vector<InstanceGroup>& groups) {
+        order.clear();
+        for (size_t g = 0; g < groups.size(); ++g) {
+            if (!groups[g].instances.empty()) order.push_back(g);
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return groups[a].mesh->textureID < groups[b].mesh->textureID;
+        });
+
+        commands.clear();
+        instances.clear();
+        materials.clear();
+        preparedTriangles = 0;
+        for (size_t g : order) {
+            const Mesh& mesh = *groups[g].mesh;
+            GLuint materialIndex = (GLuint)materials.size();
+            materials.push_back(packMaterial(mesh));
+            commands.push_back({ (GLuint)mesh.nIndices, (GLuint)groups[g].instances.size(), mesh.firstIndex,
+                                 mesh.baseVertex, (GLuint)instances.size() });
+            preparedTriangles += (uint64_t)(mesh.nIndices / 3) * groups[g].instances.size();
+            for (const InstanceData& data : groups[g].instances) {
+                instances.push_back(packInstance(data.model, data.normalMatrix, materialIndex, data.selected));
+            }
+        }
+        batchCount = 0;
+        batches.clear();
+        if (commands.empty()) return;
+
+        uploadBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer, instances.data(), instances.size() * sizeof(GPUInstance));
+        uploadBuffer(GL_SHADER_STORAGE_BUFFER, materialBuffer, materials.data(), materials.size() * sizeof(GPUMaterial));
+        uploadBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer, commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand));
+        reserveDrawInstances(instances.size());
+
+        size_t first = 0;
+        while (first < order.size()) {
+            GLuint textureID = groups[order[first]].mesh->textureID;
+            size_t last = first;
+            while (last < order.size() && groups[order[last]].mesh->textureID == textureID) last++;
+            batches.push_back({ textureID, first, last - first });
+            first = last;
+        }
+    }
+
+    void drawPrepared(GLint textureSamplerLoc) {
+        if (commands.empty()) return;
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BUFFER_BINDING, instanceBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_BUFFER_BINDING, materialBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        submit(batches, textureSamplerLoc);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        renderCounters.trianglesSubmitted += preparedTriangles;
+    }
+
+    void drawDepth() {
+        if (commands.empty()) return;
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BUFFER_BINDING, instanceBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        submitDepth(commands.size());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        renderCounters.trianglesSubmitted += preparedTriangles;
+    }
+
+    // Um glMultiDrawElementsIndirect por lote, lendo os comandos do buffer
+    // ligado em GL_DRAW_INDIRECT_BUFFER. Os SSBOs de instâncias e materiais
+    // ficam a cargo de quem chama.
+    void submit(const std::vector<IndirectBatch>& drawBatches, GLint textureSamplerLoc) {
+        glBindVertexArray(vao);
+        glActiveTexture(GL_TEXTURE0);
+        glUniform1i(textureSamplerLoc, 0);
+        for (const IndirectBatch& batch : drawBatches) {
+            glBindTexture(GL_TEXTURE_2D, batch.textureID);
+            multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                      (void*)(batch.firstCommand * sizeof(DrawElementsIndirectCommand)),
+                                      (GLsizei)batch.commandCount, 0);
+            renderCounters.addDraw();
+        }
+        batchCount = drawBatches.size();
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindVertexArray(0);
+    }
+
+    // Pré-passe de profundidade: sem texturas, então todos os comandos
+    // saem em um único glMultiDrawElementsIndirect sobre o VAO de posições.
+    void submitDepth(size_t commandCount) {
+        glBindVertexArray(depthVao);
+        multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)commandCount, 0);
+        renderCounters.addDraw();
+        glBindVertexArray(0);
+    }
+
+    // Sequência 0..n-1 lida pelo atributo drawInstance; só cresce.
+    void reserveDrawInstances(size_t count) {
+        if (count <= drawInstanceCapacity) return;
+        drawInstanceCapacity = max(count, drawInstanceCapacity * 2);
+        std::vector<GLuint> sequence(drawInstanceCapacity);
+        for (size_t i = 0; i < sequence.size(); ++i) sequence[i] = (GLuint)i;
+        uploadBuffer(GL_ARRAY_BUFFER, drawInstanceBuffer, sequence.data(), sequence.size() * sizeof(GLuint));
+    }
+
+private:
+    static void uploadBuffer(GLenum target, GLuint buffer, const void* data, size_t bytes) {
+        glBindBuffer(target, buffer);
+        glBufferData(target, bytes, data, GL_STREAM_DRAW);
+        glBindBuffer(target, 0);
+        gpuMemory.set(GPU_MEMORY_BUFFER, buffer, bytes);
+    }
+
+    MultiDrawElementsIndirectProc multiDrawElementsIndirect = nullptr;
+    GLuint vao = 0;
+    GLuint depthVao = 0;
+    GLuint indirectBuffer = 0;
+    GLuint instanceBuffer = 0;
+    GLuint materialBuffer = 0;
+    GLuint drawInstanceBuffer = 0;
+    size_t drawInstanceCapacity = 0;
+    size_t batchCount = 0;
+    uint64_t preparedTriangles = 0;
+    std::vector<size_t> order;
+    std::vector<IndirectBatch> batches;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<GPUInstance> instances;
+    std::vector<GPUMaterial> materials;
+};
+
+MultiDrawRenderer multiDraw;
+
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+
+typedef void (APIENTRYP DispatchComputeProc)(GLuint groupsX, GLuint groupsY, GLuint groupsZ);
+typedef void (APIENTRYP MemoryBarrierProc)(GLbitfield barriers);
+
+#ifndef GL_TEXTURE_FETCH_BARRIER_BIT
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#endif
+
+typedef void (APIENTRYP BindImageTextureProc)(GLuint unit, GLuint texture, GLint level, GLboolean layered,
+                                               GLint layer, GLenum access, GLenum format);
+
+// Pirâmide de profundidade máxima gerada a partir do depth buffer do quadro
+// anterior. build() copia a profundidade depois do passe opaco e reduz os
+// níveis com um compute shader; o culling na GPU usa a pirâmide no quadro
+// seguinte junto com a view-projection guardada aqui.
+class HiZPyramid {
+public:
+    bool init(int width, int height) {
+        dispatchCompute = (DispatchComputeProc)loadGLFunction("glDispatchCompute");
+        memoryBarrier = (MemoryBarrierProc)loadGLFunction("glMemoryBarrier");
+        bindImageTexture = (BindImageTextureProc)loadGLFunction("glBindImageTexture");
+        if (!dispatchCompute || !memoryBarrier || !bindImageTexture) return false;
+        program = createComputeProgram(hizReduceShaderSource, "piramide_hiz");
+        if (!program) return false;
+        sourceLevelLoc = glGetUniformLocation(program, "sourceLevel");
+        sourceSizeLoc = glGetUniformLocation(program, "sourceSize");
+        copyLevelLoc = glGetUniformLocation(program, "copyLevel");
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "source"), HIZ_TEXTURE_UNIT);
+        glUseProgram(0);
+
+        baseWidth = width;
+        baseHeight = height;
+        levels = 1;
+        while ((max(width, height) >> levels) > 0) levels++;
+
+        glGenTextures(1, &depthTexture);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+        glGenTextures(1, &pyramidTexture);
+        glBindTexture(GL_TEXTURE_2D, pyramidTexture);
+        for (int level = 0; level < levels; ++level) {
+            glTexImage2D(GL_TEXTURE_2D, level, GL_R32F, max(1, width >> level), max(1, height >> level), 0, GL_RED, GL_FLOAT, nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        gpuMemory.set(GPU_MEMORY_TEXTURE, depthTexture, (uint64_t)width * height * sizeof(GLfloat));
+        gpuMemory.set(GPU_MEMORY_TEXTURE, pyramidTexture, mipmappedTextureBytes(width, height, sizeof(GLfloat)));
+        return true;
+    }
+
+    bool available() const { return program != 0; }
+    bool valid() const { return built; }
+    int levelCount() const { return levels; }
+    int width() const { return baseWidth; }
+    int height() const { return baseHeight; }
+    GLuint texture() const { return pyramidTexture; }
+    const glm::mat4& viewProjection() const { return builtViewProjection; }
+
+    // A pirâmide deixa de corresponder à cena (culling desligado, etc.).
+    void invalidate() { built = false; }
+
+    void destroy() {
+        if (!available()) return;
+        glDeleteProgram(program);
+        gpuMemory.release(GPU_MEMORY_TEXTURE, depthTexture);
+        gpuMemory.release(GPU_MEMORY_TEXTURE, pyramidTexture);
+        glDeleteTextures(1, &depthTexture);
+        glDeleteTextures(1, &pyramidTexture);
+    }
+
+    // Copia o depth buffer do framebuffer da cena e reduz todos os níveis.
+    // `viewProjection` é a matriz com que o quadro foi desenhado.
+    void build(const glm::mat4& viewProjection) {
+        glActiveTexture(GL_TEXTURE0 + HIZ_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, baseWidth, baseHeight);
+
+        glUseProgram(program);
+        for (int level = 0; level < levels; ++level) {
+            int width = max(1, baseWidth >> level);
+            int height = max(1, baseHeight >> level);
+            glBindTexture(GL_TEXTURE_2D, level == 0 ? depthTexture : pyramidTexture);
+            glUniform1i(copyLevelLoc, level == 0);
+            glUniform1i(sourceLevelLoc, max(0, level - 1));
+            glUniform2i(sourceSizeLoc, max(1, baseWidth >> max(0, level - 1)), max(1, baseHeight >> max(0, level - 1)));
+            bindImageTexture(0, pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+            dispatchCompute((width + HIZ_WORKGROUP_SIZE - 1) / HIZ_WORKGROUP_SIZE,
+                            (height + HIZ_WORKGROUP_SIZE - 1) / HIZ_WORKGROUP_SIZE, 1);
+            memoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+
+        builtViewProjection = viewProjection;
+        built = true;
+    }
+
+private:
+    DispatchComputeProc dispatchCompute = nullptr;
+    MemoryBarrierProc memoryBarrier = nullptr;
+    BindImageTextureProc bindImageTexture = nullptr;
+    GLuint program = 0;
+    GLint sourceLevelLoc = -1;
+    GLint sourceSizeLoc = -1;
+    GLint copyLevelLoc = -1;
+    GLuint depthTexture = 0;
+    GLuint pyramidTexture = 0;
+    int baseWidth = 0;
+    int baseHeight = 0;
+    int levels = 0;
+    bool built = false;
+    glm::mat4 builtViewProjection = glm::mat4(1.0f);
+};
+
+HiZPyramid hiZPyramid;
+
+// Contadores do último cull() escritos pelo compute shader.
+struct CullStats {
+    GLuint frustumCulled = 0;
+    GLuint occluded = 0;
+};
+
+// Resultado de GpuCulling::validate.
+struct CullValidation {
+    size_t gpuVisible = 0;
+    size_t cpuVisible = 0;
+    size_t occluded = 0;
+    size_t mismatches = 0;
+};
+
+// Culling na GPU com compactação dos comandos indiretos. Transformações,
+// materiais e caixas locais ficam residentes em SSBOs e só os objetos
+// marcados com markDirty() são reenviados; a cada quadro o compute shader
+// testa todos os objetos contra o frustum, preenche instanceCount de cada
+// comando e a lista de visíveis, e o desenho reusa os lotes por textura do
+// MultiDrawRenderer. A CPU só percorre `meshes` em rebuild(), quando a cena
+// muda, e em validate().
+class GpuCulling {
+public:
+    // glDispatchCompute e glMemoryBarrier (GL 4.3/4.2) são buscados direto
+    // no contexto, como o glMultiDrawElementsIndirect.
+    bool init(MultiDrawRenderer& renderer) {
+        if (!renderer.available()) return false;
+        dispatchCompute = (DispatchComputeProc)loadGLFunction("glDispatchCompute");
+        memoryBarrier = (MemoryBarrierProc)loadGLFunction("glMemoryBarrier");
+        if (!dispatchCompute || !memoryBarrier) return false;
+        program = createComputeProgram(cullComputeShaderSource, "culling");
+        if (!program) return false;
+
+        drawRenderer = &renderer;
+        planesLoc = glGetUniformLocation(program, "frustumPlanes");
+        objectCountLoc = glGetUniformLocation(program, "objectCount");
+        cullingEnabledLoc = glGetUniformLocation(program, "cullingEnabled");
+        occlusionEnabledLoc = glGetUniformLocation(program, "occlusionEnabled");
+        hizViewProjectionLoc = glGetUniformLocation(program, "hizViewProjection");
+        hizMaxLevelLoc = glGetUniformLocation(program, "hizMaxLevel");
+        hizSizeLoc = glGetUniformLocation(program, "hizSize");
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "hizPyramid"), HIZ_TEXTURE_UNIT);
+        glUseProgram(0);
+        glGenBuffers(1, &statsBuffer);
+        glGenBuffers(1, &instanceBuffer);
+        glGenBuffers(1, &materialBuffer);
+        glGenBuffers(1, &cullObjectBuffer);
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &commandTemplateBuffer);
+        glGenBuffers(1, &visibleBuffer);
+        return true;
+    }
+
+    bool available() const { return program != 0; }
+    size_t objectTotal() const { return objectCount; }
+
+    void destroy() {
+        if (!available()) return;
+        glDeleteProgram(program);
+        for (GLuint buffer : { statsBuffer, instanceBuffer, materialBuffer, cullObjectBuffer, commandBuffer,
+                               commandTemplateBuffer, visibleBuffer }) {
+            gpuMemory.release(GPU_MEMORY_BUFFER, buffer);
+        }
+        glDeleteBuffers(1, &statsBuffer);
+        glDeleteBuffers(1, &instanceBuffer);
+        glDeleteBuffers(1, &materialBuffer);
+        glDeleteBuffers(1, &cullObjectBuffer);
+        glDeleteBuffers(1, &commandBuffer);
+        glDeleteBuffers(1, &commandTemplateBuffer);
+        glDeleteBuffers(1, &visibleBuffer);
+    }
+
+    // A lista de objetos mudou: tudo é reenviado no próximo cull().
+    void invalidate() { structureDirty = true; }
+
+    // Transformação ou seleção do objeto mudou.
+    void markDirty(size_t meshIndex) {
+        if (!structureDirty) dirtyObjects.push_back(meshIndex);
+    }
+
+    // Envia o que mudou e executa o culling; com `occlusion` (pirâmide já
+    // gerada) também descarta os objetos escondidos. Deixa o programa de
+    // culling em uso.
+    void cull(const glm::mat4& viewProjection, bool cullingEnabled, const HiZPyramid* occlusion) {
+        if (structureDirty) rebuild();
+        else flushDirtyObjects();
+        if (objectCount == 0) return;
+
+        // Zera os instanceCount copiando os comandos-modelo, sem ida à CPU.
+        size_t commandBytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+        glBindBuffer(GL_COPY_READ_BUFFER, commandTemplateBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, commandBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, commandBytes);
+        CullStats zero;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, statsBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, sizeof(CullStats), &zero, GL_DYNAMIC_COPY);
+        gpuMemory.set(GPU_MEMORY_BUFFER, statsBuffer, sizeof(CullStats));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        Frustum frustum = Frustum::fromMatrix(viewProjection);
+        glUseProgram(program);
+        glUniform4fv(planesLoc, 6, glm::value_ptr(frustum.planes[0]));
+        glUniform1ui(objectCountLoc, (GLuint)objectCount);
+        glUniform1i(cullingEnabledLoc, cullingEnabled);
+        glUniform1i(occlusionEnabledLoc, occlusion != nullptr);
+        if (occlusion) {
+            glUniformMatrix4fv(hizViewProjectionLoc, 1, GL_FALSE, glm::value_ptr(occlusion->viewProjection()));
+            glUniform1i(hizMaxLevelLoc, occlusion->levelCount() - 1);
+            glUniform2i(hizSizeLoc, occlusion->width(), occlusion->height());
+            glActiveTexture(GL_TEXTURE0 + HIZ_TEXTURE_UNIT);
+            glBindTexture(GL_TEXTURE_2D, occlusion->texture());
+            glActiveTexture(GL_TEXTURE0);
+        }
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_STATS_BINDING, statsBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BUFFER_BINDING, instanceBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_OBJECT_BINDING, cullObjectBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BUFFER_BINDING, commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_BUFFER_BINDING, visibleBuffer);
+        dispatchCompute((GLuint)((objectCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE), 1, 1);
+        memoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    // Desenha o resultado do último cull() com o programa de renderização
+    // em uso (useDrawBuffers e useVisibleList ligados).
+    void draw(GLint textureSamplerLoc) {
+        if (objectCount == 0) return;
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BUFFER_BINDING, instanceBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_BUFFER_BINDING, materialBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_BUFFER_BINDING, visibleBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        drawRenderer->submit(batches, textureSamplerLoc);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        renderCounters.gpuDriven = true;
+    }
+
+    void drawDepth() {
+        if (objectCount == 0) return;
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BUFFER_BINDING, instanceBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_BUFFER_BINDING, visibleBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        drawRenderer->submitDepth(commands.size());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        renderCounters.gpuDriven = true;
+    }
+
+    // Soma os instanceCount escritos pela GPU. Lê o buffer de volta e
+    // sincroniza com a GPU, então é para estatísticas esporádicas.
+    size_t readVisibleCount() {
+        if (objectCount == 0) return 0;
+        readCommands();
+        size_t total = 0;
+        for (const auto& command : gpuCommands) total += command.instanceCount;
+        return total;
+    }
+
+    CullStats readStats() {
+        CullStats stats;
+        if (objectCount == 0) return stats;
+        glBindBuffer(GL_COPY_READ_BUFFER, statsBuffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(CullStats), &stats);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        return stats;
+    }
+
+    // Compara o último cull() com a referência na CPU (CullingSet +
+    // cullAABBsScalar): cada objeto visível deve aparecer exatamente uma
+    // vez, na lista do comando da sua malha, e nenhum objeto descartado
+    // pode aparecer. Objetos dentro do frustum que a GPU omitiu contam como
+    // ocultos pelo Hi-Z e devem bater com o contador do compute shader.
+    // Diferenças de arredondamento podem mudar o resultado de caixas que
+    // tocam um plano exatamente na borda.
+    CullValidation validate(const glm::mat4& viewProjection, bool cullingEnabled) {
+        CullValidation result;
+        if (objectCount == 0) return result;
+        readCommands();
+        std::vector<GLuint> gpuVisible(objectCount);
+        glBindBuffer(GL_COPY_READ_BUFFER, visibleBuffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, objectCount * sizeof(GLuint), gpuVisible.data());
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+        std::vector<uint8_t> expected;
+        if (cullingEnabled) {
+            CullingSet set;
+            set.reserve(objectCount);
+            for (auto& mesh : meshes) set.add(mesh.boundingBoxMin, mesh.boundingBoxMax, mesh.transform.getModelMatrix());
+            result.cpuVisible = cullAABBsScalar(Frustum::fromMatrix(viewProjection), set, expected);
+        } else {
+            expected.assign(objectCount, 1);
+            result.cpuVisible = objectCount;
+        }
+
+        std::vector<uint8_t> seen(objectCount, 0);
+        for (size_t c = 0; c < gpuCommands.size(); ++c) {
+            GLuint count = gpuCommands[c].instanceCount;
+            if (count > commandCapacity[c]) {
+                result.mismatches++;
+                count = commandCapacity[c];
+            }
+            result.gpuVisible += count;
+            for (GLuint k = 0; k < count; ++k) {
+                GLuint object = gpuVisible[commands[c].baseInstance + k];
+                if (object >= objectCount || cullObjects[object].commandIndex != c || seen[object]) {
+                    result.mismatches++;
+                    continue;
+                }
+                seen[object] = 1;
+            }
+        }
+        for (size_t i = 0; i < objectCount; ++i) {
+            if (seen[i] && !expected[i]) result.mismatches++;
+            if (!seen[i] && expected[i]) result.occluded++;
+        }
+        if (result.occluded != readStats().occluded) result.mismatches++;
+        return result;
+    }
+
+private:
+    // Um comando por geometria distinta, ordenados por textura para que
+    // cada textura vire um único lote; cada comando reserva na lista de
+    // visíveis uma vaga por objeto que usa a geometria.
+    void rebuild() {
+        structureDirty = false;
+        dirtyObjects.clear();
+        objectCount = meshes.size();
+        commands.clear();
+        commandCapacity.clear();
+        materials.clear();
+        batches.clear();
+        if (objectCount == 0) return;
+
+        unordered_map<GLuint, size_t> groupByVAO;
+        std::vector<const Mesh*> groupMesh;
+        std::vector<GLuint> groupSize;
+        std::vector<size_t> groupOf(objectCount);
+        for (size_t i = 0; i < objectCount; ++i) {
+            auto it = groupByVAO.find(meshes[i].VAO);
+            if (it == groupByVAO.end()) {
+                it = groupByVAO.emplace(meshes[i].VAO, groupMesh.size()).first;
+                groupMesh.push_back(&meshes[i]);
+                groupSize.push_back(0);
+            }
+            groupOf[i] = it->second;
+            groupSize[it->second]++;
+        }
+
+        std::vector<size_t> order(groupMesh.size());
+        for (size_t g = 0; g < order.size(); ++g) order[g] = g;
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return groupMesh[a]->textureID < groupMesh[b]->textureID;
+        });
+
+        std::vector<GLuint> commandOfGroup(groupMesh.size());
+        GLuint baseInstance = 0;
+        for (size_t c = 0; c < order.size(); ++c) {
+            size_t g = order[c];
+            const Mesh& mesh = *groupMesh[g];
+            commandOfGroup[g] = (GLuint)c;
+            commands.push_back({ (GLuint)mesh.nIndices, 0, mesh.firstIndex, mesh.baseVertex, baseInstance });
+            commandCapacity.push_back(groupSize[g]);
+            baseInstance += groupSize[g];
+            materials.push_back(packMaterial(mesh));
+            if (batches.empty() || batches.back().textureID != mesh.textureID) batches.push_back({ mesh.textureID, c, 0 });
+            batches.back().commandCount++;
+        }
+
+        instances.resize(objectCount);
+        cullObjects.resize(objectCount);
+        for (size_t i = 0; i < objectCount; ++i) {
+            Mesh& mesh = meshes[i];
+            GLuint commandIndex = commandOfGroup[groupOf[i]];
+            cullObjects[i] = { glm::vec4(mesh.boundingBoxMin, 0.0f), glm::vec4(mesh.boundingBoxMax, 0.0f), commandIndex, {} };
+            instances[i] = packInstance(mesh.transform.getModelMatrix(), mesh.transform.getNormalMatrix(),
+                                        commandIndex, mesh.isSelected ? 1.0f : 0.0f);
+        }
+
+        size_t commandBytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+        uploadBuffer(instanceBuffer, instances.data(), objectCount * sizeof(GPUInstance), GL_DYNAMIC_DRAW);
+        uploadBuffer(materialBuffer, materials.data(), materials.size() * sizeof(GPUMaterial), GL_STATIC_DRAW);
+        uploadBuffer(cullObjectBuffer, cullObjects.data(), objectCount * sizeof(GPUCullObject), GL_STATIC_DRAW);
+        uploadBuffer(commandTemplateBuffer, commands.data(), commandBytes, GL_STATIC_DRAW);
+        uploadBuffer(commandBuffer, nullptr, commandBytes, GL_DYNAMIC_COPY);
+        uploadBuffer(visibleBuffer, nullptr, objectCount * sizeof(GLuint), GL_DYNAMIC_COPY);
+        drawRenderer->reserveDrawInstances(objectCount);
+    }
+
+    // Reenvia só as instâncias marcadas; se forem muitas, o buffer inteiro
+    // numa chamada só.
+    void flushDirtyObjects() {
+        if (dirtyObjects.empty()) return;
+        for (size_t i : dirtyObjects) {
+            if (i >= objectCount) continue;
+            Mesh& mesh = meshes[i];
+            instances[i] = packInstance(mesh.transform.getModelMatrix(), mesh.transform.getNormalMatrix(),
+                                        cullObjects[i].commandIndex, mesh.isSelected ? 1.0f : 0.0f);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+        if (dirtyObjects.size() * 4 >= objectCount) {
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, objectCount * sizeof(GPUInstance), instances.data());
+        } else {
+            for (size_t i : dirtyObjects) {
+                if (i >= objectCount) continue;
+                glBufferSubData(GL_SHADER_STORAGE_BUFFER, i * sizeof(GPUInstance), sizeof(GPUInstance), &instances[i]);
             }
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        dirtyObjects.clear();
+    }
+
+    void readCommands() {
+        gpuCommands.resize(commands.size());
+        glBindBuffer(GL_COPY_READ_BUFFER, commandBuffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, gpuCommands.size() * sizeof(DrawElementsIndirectCommand), gpuCommands.data());
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+
+    static void uploadBuffer(GLuint buffer, const void* data, size_t bytes, GLenum usage) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, bytes, data, usage);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        gpuMemory.set(GPU_MEMORY_BUFFER, buffer, bytes);
+    }
+
+    DispatchComputeProc dispatchCompute = nullptr;
+    MemoryBarrierProc memoryBarrier = nullptr;
+    MultiDrawRenderer* drawRenderer = nullptr;
+    GLuint program = 0;
+    GLint planesLoc = -1;
+    GLint objectCountLoc = -1;
+    GLint cullingEnabledLoc = -1;
+    GLint occlusionEnabledLoc = -1;
+    GLint hizViewProjectionLoc = -1;
+    GLint hizMaxLevelLoc = -1;
+    GLint hizSizeLoc = -1;
+    GLuint statsBuffer = 0;
+    GLuint instanceBuffer = 0;
+    GLuint materialBuffer = 0;
+    GLuint cullObjectBuffer = 0;
+    GLuint commandBuffer = 0;
+    GLuint commandTemplateBuffer = 0;
+    GLuint visibleBuffer = 0;
+    bool structureDirty = true;
+    size_t objectCount = 0;
+    std::vector<size_t> dirtyObjects;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<DrawElementsIndirectCommand> gpuCommands;
+    std::vector<GLuint> commandCapacity;
+    std::vector<IndirectBatch> batches;
+    std::vector<GPUInstance> instances;
+    std::vector<GPUMaterial> materials;
+    std::vector<GPUCullObject> cullObjects;
+};
+
+GpuCulling gpuCulling;
+
+// Anel de consultas OpenGL de um mesmo tipo (GL_TIME_ELAPSED,
+// GL_SAMPLES_PASSED). Cada resultado só é lido quando já está disponível,
+// alguns quadros depois, para a CPU não parar esperando a GPU; a espera só
+// acontece se a GPU estiver o anel inteiro atrasada. Cada consulta guarda o
+// quadro em que começou; com um nome de passe, os tempos vão também para o
+// perfil de quadros, e o modo headless os registra por quadro.
+class GpuQueryRing {
+public:
+    static const int SIZE = 4;
+
+    void init(GLenum queryTarget, const char* passName = nullptr) {
+        target = queryTarget;
+        name = passName;
+        glGenQueries(SIZE, queries);
+    }
+
+    void destroy() { glDeleteQueries(SIZE, queries); }
+
+    void begin(size_t frame = 0) {
+        if (pending[next]) readResult(next);
+        frames[next] = frame;
+        glBeginQuery(target, queries[next]);
+    }
+
+    void end() {
+        glEndQuery(target);
+        pending[next] = true;
+        next = (next + 1) % SIZE;
+        for (int i = 0; i < SIZE; ++i) {
+            if (!pending[i]) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) readResult(i);
+        }
+    }
+
+    // Média dos resultados lidos desde o último reset() (em ns para
+    // GL_TIME_ELAPSED, em amostras para GL_SAMPLES_PASSED).
+    double average() const { return resultCount ? total / resultCount : 0.0; }
+    size_t count() const { return resultCount; }
+
+    void reset() {
+        total = 0.0;
+        resultCount = 0;
+    }
+
+    // Com um destino, cada resultado lido também vai para (*sink)[quadro].
+    void recordTo(std::vector<double>* destination) { sink = destination; }
+
+    // Lê os resultados ainda pendentes, esperando a GPU.
+    void flush() {
+        for (int i = 0; i < SIZE; ++i) {
+            if (pending[i]) readResult(i);
+        }
+    }
+
+private:
+    void readResult(int index) {
+        GLuint64 value = 0;
+        glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &value);
+        total += (double)value;
+        resultCount++;
+        pending[index] = false;
+        if (sink && frames[index] < sink->size()) (*sink)[frames[index]] = (double)value;
+        if (name) profiler.addGpuTime(name, frames[index], (double)value);
+    }
+
+    GLenum target = GL_TIME_ELAPSED;
+    const char* name = nullptr;
+    GLuint queries[SIZE] = {};
+    bool pending[SIZE] = {};
+    size_t frames[SIZE] = {};
+    int next = 0;
+    double total = 0.0;
+    size_t resultCount = 0;
+    std::vector<double>* sink = nullptr;
+};
+
+GpuQueryRing prepassTimer, litPassTimer, deferredLightingTimer, shadedSamples;
+GpuQueryRing cullingTimer, hiZTimer, overlayTimer;
+
+// Caminho deferred: o passe opaco grava posição, normal, Kd, Ka e Ks/Ns no
+// G-buffer, e um único passe de tela cheia aplica o Phong com as luzes do
+// cluster de cada pixel. O custo da iluminação passa a depender só do
+// número de pixels, não de quantas camadas de geometria cobrem cada um.
+class DeferredRenderer {
+public:
+    // Anexo do G-buffer que recebe Kd (e a contagem da visualização de overdraw).
+    static const GLuint ALBEDO_ATTACHMENT = 2;
+
+    bool init(int width, int height) {
+        program = createDeferredLightingProgram();
+        if (!program) return false;
+        viewPosLoc = glGetUniformLocation(program, "viewPos_world");
+        showOverdrawLoc = glGetUniformLocation(program, "showOverdraw");
+        glUseProgram(program);
+        for (int i = 0; i < TARGET_COUNT; ++i) {
+            glUniform1i(glGetUniformLocation(program, TARGETS[i].name), GBUFFER_TEXTURE_UNIT + i);
+        }
+        glUniform1i(glGetUniformLocation(program, "gDepth"), GBUFFER_TEXTURE_UNIT + TARGET_COUNT);
+        glUseProgram(0);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glGenTextures(TARGET_COUNT, targets);
+        GLenum drawBuffers[TARGET_COUNT];
+        for (int i = 0; i < TARGET_COUNT; ++i) {
+            createTarget(targets[i], TARGETS[i].format, width, height);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, targets[i], 0);
+            drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+        }
+        glDrawBuffers(TARGET_COUNT, drawBuffers);
+        // Mesmo formato do depth buffer da janela, para a cópia no passe de
+        // iluminação não mudar nenhum valor.
+        glGenTextures(1, &depthTexture);
+        createTarget(depthTexture, GL_DEPTH_COMPONENT24, width, height);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            cerr << "G-buffer incompleto (status 0x" << hex << status << dec << ")" << endl;
+            destroy();
+            return false;
+        }
+
+        glGenVertexArrays(1, &emptyVAO);
+        return true;
+    }
+
+    bool available() const { return framebuffer != 0; }
+    GLuint lightingProgram() const { return program; }
+
+    void destroy() {
+        if (program) glDeleteProgram(program);
+        if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+        for (GLuint texture : targets) gpuMemory.release(GPU_MEMORY_TEXTURE, texture);
+        gpuMemory.release(GPU_MEMORY_TEXTURE, depthTexture);
+        if (targets[0]) glDeleteTextures(TARGET_COUNT, targets);
+        if (depthTexture) glDeleteTextures(1, &depthTexture);
+        if (emptyVAO) glDeleteVertexArrays(1, &emptyVAO);
+        *this = DeferredRenderer();
+    }
+
+    // Redireciona o passe opaco (e o pré-passe) para o G-buffer.
+    void beginGeometry() {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    // Volta ao framebuffer da cena e ilumina os pixels cobertos pelo
+    // G-buffer. Espera os buffers de luzes já ligados (bindLightBuffers).
+    void resolve(const glm::vec3& viewPos, bool overdraw) {
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+        glUseProgram(program);
+        glUniform3fv(viewPosLoc, 1, glm::value_ptr(viewPos));
+        glUniform1i(showOverdrawLoc, overdraw);
+        for (int i = 0; i < TARGET_COUNT; ++i) {
+            glActiveTexture(GL_TEXTURE0 + GBUFFER_TEXTURE_UNIT + i);
+            glBindTexture(GL_TEXTURE_2D, targets[i]);
+        }
+        glActiveTexture(GL_TEXTURE0 + GBUFFER_TEXTURE_UNIT + TARGET_COUNT);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        glActiveTexture(GL_TEXTURE0);
+
+        glDepthFunc(GL_ALWAYS);
+        glBindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        renderCounters.addDraw(1);
+        glBindVertexArray(0);
+        glDepthFunc(GL_LESS);
+    }
+
+private:
+    struct TargetFormat {
+        const char* name;
+        GLenum format;
+    };
+    static const int TARGET_COUNT = 5;
+    static constexpr TargetFormat TARGETS[TARGET_COUNT] = {
+        { "gPosition", GL_RGBA32F },
+        { "gNormal", GL_RGBA16F },
+        { "gAlbedo", GL_RGBA8 },
+        { "gAmbient", GL_RGBA8 },
+        { "gSpecular", GL_RGBA16F },
+    };
+
+    static void createTarget(GLuint texture, GLenum format, int width, int height) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        if (format == GL_DEPTH_COMPONENT24) {
+            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
         } else {
-             outMesh.material.hasTexture = false;
+            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        int texelBytes = format == GL_RGBA32F ? 16 : format == GL_RGBA16F ? 8 : 4;
+        gpuMemory.set(GPU_MEMORY_TEXTURE, texture, (uint64_t)width * height * texelBytes);
+    }
+
+    GLuint program = 0;
+    GLint viewPosLoc = -1;
+    GLint showOverdrawLoc = -1;
+    GLuint framebuffer = 0;
+    GLuint targets[TARGET_COUNT] = {};
+    GLuint depthTexture = 0;
+    GLuint emptyVAO = 0;
+};
+
+DeferredRenderer deferredRenderer;
+
+#ifdef FINAL_HEADLESS_EGL
+// Contexto OpenGL 4.5 sem janela nem superfície (EGL_MESA_platform_surfaceless),
+// usado pelo modo headless. Não precisa de servidor gráfico; sem GPU o Mesa
+// renderiza no llvmpipe.
+class HeadlessContext {
+public:
+    bool init() {
+        auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay) display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) return false;
+        if (!eglBindAPI(EGL_OPENGL_API)) return false;
+
+        const EGLint configAttribs[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        EGLConfig config;
+        EGLint configCount = 0;
+        if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0) return false;
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, 5,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+        return context != EGL_NO_CONTEXT && eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+    }
+
+    void destroy() {
+        if (display == EGL_NO_DISPLAY) return;
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+        eglTerminate(display);
+        display = EGL_NO_DISPLAY;
+        context = EGL_NO_CONTEXT;
+    }
+
+private:
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+};
+#endif
+
+// Framebuffer do modo headless, no lugar do da janela: cor RGBA8 e
+// profundidade de 24 bits, do mesmo formato que o G-buffer copia.
+class OffscreenTarget {
+public:
+    bool init(int targetWidth, int targetHeight) {
+        width = targetWidth;
+        height = targetHeight;
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glGenRenderbuffers(2, renderbuffers);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        for (GLuint renderbuffer : renderbuffers) gpuMemory.set(GPU_MEMORY_TEXTURE, renderbuffer, (uint64_t)width * height * 4);
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            cerr << "Framebuffer headless incompleto (status 0x" << hex << status << dec << ")" << endl;
+            destroy();
+            return false;
+        }
+        // Sem superfície o viewport inicial do contexto é vazio.
+        glViewport(0, 0, width, height);
+        sceneFramebuffer = framebuffer;
+        return true;
+    }
+
+    void destroy() {
+        if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+        for (GLuint renderbuffer : renderbuffers) gpuMemory.release(GPU_MEMORY_TEXTURE, renderbuffer);
+        if (renderbuffers[0]) glDeleteRenderbuffers(2, renderbuffers);
+        if (sceneFramebuffer == framebuffer) sceneFramebuffer = 0;
+        *this = OffscreenTarget();
+    }
+
+    // Lê a cor do quadro e grava em PNG, com a primeira linha no topo.
+    bool savePng(const string& path) {
+        std::vector<unsigned char> pixels((size_t)width * height * 3);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        stbi_flip_vertically_on_write(1);
+        return stbi_write_png(path.c_str(), width, height, 3, pixels.data(), width * 3) != 0;
+    }
+
+private:
+    GLuint framebuffer = 0;
+    GLuint renderbuffers[2] = {};
+    int width = 0;
+    int height = 0;
+};
+
+// Tempos de cada quadro do modo headless. Os de GPU chegam pelos anéis de
+// consultas (recordTo) alguns quadros depois; passes que não rodaram num
+// quadro ficam vazios no CSV.
+class FrameTimingLog {
+public:
+    void init(size_t frames) {
+        cpuMs.assign(frames, 0.0);
+        submitMs.assign(frames, 0.0);
+        visible.assign(frames, -1);
+        for (auto* gpu : { &prepassNs, &opaqueNs, &deferredNs }) gpu->assign(frames, -1.0);
+        prepassTimer.recordTo(&prepassNs);
+        litPassTimer.recordTo(&opaqueNs);
+        deferredLightingTimer.recordTo(&deferredNs);
+    }
+
+    void record(size_t frame, double cpuSeconds, double submitSeconds, long visibleCount) {
+        if (frame >= cpuMs.size()) return;
+        cpuMs[frame] = 1000.0 * cpuSeconds;
+        submitMs[frame] = 1000.0 * submitSeconds;
+        visible[frame] = visibleCount;
+    }
+
+    // Espera os últimos resultados da GPU e desliga o registro.
+    void finish() {
+        for (GpuQueryRing* timer : { &prepassTimer, &litPassTimer, &deferredLightingTimer }) {
+            timer->flush();
+            timer->recordTo(nullptr);
+        }
+    }
+
+    bool writeCsv(const string& path) const {
+        std::ofstream file(path);
+        if (!file.is_open()) return false;
+        file << "quadro,cpu_ms,submissao_ms,gpu_prepasse_ms,gpu_opaco_ms,gpu_iluminacao_deferred_ms,visiveis\n";
+        auto gpuField = [](double ns) { return ns < 0.0 ? string() : to_string(ns / 1e6); };
+        for (size_t i = 0; i < cpuMs.size(); ++i) {
+            file << i << ',' << cpuMs[i] << ',' << submitMs[i] << ',' << gpuField(prepassNs[i]) << ','
+                 << gpuField(opaqueNs[i]) << ',' << gpuField(deferredNs[i]) << ','
+                 << (visible[i] < 0 ? string() : to_string(visible[i])) << '\n';
+        }
+        return file.good();
+    }
+
+    double averageCpuMs() const { return average(cpuMs); }
+    double averageGpuMs() const {
+        double total = 0.0;
+        for (size_t i = 0; i < cpuMs.size(); ++i) {
+            for (const auto* gpu : { &prepassNs, &opaqueNs, &deferredNs }) total += max(0.0, (*gpu)[i]);
+        }
+        return cpuMs.empty() ? 0.0 : total / 1e6 / cpuMs.size();
+    }
+
+private:
+    static double average(const std::vector<double>& values) {
+        double total = 0.0;
+        for (double value : values) total += value;
+        return values.empty() ? 0.0 : total / values.size();
+    }
+
+    std::vector<double> cpuMs, submitMs;
+    std::vector<double> prepassNs, opaqueNs, deferredNs;
+    std::vector<long> visible;
+};
+
+// Percentis do tempo de quadro e média de cada escopo de CPU e passe de GPU
+// nas últimas amostras do perfil.
+void printProfile() {
+    const RollingSamples& frames = profiler.frameSamples();
+    cout << "Perfil: quadro medio " << frames.average() << " ms, p50 " << frames.percentile(50.0) << " ms, p95 "
+         << frames.percentile(95.0) << " ms, p99 " << frames.percentile(99.0) << " ms (" << frames.count()
+         << " quadros)" << endl;
+    for (bool gpu : { false, true }) {
+        string line;
+        for (size_t i = 0; i < profiler.nameCount(); ++i) {
+            const RollingSamples& samples = gpu ? profiler.gpuSamples(i) : profiler.cpuSamples(i);
+            if (samples.count() == 0) continue;
+            line += (line.empty() ? " " : ", ") + string(profiler.name(i)) + " " + to_string(samples.average());
         }
-    } else {
-        outMesh.material = Material(); 
-        outMesh.material.hasTexture = false;
+        if (!line.empty()) cout << (gpu ? "  GPU (ms):" : "  CPU (ms):") << line << endl;
     }
+}
 
-    glGenVertexArrays(1, &outMesh.VAO);
-    glGenBuffers(1, &outMesh.VBO);
-    glGenBuffers(1, &outMesh.EBO);
-
-    glBindVertexArray(outMesh.VAO);
+// HUD de desempenho por cima do quadro (tecla F1): FPS, gráficos do tempo
+// de CPU e de GPU por quadro, draws, triângulos enviados e descartados,
+// memória de buffers e texturas e a média de cada passe do perfil. O texto
+// usa o atlas de PerfHud.h e todos os quads vão em um buffer reenviado a
+// cada quadro, desenhados com um único glDrawArrays.
+class PerfHud {
+public:
+    static const int GRAPH_SAMPLES = 120;
 
-    glBindBuffer(GL_ARRAY_BUFFER, outMesh.VBO);
-    glBufferData(GL_ARRAY_BUFFER, vBuffer_data.size() * sizeof(GLfloat), vBuffer_data.data(), GL_STATIC_DRAW);
+    bool init() {
+        program = createHudProgram();
+        if (!program) return false;
+        screenSizeLoc = glGetUniformLocation(program, "screenSize");
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "atlas"), 0);
+        glUseProgram(0);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, outMesh.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_data.size() * sizeof(GLuint), indices_data.data(), GL_STATIC_DRAW);
+        std::vector<uint8_t> pixels = buildHudAtlas();
+        glGenTextures(1, &atlas);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, HUD_ATLAS_WIDTH, HUD_ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        gpuMemory.set(GPU_MEMORY_TEXTURE, atlas, pixels.size());
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(6 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(2);
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(HudVertex), (void*)(4 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return true;
+    }
 
-    glBindVertexArray(0);
+    bool available() const { return program != 0; }
 
-    outMesh.nIndices = indices_data.size();
-    return true;
-}
+    void destroy() {
+        if (!available()) return;
+        gpuMemory.release(GPU_MEMORY_TEXTURE, atlas);
+        gpuMemory.release(GPU_MEMORY_BUFFER, vbo);
+        glDeleteProgram(program);
+        glDeleteTextures(1, &atlas);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+    }
 
-GLuint createShaderProgram() {
-    auto compile = [](GLuint type, const char* src) -> GLuint {
-        GLuint shader = glCreateShader(type);
-        glShaderSource(shader, 1, &src, NULL);
-        glCompileShader(shader);
-        GLint success;
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            char log[512];
-            glGetShaderInfoLog(shader, 512, NULL, log);
-            cerr << "Erro de compilacao do shader (" << (type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT") << "): " << log << endl;
+    // Fecha o quadro `frame`, que começou em `startSeconds` (glfwGetTime) e
+    // ocupou a CPU por `cpuMs`. O tempo de GPU que entra no gráfico é o do
+    // quadro de GpuQueryRing::SIZE quadros atrás, cujas consultas já foram
+    // lidas; com o perfil desligado não há tempo de GPU.
+    void recordFrame(size_t frame, double startSeconds, double cpuMs) {
+        if (lastStart > 0.0) intervalMs.push((float)(1000.0 * (startSeconds - lastStart)));
+        lastStart = startSeconds;
+        cpuMsSeries.push((float)cpuMs);
+        if (frame >= (size_t)GpuQueryRing::SIZE) {
+            gpuMsSeries.push((float)profiler.gpuFrameTime(frame - GpuQueryRing::SIZE));
         }
-        return shader;
-    };
+    }
 
-    GLuint vs = compile(GL_VERTEX_SHADER, vertexShaderSource);
-    GLuint fs = compile(GL_FRAGMENT_SHADER, fragmentShaderSource);
+    // Desenha sobre o framebuffer ligado, sem teste de profundidade. Vem
+    // depois dos outros draws do quadro, então os contadores já estão
+    // completos (menos o próprio HUD).
+    void draw(int width, int height) {
+        if (!available()) return;
+        build();
+        const std::vector<HudVertex>& vertices = batch.vertices();
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(HudVertex), vertices.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        gpuMemory.set(GPU_MEMORY_BUFFER, vbo, vertices.size() * sizeof(HudVertex));
 
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-    
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if(!success) {
-        char log[512];
-        glGetProgramInfoLog(program, 512, NULL, log);
-        cerr << "Erro de linkagem do programa shader: " << log << endl;
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glUseProgram(program);
+        glUniform2f(screenSizeLoc, (float)width, (float)height);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glBindVertexArray(vao);
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+        renderCounters.addDraw(batch.quadCount() * 2);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
     }
 
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+private:
+    static constexpr float SCALE = 2.0f;
+    static constexpr float MARGIN = 8.0f;
+    static constexpr float PADDING = 6.0f;
+    static constexpr float WIDTH_CHARS = 43.0f;
+    static constexpr float GRAPH_HEIGHT = 48.0f;
+    static constexpr float BUDGET_MS = 1000.0f / 60.0f;
 
-    return program;
-}
+    // Monta todos os quads do quadro: primeiro o fundo, com a altura das
+    // linhas já contada, depois textos e gráficos por cima.
+    void build() {
+        const uint32_t white = hudColor(235, 235, 235);
+        const uint32_t dim = hudColor(150, 150, 150);
+        const uint32_t cpuColor = hudColor(110, 220, 120);
+        const uint32_t gpuColor = hudColor(240, 170, 70);
+        const uint32_t graphBackground = hudColor(40, 40, 40, 200);
+        const uint32_t budgetColor = hudColor(220, 60, 60, 220);
+        float line = HudBatch::lineHeight(SCALE);
+        float panelWidth = WIDTH_CHARS * HudBatch::advance(SCALE) + 2 * PADDING;
 
-GLuint createSimpleShaderProgram() {
-    auto compile = [](GLuint type, const char* src) -> GLuint {
-        GLuint shader = glCreateShader(type);
-        glShaderSource(shader, 1, &src, NULL);
-        glCompileShader(shader);
-        GLint success;
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            char log[512];
-            glGetShaderInfoLog(shader, 512, NULL, log);
-            cerr << "Erro de compilacao do shader simples (" << (type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT") << "): " << log << endl;
+        std::vector<size_t> passes;
+        for (size_t i = 0; i < profiler.nameCount(); ++i) {
+            if (profiler.cpuSamples(i).count() > 0 || profiler.gpuSamples(i).count() > 0) passes.push_back(i);
         }
-        return shader;
-    };
+        float panelHeight = 2 * PADDING + 6 * line + GRAPH_HEIGHT + line / 2;
+        if (profiler.enabled()) panelHeight += (1 + passes.size()) * line;
 
-    GLuint vs = compile(GL_VERTEX_SHADER, simpleVertexShaderSource);
-    GLuint fs = compile(GL_FRAGMENT_SHADER, simpleFragmentShaderSource);
+        batch.clear();
+        batch.rect(MARGIN, MARGIN, panelWidth, panelHeight, hudColor(0, 0, 0, 170));
+        float x = MARGIN + PADDING;
+        float y = MARGIN + PADDING;
+        char text[96];
 
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-    
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if(!success) {
-        char log[512];
-        glGetProgramInfoLog(program, 512, NULL, log);
-        cerr << "Erro de linkagem do programa shader simples: " << log << endl;
+        float averageInterval = intervalMs.average();
+        snprintf(text, sizeof(text), "FPS %.1f  (%.2f ms/quadro)", averageInterval > 0.0f ? 1000.0f / averageInterval : 0.0f,
+                 averageInterval);
+        batch.text(x, y, text, white, SCALE);
+        y += line;
+
+        // Os dois gráficos dividem a largura e usam a mesma escala, com a
+        // linha vermelha no orçamento de 60 FPS.
+        float gpuLatest = gpuMsSeries.latest();
+        snprintf(text, sizeof(text), "CPU %.2f ms", cpuMsSeries.latest());
+        batch.text(x, y, text, cpuColor, SCALE);
+        float graphWidth = (panelWidth - 2 * PADDING - PADDING) / 2;
+        if (gpuLatest >= 0.0f) snprintf(text, sizeof(text), "GPU %.2f ms", gpuLatest);
+        else snprintf(text, sizeof(text), profiler.enabled() ? "GPU aguardando" : "GPU sem perfil");
+        batch.text(x + graphWidth + PADDING, y, text, gpuColor, SCALE);
+        y += line;
+        float scaleMs = std::max({ 2.0f * BUDGET_MS, cpuMsSeries.max(), gpuMsSeries.max() });
+        batch.graph(x, y, graphWidth, GRAPH_HEIGHT, cpuMsSeries, scaleMs, cpuColor, graphBackground, BUDGET_MS, budgetColor);
+        batch.graph(x + graphWidth + PADDING, y, graphWidth, GRAPH_HEIGHT, gpuMsSeries, scaleMs, gpuColor, graphBackground,
+                    BUDGET_MS, budgetColor);
+        y += GRAPH_HEIGHT + line / 2;
+
+        char submitted[32], culled[32];
+        formatHudCount(submitted, sizeof(submitted), renderCounters.trianglesSubmitted);
+        formatHudCount(culled, sizeof(culled), renderCounters.trianglesCulled);
+        if (renderCounters.gpuDriven) snprintf(text, sizeof(text), "Draws %zu   triangulos: na GPU", renderCounters.drawCalls);
+        else snprintf(text, sizeof(text), "Draws %zu   triangulos %s", renderCounters.drawCalls, submitted);
+        batch.text(x, y, text, white, SCALE);
+        y += line;
+        if (renderCounters.gpuDriven) snprintf(text, sizeof(text), "Descartados: decididos na GPU");
+        else snprintf(text, sizeof(text), "Descartados %s triangulos", culled);
+        batch.text(x, y, text, white, SCALE);
+        y += line;
+
+        char buffers[32], textures[32];
+        formatHudBytes(buffers, sizeof(buffers), gpuMemory.total(GPU_MEMORY_BUFFER));
+        formatHudBytes(textures, sizeof(textures), gpuMemory.total(GPU_MEMORY_TEXTURE));
+        snprintf(text, sizeof(text), "Buffers %s", buffers);
+        batch.text(x, y, text, white, SCALE);
+        y += line;
+        snprintf(text, sizeof(text), "Texturas %s", textures);
+        batch.text(x, y, text, white, SCALE);
+        y += line;
+
+        if (!profiler.enabled()) return;
+        snprintf(text, sizeof(text), "%-27s %7s %7s", "Passe (ms)", "CPU", "GPU");
+        batch.text(x, y, text, dim, SCALE);
+        y += line;
+        for (size_t i : passes) {
+            char cpu[16] = "-", gpu[16] = "-";
+            if (profiler.cpuSamples(i).count() > 0) snprintf(cpu, sizeof(cpu), "%.2f", profiler.cpuSamples(i).average());
+            if (profiler.gpuSamples(i).count() > 0) snprintf(gpu, sizeof(gpu), "%.2f", profiler.gpuSamples(i).average());
+            snprintf(text, sizeof(text), "%-27.27s %7s %7s", profiler.name(i), cpu, gpu);
+            batch.text(x, y, text, white, SCALE);
+            y += line;
+        }
     }
 
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    GLuint program = 0;
+    GLint screenSizeLoc = -1;
+    GLuint atlas = 0;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    HudBatch batch;
+    HudSeries intervalMs{ GRAPH_SAMPLES };
+    HudSeries cpuMsSeries{ GRAPH_SAMPLES };
+    HudSeries gpuMsSeries{ GRAPH_SAMPLES };
+    double lastStart = 0.0;
+};
 
-    return program;
+PerfHud perfHud;
+
+// Move a câmera ao longo de `cameraPath` e, com `camera_target`, a vira
+// para o alvo. Com menos de dois pontos a câmera fica onde o [camera] pôs.
+void followCameraPath(float dt) {
+    if (!cameraPath.isActive) return;
+    camera.Position = cameraPath.getCurrentPosition(dt);
+    glm::vec3 toTarget = cameraTarget - camera.Position;
+    if (!cameraLookAt || glm::length(toTarget) < 1e-4f) return;
+    glm::vec3 direction = glm::normalize(toTarget);
+    camera.SetOrientation(glm::degrees(atan2(direction.z, direction.x)), glm::degrees(asin(direction.y)));
 }
 
 void setupVisualizationBuffers() {
@@ -653,11 +3686,13 @@ void renderTrajectoryVisualization(GLuint simpleShaderProgram, const glm::mat4&
     glm::vec3 previewPoint = camera.Position + camera.Front * 2.0f;
     glBindBuffer(GL_ARRAY_BUFFER, previewPointVBO);
     glBufferData(GL_ARRAY_BUFFER, 3 * sizeof(GLfloat), glm::value_ptr(previewPoint), GL_DYNAMIC_DRAW);
+    gpuMemory.set(GPU_MEMORY_BUFFER, previewPointVBO, 3 * sizeof(GLfloat));
     
     glUniform3f(colorLoc, 1.0f, 1.0f, 0.0f);
     glPointSize(8.0f);
     glBindVertexArray(previewPointVAO);
     glDrawArrays(GL_POINTS, 0, 1);
+    renderCounters.addDraw();
     
     Mesh& mesh = meshes[selectedMesh];
     if (!mesh.trajectory.points.empty()) {
@@ -670,11 +3705,13 @@ void renderTrajectoryVisualization(GLuint simpleShaderProgram, const glm::mat4&
         
         glBindBuffer(GL_ARRAY_BUFFER, pointVBO);
         glBufferData(GL_ARRAY_BUFFER, pointData.size() * sizeof(GLfloat), pointData.data(), GL_DYNAMIC_DRAW);
+        gpuMemory.set(GPU_MEMORY_BUFFER, pointVBO, pointData.size() * sizeof(GLfloat));
         
         glUniform3f(colorLoc, 0.0f, 1.0f, 0.0f);
         glPointSize(10.0f);
         glBindVertexArray(pointVAO);
         glDrawArrays(GL_POINTS, 0, mesh.trajectory.points.size());
+        renderCounters.addDraw();
     }
     
     if (mesh.trajectory.points.size() > 1) {
@@ -692,62 +3729,121 @@ void renderTrajectoryVisualization(GLuint simpleShaderProgram, const glm::mat4&
         
         glBindBuffer(GL_ARRAY_BUFFER, lineVBO);
         glBufferData(GL_ARRAY_BUFFER, lineData.size() * sizeof(GLfloat), lineData.data(), GL_DYNAMIC_DRAW);
+        gpuMemory.set(GPU_MEMORY_BUFFER, lineVBO, lineData.size() * sizeof(GLfloat));
         
         glUniform3f(colorLoc, 1.0f, 0.0f, 0.0f);
         glLineWidth(2.0f);
         glBindVertexArray(lineVAO);
         glDrawArrays(GL_LINES, 0, lineData.size() / 3);
+        renderCounters.addDraw();
     }
     
     glBindVertexArray(0);
 }
 
-string trim(const string& str) {
-    size_t first = str.find_first_not_of(' ');
-    if (string::npos == first) {
-        return str;
-    }
-    size_t last = str.find_last_not_of(' ');
-    return str.substr(first, (last - first + 1));
-}
-
-vector<string> split(const string& str, char delimiter) {
-    vector<string> tokens;
-    stringstream ss(str);
-    string token;
-    while (getline(ss, token, delimiter)) {
-        tokens.push_back(trim(token));
-    }
-    return tokens;
-}
-
+// Aplica o arquivo lido por parseSceneConfig: primeiro as opções, depois as
+// luzes e por fim os objetos, então as opções de [loader] valem para todas
+// as malhas, em qualquer posição do arquivo.
 bool loadSceneConfig(const string& configPath) {
-    std::ifstream file(configPath);
-    if (!file.is_open()) {
-        cerr << "Erro ao abrir arquivo de configuracao: " << configPath << endl;
-        return false;
-    }
+    SceneConfig config;
+    auto parseStart = std::chrono::steady_clock::now();
+    if (!parseSceneConfig(configPath, config)) return false;
+    startupProfiler.add(STARTUP_PHASE_CONFIG, configPath, millisecondsSince(parseStart));
 
-    string line;
-    string currentSection = "";
-    
-    while (getline(file, line)) {
-        line = trim(line);
-        
-        if (line.empty() || line[0] == '#') continue;
-        
-        if (line[0] == '[' && line.back() == ']') {
-            currentSection = line.substr(1, line.length() - 2);
-            continue;
-        }
-        
-        size_t equalPos = line.find('=');
-        if (equalPos == string::npos) continue;
-        
-        string key = trim(line.substr(0, equalPos));
-        string value = trim(line.substr(equalPos + 1));
-        
-        if (currentSection == "camera") {
+    for (const SceneSetting& setting : config.settings) {
+        const string& currentSection = setting.section;
+        const string& key = setting.key;
+        const string& value = setting.value;
+
+        if (currentSection == "render") {
+            if (key == "instancing") {
+                instancedRendering = (value == "true" || value == "1");
+            } else if (key == "multidraw") {
+                multiDrawIndirect = (value == "true" || value == "1");
+            } else if (key == "gpuculling") {
+                gpuCullingEnabled = (value == "true" || value == "1");
+            } else if (key == "occlusion") {
+                occlusionCulling = (value == "true" || value == "1");
+            } else if (key == "softocclusion") {
+                softwareOcclusion = (value == "true" || value == "1");
+            } else if (key == "depthprepass") {
+                depthPrepass = (value == "true" || value == "1");
+            } else if (key == "statesort") {
+                stateSort = (value == "true" || value == "1");
+            } else if (key == "permutations") {
+                shaderPermutations = (value == "true" || value == "1");
+            } else if (key == "frontsort") {
+                frontToBackSort = (value == "true" || value == "1");
+            } else if (key == "overdraw") {
+                showOverdraw = (value == "true" || value == "1");
+            } else if (key == "renderer") {
+                deferredShading = (value == "deferred");
+            } else if (key == "vsync") {
+                vsyncEnabled = (value == "true" || value == "1");
+            } else if (key == "hud") {
+                hudEnabled = (value == "true" || value == "1");
+            }
+        } else if (currentSection == "loader") {
+            if (key == "threads") {
+                objLoaderThreads = (unsigned)max(0, stoi(value));
+            } else if (key == "cache") {
+                meshCacheEnabled = (value == "true" || value == "1");
+            } else if (key == "cache_dir") {
+                meshCacheDir = value;
+            } else if (key == "shader_cache") {
+                shaderCacheEnabled = (value == "true" || value == "1");
+            } else if (key == "shader_cache_dir") {
+                shaderCacheDir = value;
+            } else if (key == "shader_compile") {
+                shaderCompileMode = value;
+            }
+        } else if (currentSection == "profiler") {
+            if (key == "enabled") {
+                profilerEnabled = (value == "true" || value == "1");
+            } else if (key == "history") {
+                profilerHistory = max(0, stoi(value));
+            } else if (key == "trace_file") {
+                traceFile = value;
+            }
+        } else if (currentSection == "startup") {
+            if (key == "enabled") {
+                startupProfiler.setEnabled(value == "true" || value == "1");
+            } else if (key == "budget_ms") {
+                startupProfiler.setBudget(stod(value));
+            } else if (key == "json_file") {
+                startupJsonFile = value;
+            } else if (key == "sync") {
+                startupSync = (value == "true" || value == "1");
+            }
+        } else if (currentSection == "headless") {
+            if (key == "frames") {
+                headlessFrames = max(1, stoi(value));
+            } else if (key == "timestep") {
+                headlessTimestep = stof(value);
+            } else if (key == "camera_path") {
+                cameraPath.clear();
+                for (const string& pointStr : split(value, ';')) {
+                    vector<string> coords = split(pointStr, ',');
+                    if (coords.size() >= 3) {
+                        cameraPath.addPoint(glm::vec3(stof(coords[0]), stof(coords[1]), stof(coords[2])));
+                    }
+                }
+            } else if (key == "camera_speed") {
+                cameraPath.speed = stof(value);
+            } else if (key == "camera_target") {
+                vector<string> coords = split(value, ',');
+                if (coords.size() >= 3) {
+                    cameraTarget = glm::vec3(stof(coords[0]), stof(coords[1]), stof(coords[2]));
+                    cameraLookAt = true;
+                }
+            } else if (key == "csv") {
+                timingCsvPath = value;
+            } else if (key == "png_dir") {
+                pngDir = value;
+            } else if (key == "png_every") {
+                pngEvery = max(0, stoi(value));
+            }
+        } else if (currentSection == "camera") {
             if (key == "position") {
                 vector<string> coords = split(value, ',');
                 if (coords.size() >= 3) {
@@ -756,107 +3852,49 @@ bool loadSceneConfig(const string& configPath) {
                     camera.Position.z = stof(coords[2]);
                 }
             } else if (key == "yaw") {
-                camera.Yaw = stof(value);
+                camera.SetOrientation(stof(value), camera.Pitch);
             } else if (key == "pitch") {
-                camera.Pitch = stof(value);
+                camera.SetOrientation(camera.Yaw, stof(value));
             } else if (key == "fov") {
                 camera.Fov = stof(value);
             }
-        } else if (currentSection == "lights") {
-            static Light currentLight;
-            static bool lightInProgress = false;
-            
-            if (key == "position") {
-                vector<string> coords = split(value, ',');
-                if (coords.size() >= 3) {
-                    currentLight.position.x = stof(coords[0]);
-                    currentLight.position.y = stof(coords[1]);
-                    currentLight.position.z = stof(coords[2]);
-                    lightInProgress = true;
-                }
-            } else if (key == "ambient") {
-                vector<string> coords = split(value, ',');
-                if (coords.size() >= 3) {
-                    currentLight.ambient.r = stof(coords[0]);
-                    currentLight.ambient.g = stof(coords[1]);
-                    currentLight.ambient.b = stof(coords[2]);
-                }
-            } else if (key == "diffuse") {
-                vector<string> coords = split(value, ',');
-                if (coords.size() >= 3) {
-                    currentLight.diffuse.r = stof(coords[0]);
-                    currentLight.diffuse.g = stof(coords[1]);
-                    currentLight.diffuse.b = stof(coords[2]);
-                }
-            } else if (key == "specular") {
-                vector<string> coords = split(value, ',');
-                if (coords.size() >= 3) {
-                    currentLight.specular.r = stof(coords[0]);
-                    currentLight.specular.g = stof(coords[1]);
-                    currentLight.specular.b = stof(coords[2]);
-                }
-            } else if (key == "intensity") {
-                currentLight.intensity = stof(value);
-            } else if (key == "enabled") {
-                currentLight.enabled = (value == "true" || value == "1");
-            } else if (key == "end") {
-                if (lightInProgress) {
-                    lights.push_back(currentLight);
-                    currentLight = Light();
-                    lightInProgress = false;
-                }
-            }
-        } else if (currentSection == "objects") {
-            static Mesh currentMesh;
-            static bool meshInProgress = false;
-            
-            if (key == "name") {
-                currentMesh.name = value;
-                meshInProgress = true;
-            } else if (key == "file") {
-                if (!loadSimpleOBJ(value, currentMesh)) {
-                    cerr << "Falha ao carregar objeto: " << value << endl;
-                    meshInProgress = false;
-                }
-            } else if (key == "translation") {
-                vector<string> coords = split(value, ',');
-                if (coords.size() >= 3) {
-                    currentMesh.translation.x = stof(coords[0]);
-                    currentMesh.translation.y = stof(coords[1]);
-                    currentMesh.translation.z = stof(coords[2]);
-                }
-            } else if (key == "rotation") {
-                vector<string> coords = split(value, ',');
-                if (coords.size() >= 3) {
-                    currentMesh.rotation.x = glm::radians(stof(coords[0]));
-                    currentMesh.rotation.y = glm::radians(stof(coords[1]));
-                    currentMesh.rotation.z = glm::radians(stof(coords[2]));
-                }
-            } else if (key == "scale") {
-                currentMesh.scale = stof(value);
-            } else if (key == "trajectory_points") {
-                vector<string> points = split(value, ';');
-                for (const string& pointStr : points) {
-                    vector<string> coords = split(pointStr, ',');
-                    if (coords.size() >= 3) {
-                        glm::vec3 point(stof(coords[0]), stof(coords[1]), stof(coords[2]));
-                        currentMesh.trajectory.addPoint(point);
-                    }
-                }
-            } else if (key == "trajectory_speed") {
-                currentMesh.trajectory.speed = stof(value);
-            } else if (key == "end") {
-                if (meshInProgress) {
-                    meshes.push_back(currentMesh);
-                    cout << "Carregado objeto: " << currentMesh.name << endl;
-                    currentMesh = Mesh();
-                    meshInProgress = false;
-                }
-            }
         }
     }
 
-    file.close();
+    lights.insert(lights.end(), config.lights.begin(), config.lights.end());
+
+    for (const SceneObjectConfig& object : config.objects) {
+        Mesh currentMesh;
+        currentMesh.name = object.name;
+        if (!object.file.empty() && !assets.acquireMesh(object.file, currentMesh)) {
+            cerr << "Falha ao carregar objeto: " << object.file << endl;
+            continue;
+        }
+        currentMesh.transform = object.transform;
+        currentMesh.trajectory = object.trajectory;
+        currentMesh.instanceCount = object.instanceCount;
+        currentMesh.instanceSpacing = object.instanceSpacing;
+        currentMesh.occluder = object.occluder;
+        if (currentMesh.occluder && !assets.acquireOccluder(currentMesh)) {
+            cerr << "Aviso: objeto " << currentMesh.name << " nao sera usado como oclusor" << endl;
+        }
+        meshes.push_back(currentMesh);
+        int columns = (int)ceil(sqrt((float)currentMesh.instanceCount));
+        for (int i = 1; i < currentMesh.instanceCount; ++i) {
+            Mesh copy = currentMesh;
+            copy.name = currentMesh.name + " #" + to_string(i);
+            copy.transform.translate(glm::vec3((i % columns) * currentMesh.instanceSpacing, 0.0f, (i / columns) * currentMesh.instanceSpacing));
+            copy.trajectory = Trajectory();
+            assets.retainMesh(copy);
+            meshes.push_back(copy);
+        }
+        cout << "Carregado objeto: " << currentMesh.name;
+        if (currentMesh.instanceCount > 1) cout << " (" << currentMesh.instanceCount << " copias)";
+        cout << endl;
+    }
+
+    cout << "Objetos na cena: " << meshes.size() << " (malhas unicas: " << assets.meshCount()
+         << ", texturas unicas: " << assets.textureCount() << ")" << endl;
     return true;
 }
 
@@ -895,15 +3933,20 @@ void createDefaultScene() {
         "assets/Modelos3D/SuzanneSubdiv1.obj",
         "assets/Modelos3D/cube.obj",
     };
-    
+
+    // Objetos que já estavam na cena devolvem malhas e texturas ao registro;
+    // só limpar o vetor deixaria as referências presas.
+    for (auto& mesh : meshes) {
+        assets.releaseMesh(mesh);
+    }
     meshes.clear();
     for (size_t i = 0; i < defaultPaths.size(); ++i) {
         Mesh mesh;
-        if (loadSimpleOBJ(defaultPaths[i], mesh)) {
+        if (assets.acquireMesh(defaultPaths[i], mesh)) {
             mesh.name = "Object" + to_string(i);
-            mesh.translation = glm::vec3(i * 2.0f - 3.0f, 0.0f, 0.0f);
-            mesh.rotation = glm::vec3(0.0f, 0.0f, 0.0f);
-            mesh.scale = 1.0f;
+            mesh.transform.setTranslation(glm::vec3(i * 2.0f - 3.0f, 0.0f, 0.0f));
+            mesh.transform.setRotation(glm::vec3(0.0f, 0.0f, 0.0f));
+            mesh.transform.setScale(1.0f);
             meshes.push_back(mesh);
             cout << "Carregado objeto padrao: " << defaultPaths[i] << endl;
         }
@@ -914,192 +3957,641 @@ void createDefaultScene() {
     }
 }
 
-int main() {
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    #ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-    #endif
+int main(int argc, char** argv) {
+    // --deferred/--forward escolhem o caminho de renderização e têm
+    // prioridade sobre a chave renderer do arquivo de configuração.
+    // --headless renderiza sem janela; --frames=, --csv= e --png= têm
+    // prioridade sobre a seção [headless].
+    string configPath = "scene_config.txt";
+    string rendererOverride = "";
+    bool headlessMode = false;
+    int framesOverride = 0;
+    string csvOverride = "", pngOverride = "";
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--deferred" || arg == "--forward") {
+            rendererOverride = arg.substr(2);
+        } else if (arg == "--headless") {
+            headlessMode = true;
+        } else if (arg.rfind("--frames=", 0) == 0) {
+            framesOverride = max(1, atoi(arg.c_str() + 9));
+        } else if (arg.rfind("--csv=", 0) == 0) {
+            csvOverride = arg.substr(6);
+        } else if (arg.rfind("--png=", 0) == 0) {
+            pngOverride = arg.substr(6);
+        } else {
+            configPath = arg;
+        }
+    }
 
-    GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Leitor/Visualizador de Cenas 3D - Final", nullptr, nullptr);
-    if (!window) {
-        cerr << "Falha ao criar janela GLFW" << endl;
-        glfwTerminate();
+    GLFWwindow* window = nullptr;
+#ifdef FINAL_HEADLESS_EGL
+    HeadlessContext headlessContext;
+#endif
+    if (headlessMode) {
+#ifdef FINAL_HEADLESS_EGL
+        // Do GLFW só se usa o relógio; a plataforma nula não abre janela.
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        glfwInit();
+        if (!headlessContext.init()) {
+            cerr << "Falha ao criar contexto EGL sem superficie" << endl;
+            headlessContext.destroy();
+            glfwTerminate();
+            return -1;
+        }
+        loadGLFunction = (GLADloadproc)eglGetProcAddress;
+#else
+        cerr << "Modo headless indisponivel: compilado sem EGL" << endl;
         return -1;
-    }
-    glfwMakeContextCurrent(window);
-    
-    glfwSetKeyCallback(window, key_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
+#endif
+    } else {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        #ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        #endif
+
+        window = glfwCreateWindow(WIDTH, HEIGHT, "Leitor/Visualizador de Cenas 3D - Final", nullptr, nullptr);
+        if (!window) {
+            cerr << "Falha ao criar janela GLFW" << endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
 
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwSetKeyCallback(window, key_callback);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetScrollCallback(window, scroll_callback);
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    }
+
+    if (!gladLoadGLLoader(loadGLFunction)) {
         cerr << "Falha ao inicializar GLAD" << endl;
         return -1;
     }
 
+    OffscreenTarget offscreen;
+    if (headlessMode && !offscreen.init(WIDTH, HEIGHT)) return -1;
+    startupProfiler.add(STARTUP_PHASE_INIT, "", startupProfiler.elapsedMs());
+
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_PROGRAM_POINT_SIZE);
 
-    GLuint shaderProgram = createShaderProgram();
-    GLuint simpleShaderProgram = createSimpleShaderProgram();
-    
-    setupVisualizationBuffers();
-    
-    GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
-    GLint viewLoc = glGetUniformLocation(shaderProgram, "view");
-    GLint projLoc = glGetUniformLocation(shaderProgram, "projection");
-    GLint normalMatrixLoc = glGetUniformLocation(shaderProgram, "normalMatrix");
-    GLint viewPosLoc = glGetUniformLocation(shaderProgram, "viewPos_world");
-    GLint numLightsLoc = glGetUniformLocation(shaderProgram, "numLights");
-    GLint useOverrideLoc = glGetUniformLocation(shaderProgram, "useOverride");
-    GLint overrideColorLoc = glGetUniformLocation(shaderProgram, "overrideColor");
-    
-    GLint matKaLoc = glGetUniformLocation(shaderProgram, "material.Ka");
-    GLint matKdLoc = glGetUniformLocation(shaderProgram, "material.Kd");
-    GLint matKsLoc = glGetUniformLocation(shaderProgram, "material.Ks");
-    GLint matNsLoc = glGetUniformLocation(shaderProgram, "material.Ns");
-    GLint matHasTextureLoc = glGetUniformLocation(shaderProgram, "material.hasTexture");
-    GLint textureSamplerLoc = glGetUniformLocation(shaderProgram, "textureSampler");
-
-    std::vector<GLint> lightPosLocs, lightAmbientLocs, lightDiffuseLocs, lightSpecularLocs, lightEnabledLocs, lightIntensityLocs;
-    for (int i = 0; i < 8; ++i) {
-        string baseName = "lights[" + to_string(i) + "]";
-        lightPosLocs.push_back(glGetUniformLocation(shaderProgram, (baseName + ".position_world").c_str()));
-        lightAmbientLocs.push_back(glGetUniformLocation(shaderProgram, (baseName + ".ambient_color").c_str()));
-        lightDiffuseLocs.push_back(glGetUniformLocation(shaderProgram, (baseName + ".diffuse_color").c_str()));
-        lightSpecularLocs.push_back(glGetUniformLocation(shaderProgram, (baseName + ".specular_color").c_str()));
-        lightEnabledLocs.push_back(glGetUniformLocation(shaderProgram, (baseName + ".enabled").c_str()));
-        lightIntensityLocs.push_back(glGetUniformLocation(shaderProgram, (baseName + ".intensity").c_str()));
-    }
-
-    if (!loadSceneConfig("scene_config.txt")) {
+    clusterGrid.nearPlane = NEAR_PLANE;
+    clusterGrid.farPlane = FAR_PLANE;
+    clusterGrid.aspect = (float)WIDTH / (float)HEIGHT;
+
+    geometryArena.init(1 << 16, 1 << 18);
+
+    // A configuração é lida antes de criar os programas: ela decide o
+    // caminho de renderização e o uso do cache de binários de shader.
+    if (!loadSceneConfig(configPath)) {
         cout << "Arquivo de configuracao nao encontrado, criando cena padrao..." << endl;
         createDefaultScene();
     }
+    loaderThreads.reset();
+    if (!rendererOverride.empty()) deferredShading = (rendererOverride == "deferred");
+    if (framesOverride > 0) headlessFrames = framesOverride;
+    if (!csvOverride.empty()) timingCsvPath = csvOverride;
+    if (!pngOverride.empty()) pngDir = pngOverride;
+    programCache.init(shaderCacheEnabled, shaderCacheDir);
+    shaderCompiler.init(window, shaderCompileMode);
+    cout << "Compilacao das permutacoes de shader: " << shaderCompiler.modeName() << endl;
+    double programStart = glfwGetTime();
+
+    if (!multiDraw.init(geometryArena)) {
+        cout << "glMultiDrawElementsIndirect indisponivel; usando renderizacao instanciada" << endl;
+    }
+    if (!gpuCulling.init(multiDraw)) {
+        cout << "Culling na GPU indisponivel (requer compute shader e multi-draw indireto)" << endl;
+    }
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (gpuCulling.available() && !hiZPyramid.init(viewport[2], viewport[3])) {
+        cout << "Piramide Hi-Z indisponivel; culling por oclusao desativado" << endl;
+    }
+    DepthPrepassProgram depthProgram = createDepthPrepassProgram();
+    if (depthProgram.program == 0) {
+        cout << "Pre-passe de profundidade indisponivel" << endl;
+    }
+    prepassTimer.init(GL_TIME_ELAPSED, "pre-passe");
+    litPassTimer.init(GL_TIME_ELAPSED, "passe opaco");
+    deferredLightingTimer.init(GL_TIME_ELAPSED, "iluminacao deferred");
+    cullingTimer.init(GL_TIME_ELAPSED, "culling");
+    hiZTimer.init(GL_TIME_ELAPSED, "piramide Hi-Z");
+    overlayTimer.init(GL_TIME_ELAPSED, "visualizacao de trajetorias");
+    shadedSamples.init(GL_SAMPLES_PASSED);
+    profiler.setEnabled(profilerEnabled);
+    profiler.setHistory(profilerHistory);
+
+    // O caminho é escolhido na partida: no deferred o programa principal
+    // troca o fragment shader de Phong pelo que grava o G-buffer, e o resto
+    // da submissão (uniforms, buffers, draws) não muda.
+    if (deferredShading && !deferredRenderer.init(viewport[2], viewport[3])) {
+        cout << "G-buffer indisponivel; usando renderizacao forward" << endl;
+        deferredShading = false;
+    }
+    // As demais permutações são compiladas quando algum draw as pede.
+    setupLightBuffers();
+    if (deferredShading) {
+        mainPrograms.init("gbuffer", { materialShaderSource, surfaceShaderSource, gbufferFragmentShaderSource });
+        setupLightUniforms(deferredRenderer.lightingProgram());
+    } else {
+        mainPrograms.init("principal", { materialShaderSource, surfaceShaderSource, phongLightingSource, fragmentShaderSource });
+    }
+    glUseProgram(0);
+    GLuint simpleShaderProgram = createSimpleShaderProgram();
+    if (!perfHud.init()) {
+        cout << "HUD de desempenho indisponivel" << endl;
+        hudEnabled = false;
+    }
+    double programSeconds = glfwGetTime() - programStart;
+    startupProfiler.add(STARTUP_PHASE_SHADERS, "", 1000.0 * programSeconds);
     
-    cout << "=== CONTROLES ===" << endl;
-    cout << "W/A/S/D: Mover a camera" << endl;
-    cout << "ESPACO: Mover camera para cima" << endl;
-    cout << "SHIFT: Mover camera para baixo" << endl;
-    cout << "MOUSE: Olhar ao redor" << endl;
-    cout << "SCROLL: Zoom (FOV)" << endl;
-    cout << "TAB: Alternar entre objetos" << endl;
-    cout << "=== MANIPULACAO DE OBJETOS ===" << endl;
-    cout << "Setas: Mover objeto selecionado (frente/tras/esquerda/direita)" << endl;
-    cout << "PAGE UP/DOWN: Mover objeto para cima/baixo" << endl;
-    cout << "X/Y/Z: Rotacionar objeto selecionado" << endl;
-    cout << "Q/E: Escalar objeto selecionado" << endl;
-    cout << "=== TRAJETORIAS ===" << endl;
-    cout << "P: Adicionar ponto de trajetoria ao objeto selecionado" << endl;
-    cout << "C: Limpar trajetoria do objeto selecionado" << endl;
-    cout << "G: Ativar/desativar movimento por trajetoria" << endl;
-    cout << "+/-: Aumentar/Diminuir velocidade da trajetoria" << endl;
-    cout << "=== OUTROS ===" << endl;
-    cout << "1-8: Habilitar/Desabilitar luzes" << endl;
-    cout << "ESC: Sair" << endl;
-    cout << "=================" << endl;
-
-    while (!glfwWindowShouldClose(window)) {
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-        processInput(window);
-        glfwPollEvents();
-
-        for (auto& mesh : meshes) {
+    setupVisualizationBuffers();
+
+    if (headlessMode) {
+        cout << "Modo headless: " << headlessFrames << " quadros de " << WIDTH << "x" << HEIGHT
+             << ", passo de " << (1000.0f * headlessTimestep) << " ms, tempos em " << timingCsvPath << endl;
+    } else {
+        cout << "=== CONTROLES ===" << endl;
+        cout << "W/A/S/D: Mover a camera" << endl;
+        cout << "ESPACO: Mover camera para cima" << endl;
+        cout << "SHIFT: Mover camera para baixo" << endl;
+        cout << "MOUSE: Olhar ao redor" << endl;
+        cout << "SCROLL: Zoom (FOV)" << endl;
+        cout << "TAB: Alternar entre objetos" << endl;
+        cout << "=== MANIPULACAO DE OBJETOS ===" << endl;
+        cout << "Setas: Mover objeto selecionado (frente/tras/esquerda/direita)" << endl;
+        cout << "PAGE UP/DOWN: Mover objeto para cima/baixo" << endl;
+        cout << "X/Y/Z: Rotacionar objeto selecionado" << endl;
+        cout << "Q/E: Escalar objeto selecionado" << endl;
+        cout << "=== TRAJETORIAS ===" << endl;
+        cout << "P: Adicionar ponto de trajetoria ao objeto selecionado" << endl;
+        cout << "C: Limpar trajetoria do objeto selecionado" << endl;
+        cout << "G: Ativar/desativar movimento por trajetoria" << endl;
+        cout << "+/-: Aumentar/Diminuir velocidade da trajetoria" << endl;
+        cout << "=== OUTROS ===" << endl;
+        cout << "1-8: Habilitar/Desabilitar luzes" << endl;
+        cout << "I: Alternar renderizacao instanciada" << endl;
+        cout << "M: Alternar multi-draw indireto" << endl;
+        cout << "F: Alternar frustum culling" << endl;
+        cout << "U: Alternar culling na GPU" << endl;
+        cout << "V: Validar culling na GPU contra a CPU" << endl;
+        cout << "H: Alternar culling por oclusao (Hi-Z)" << endl;
+        cout << "O: Alternar culling por oclusao na CPU" << endl;
+        cout << "J: Alternar pre-passe de profundidade" << endl;
+        cout << "K: Alternar visualizacao de overdraw" << endl;
+        cout << "L: Alternar ordenacao da frente para tras" << endl;
+        cout << "B: Alternar ordenacao por estado (textura/material)" << endl;
+        cout << "N: Alternar permutacoes de shader (uber-shader)" << endl;
+        cout << "T: Gravar trace do perfil de quadros (formato do Chrome)" << endl;
+        cout << "F1: Alternar HUD de desempenho" << endl;
+        cout << "ESC: Sair" << endl;
+        cout << "=================" << endl;
+
+        glfwSwapInterval(vsyncEnabled ? 1 : 0);
+    }
+
+    std::vector<InstanceGroup> instanceGroups;
+    unordered_map<GLuint, size_t> groupByVAO;
+    std::vector<size_t> drawOrder;
+    bool firstFrame = true;
+
+    // No headless o passo de tempo é fixo, para trajetórias e caminho da
+    // câmera serem os mesmos em toda execução, e o relatório periódico dá
+    // lugar ao CSV com um registro por quadro.
+    FrameTimingLog timingLog;
+    if (headlessMode) {
+        timingLog.init(headlessFrames);
+        if (!pngDir.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(pngDir, ec);
+        }
+    }
+    size_t frameIndex = 0;
+    double headlessStart = glfwGetTime();
+
+    while (headlessMode ? frameIndex < (size_t)headlessFrames : !glfwWindowShouldClose(window)) {
+        double frameStart = glfwGetTime();
+        profiler.beginFrame(frameIndex);
+        renderCounters.reset();
+        if (headlessMode) {
+            deltaTime = headlessTimestep;
+        } else {
+            float currentFrame = glfwGetTime();
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+        }
+
+        bool useGpuCulling = gpuCullingEnabled && gpuCulling.available();
+        frameTimeAccum += deltaTime;
+        frameTimeSamples++;
+        if (!headlessMode && frameTimeAccum >= 2.0f) {
+            float avgMs = 1000.0f * frameTimeAccum / frameTimeSamples;
+            const char* pathName = useGpuCulling ? "culling na GPU + multi-draw indireto"
+                                 : (multiDrawIndirect && multiDraw.available()) ? "multi-draw indireto"
+                                 : instancedRendering ? "instanciado" : "um draw por objeto";
+            size_t visibleCount = useGpuCulling ? gpuCulling.readVisibleCount() : visibleMeshCount;
+            size_t occludedCount = useGpuCulling ? gpuCulling.readStats().occluded : softwareOccludedCount;
+            cout << "Tempo medio de quadro: " << avgMs << " ms (" << (1000.0f / avgMs) << " FPS, "
+                 << pathName << ", " << meshes.size() << " objetos, "
+                 << visibleCount << " visiveis, " << (meshes.size() - visibleCount) << " descartados, "
+                 << occludedCount << (useGpuCulling ? " ocultos pelo Hi-Z, " : " ocultos na CPU, ")
+                 << "submissao CPU " << (1000.0 * submitTimeAccum / frameTimeSamples) << " ms)" << endl;
+            cout << "GPU: pre-passe " << (prepassTimer.average() / 1e6) << " ms, ";
+            if (deferredShading) {
+                cout << "G-buffer " << (litPassTimer.average() / 1e6) << " ms, iluminacao deferred "
+                     << (deferredLightingTimer.average() / 1e6) << " ms, "
+                     << (shadedSamples.average() / ((double)viewport[2] * viewport[3])) << " fragmentos gravados no G-buffer por pixel (";
+            } else {
+                cout << "iluminacao " << (litPassTimer.average() / 1e6) << " ms, "
+                     << (shadedSamples.average() / ((double)viewport[2] * viewport[3])) << " fragmentos sombreados por pixel (";
+            }
+            cout
+                 << (depthPrepass ? "pre-passe ligado" : "pre-passe desligado") << ", "
+                 << (frontToBackSort ? "ordenado da frente para tras" : "sem ordenacao") << ")" << endl;
+            if (stateCache.changes + stateCache.skipped > 0) {
+                cout << "Estado: " << (stateCache.changes / frameTimeSamples) << " trocas por quadro, "
+                     << (stateCache.skipped / frameTimeSamples) << " evitadas pelo cache ("
+                     << (stateSort ? "ordenado por estado" : "sem ordenacao por estado") << ", "
+                     << mainPrograms.compiledCount() << " variantes de shader, "
+                     << mainPrograms.pendingCount() << " compilando"
+                     << (shaderPermutations ? "" : ", uber-shader") << ")" << endl;
+            }
+            if (profiler.enabled()) printProfile();
+            stateCache.changes = 0;
+            stateCache.skipped = 0;
+            prepassTimer.reset();
+            litPassTimer.reset();
+            deferredLightingTimer.reset();
+            shadedSamples.reset();
+            frameTimeAccum = 0.0f;
+            frameTimeSamples = 0;
+            submitTimeAccum = 0.0;
+        }
+
+        profiler.begin("entrada");
+        if (headlessMode) {
+            followCameraPath(deltaTime);
+        } else {
+            processInput(window);
+            glfwPollEvents();
+        }
+        profiler.end();
+
+        profiler.begin("trajetorias");
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            Mesh& mesh = meshes[i];
             if (mesh.trajectory.isActive && !mesh.trajectory.points.empty()) {
-                mesh.translation = mesh.trajectory.getCurrentPosition(deltaTime);
+                mesh.transform.setTranslation(mesh.trajectory.getCurrentPosition(deltaTime));
+                gpuCulling.markDirty(i);
             }
         }
+        // O objeto selecionado pode ter sido movido pelo teclado.
+        if (!meshes.empty()) gpuCulling.markDirty(selectedMesh);
+        profiler.end();
 
         glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         glm::mat4 view = camera.GetViewMatrix();
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Fov), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Fov), (float)WIDTH / (float)HEIGHT, NEAR_PLANE, FAR_PLANE);
 
-        glUseProgram(shaderProgram);
-        
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-        glUniform3fv(viewPosLoc, 1, glm::value_ptr(camera.Position));
-        glUniform1i(numLightsLoc, min((int)lights.size(), 8));
+        // No deferred, pré-passe e passe opaco desenham no G-buffer.
+        if (deferredShading) deferredRenderer.beginGeometry();
 
-        for (size_t i = 0; i < min(lights.size(), (size_t)8); ++i) {
-            glUniform3fv(lightPosLocs[i], 1, glm::value_ptr(lights[i].position));
-            glUniform3fv(lightAmbientLocs[i], 1, glm::value_ptr(lights[i].ambient));
-            glUniform3fv(lightDiffuseLocs[i], 1, glm::value_ptr(lights[i].diffuse));
-            glUniform3fv(lightSpecularLocs[i], 1, glm::value_ptr(lights[i].specular));
-            glUniform1i(lightEnabledLocs[i], lights[i].enabled);
-            glUniform1f(lightIntensityLocs[i], lights[i].intensity);
+        bool useOcclusion = useGpuCulling && occlusionCulling && hiZPyramid.available();
+        if (!useOcclusion) hiZPyramid.invalidate();
+        profiler.begin("culling");
+        if (useGpuCulling) {
+            cullingTimer.begin(frameIndex);
+            gpuCulling.cull(projection * view, frustumCulling, useOcclusion && hiZPyramid.valid() ? &hiZPyramid : nullptr);
+            cullingTimer.end();
+            if (validateGpuCulling) {
+                CullValidation check = gpuCulling.validate(projection * view, frustumCulling);
+                cout << "Validacao do culling na GPU: " << check.gpuVisible << " visiveis na GPU, "
+                     << check.cpuVisible << " na referencia da CPU, " << check.occluded << " ocultos pelo Hi-Z, "
+                     << check.mismatches << " divergencias" << endl;
+            }
+        } else {
+            cullMeshes(projection * view);
+            for (size_t i = 0; i < meshes.size() && hudEnabled; ++i) {
+                if (!meshVisible[i]) renderCounters.trianglesCulled += meshes[i].nIndices / 3;
+            }
         }
+        validateGpuCulling = false;
+        profiler.end();
 
-        for (size_t i = 0; i < meshes.size(); ++i) {
-            Mesh& mesh = meshes[i];
-            
-            glUniform3fv(matKaLoc, 1, glm::value_ptr(mesh.material.Ka));
-            glUniform3fv(matKdLoc, 1, glm::value_ptr(mesh.material.Kd));
-            glUniform3fv(matKsLoc, 1, glm::value_ptr(mesh.material.Ks));
-            glUniform1f(matNsLoc, mesh.material.Ns);
-            glUniform1i(matHasTextureLoc, mesh.material.hasTexture);
+        profiler.begin("luzes e uniforms");
+        updateClusterViewport();
+        uploadLightsIfDirty();
+        updateLightClusters(view);
+        bindLightBuffers();
+        profiler.end();
 
-            glUniform1i(useOverrideLoc, mesh.isSelected);
-            glUniform3f(overrideColorLoc, 0.8f, 0.8f, 1.0f);
+        // Submissão na CPU: do agrupamento até o último draw do passe opaco.
+        double submitStart = glfwGetTime();
+        profiler.begin("submissao");
+        bool useMultiDraw = !useGpuCulling && multiDrawIndirect && multiDraw.available();
+        bool useInstanced = !useGpuCulling && !useMultiDraw && instancedRendering;
+        bool usePerObject = !useGpuCulling && !useMultiDraw && !instancedRendering;
+        profiler.begin("agrupamento");
+        if (useMultiDraw || useInstanced) {
+            buildInstanceGroups(instanceGroups, groupByVAO);
+            if (frontToBackSort) sortInstanceGroups(instanceGroups, groupByVAO, view);
+            if (useMultiDraw) multiDraw.prepare(instanceGroups);
+        }
+        if (usePerObject) buildDrawOrder(drawOrder, view);
+        profiler.end();
 
-            if (mesh.material.hasTexture && mesh.textureID != 0) {
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, mesh.textureID);
-                glUniform1i(textureSamplerLoc, 0);
+        // Pré-passe: só profundidade, sem cor. O passe de iluminação depois
+        // usa GL_EQUAL sem escrever profundidade, então cada pixel roda o
+        // fragment shader de Phong uma única vez.
+        bool usePrepass = depthPrepass && depthProgram.program != 0;
+        if (usePrepass) {
+            glUseProgram(depthProgram.program);
+            glUniformMatrix4fv(depthProgram.viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+            glUniformMatrix4fv(depthProgram.projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            profiler.begin("pre-passe");
+            prepassTimer.begin(frameIndex);
+            if (useGpuCulling) {
+                glUniform1i(depthProgram.useDrawBuffersLoc, 1);
+                glUniform1i(depthProgram.useVisibleListLoc, 1);
+                gpuCulling.drawDepth();
+                glUniform1i(depthProgram.useVisibleListLoc, 0);
+                glUniform1i(depthProgram.useDrawBuffersLoc, 0);
+            } else if (useMultiDraw) {
+                glUniform1i(depthProgram.useDrawBuffersLoc, 1);
+                multiDraw.drawDepth();
+                glUniform1i(depthProgram.useDrawBuffersLoc, 0);
+            } else if (useInstanced) {
+                glUniform1i(depthProgram.useInstancingLoc, 1);
+                for (const auto& group : instanceGroups) {
+                    if (group.instances.empty()) continue;
+                    const Mesh& mesh = *group.mesh;
+                    uploadInstanceGroup(group);
+                    glBindVertexArray(mesh.VAO);
+                    glDrawElementsInstanced(GL_TRIANGLES, mesh.nIndices, GL_UNSIGNED_INT,
+                                            (void*)(mesh.firstIndex * sizeof(GLuint)), group.instances.size());
+                    renderCounters.addDraw((uint64_t)(mesh.nIndices / 3) * group.instances.size());
+                }
+                glBindVertexArray(0);
+                glUniform1i(depthProgram.useInstancingLoc, 0);
+            } else {
+                for (size_t i : drawOrder) {
+                    Mesh& mesh = meshes[i];
+                    glUniformMatrix4fv(depthProgram.modelLoc, 1, GL_FALSE, glm::value_ptr(mesh.transform.getModelMatrix()));
+                    glBindVertexArray(mesh.VAO);
+                    glDrawElements(GL_TRIANGLES, mesh.nIndices, GL_UNSIGNED_INT, (void*)(mesh.firstIndex * sizeof(GLuint)));
+                    renderCounters.addDraw(mesh.nIndices / 3);
+                }
+                glBindVertexArray(0);
             }
+            prepassTimer.end();
+            profiler.end();
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDepthFunc(GL_EQUAL);
+            glDepthMask(GL_FALSE);
+        }
+
+        if (showOverdraw) {
+            // No G-buffer só a cor difusa acumula; a posição continua
+            // marcando os pixels cobertos.
+            if (deferredShading) glEnablei(GL_BLEND, DeferredRenderer::ALBEDO_ATTACHMENT);
+            else glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE);
+        }
+
+        // O número de luzes ligadas vale para o quadro inteiro e entra em
+        // todas as permutações (só no forward: o G-buffer não ilumina). O
+        // modo de submissão continua em uniforms, que cada variante recebe
+        // na primeira vez que é ligada no quadro.
+        FrameUniforms frameUniforms;
+        frameUniforms.view = view;
+        frameUniforms.projection = projection;
+        frameUniforms.viewPos = camera.Position;
+        frameUniforms.useInstancing = useInstanced;
+        frameUniforms.useDrawBuffers = useGpuCulling || useMultiDraw;
+        frameUniforms.useVisibleList = useGpuCulling;
+        frameUniforms.showOverdraw = showOverdraw;
+        mainPrograms.beginFrame(frameUniforms);
+        int fixedLights = (!deferredShading && activeLightCount <= (size_t)MAX_FIXED_LIGHTS) ? (int)activeLightCount : -1;
 
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, mesh.translation);
-            model = glm::rotate(model, mesh.rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
-            model = glm::rotate(model, mesh.rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::rotate(model, mesh.rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
-            model = glm::scale(model, glm::vec3(mesh.scale));
-            glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+        profiler.begin("passe opaco");
+        litPassTimer.begin(frameIndex);
+        shadedSamples.begin();
+        if (useGpuCulling) {
+            // Textura e destaque vêm do SSBO de cada draw: ficam dinâmicos.
+            gpuCulling.draw(mainPrograms.use({ -1, -1, fixedLights }).textureSamplerLoc);
+        } else if (useMultiDraw) {
+            multiDraw.drawPrepared(mainPrograms.use({ -1, -1, fixedLights }).textureSamplerLoc);
+        } else if (useInstanced) {
+            // O destaque é um atributo por instância; a textura é do grupo.
+            for (const auto& group : instanceGroups) {
+                if (group.instances.empty()) continue;
+                const Mesh& mesh = *group.mesh;
+                const MainProgram& program = mainPrograms.use({ mesh.material.hasTexture, -1, fixedLights });
+
+                if (stateCache.useMaterial(mesh.material)) {
+                    glUniform3fv(program.matKaLoc, 1, glm::value_ptr(mesh.material.Ka));
+                    glUniform3fv(program.matKdLoc, 1, glm::value_ptr(mesh.material.Kd));
+                    glUniform3fv(program.matKsLoc, 1, glm::value_ptr(mesh.material.Ks));
+                    glUniform1f(program.matNsLoc, mesh.material.Ns);
+                    glUniform1i(program.matHasTextureLoc, mesh.material.hasTexture);
+                }
+                if (mesh.material.hasTexture && mesh.textureID != 0) {
+                    stateCache.bindTexture(mesh.textureID);
+                }
 
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+                // Com o pré-passe as instâncias já foram enviadas.
+                if (!usePrepass) uploadInstanceGroup(group);
 
-            glBindVertexArray(mesh.VAO);
-            glDrawElements(GL_TRIANGLES, mesh.nIndices, GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
+                stateCache.bindVertexArray(mesh.VAO);
+                glDrawElementsInstanced(GL_TRIANGLES, mesh.nIndices, GL_UNSIGNED_INT,
+                                        (void*)(mesh.firstIndex * sizeof(GLuint)), group.instances.size());
+                renderCounters.addDraw((uint64_t)(mesh.nIndices / 3) * group.instances.size());
+            }
+        }
 
+        for (size_t k = 0; k < drawOrder.size() && usePerObject; ++k) {
+            Mesh& mesh = meshes[drawOrder[k]];
+            const MainProgram& program = mainPrograms.use({ mesh.material.hasTexture, mesh.isSelected, fixedLights });
+            
+            if (stateCache.useMaterial(mesh.material)) {
+                glUniform3fv(program.matKaLoc, 1, glm::value_ptr(mesh.material.Ka));
+                glUniform3fv(program.matKdLoc, 1, glm::value_ptr(mesh.material.Kd));
+                glUniform3fv(program.matKsLoc, 1, glm::value_ptr(mesh.material.Ks));
+                glUniform1f(program.matNsLoc, mesh.material.Ns);
+                glUniform1i(program.matHasTextureLoc, mesh.material.hasTexture);
+            }
+            if (stateCache.useOverride(mesh.isSelected)) {
+                glUniform1i(program.useOverrideLoc, mesh.isSelected);
+            }
             if (mesh.material.hasTexture && mesh.textureID != 0) {
-                glBindTexture(GL_TEXTURE_2D, 0);
+                stateCache.bindTexture(mesh.textureID);
             }
+
+            glUniformMatrix4fv(program.modelLoc, 1, GL_FALSE, glm::value_ptr(mesh.transform.getModelMatrix()));
+            glUniformMatrix3fv(program.normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(mesh.transform.getNormalMatrix()));
+
+            stateCache.bindVertexArray(mesh.VAO);
+            glDrawElements(GL_TRIANGLES, mesh.nIndices, GL_UNSIGNED_INT, (void*)(mesh.firstIndex * sizeof(GLuint)));
+            renderCounters.addDraw(mesh.nIndices / 3);
+        }
+        // O resto do quadro (trajetórias, Hi-Z, deferred) não passa pelo cache.
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        stateCache.invalidate();
+        shadedSamples.end();
+        litPassTimer.end();
+        profiler.end();
+        if (showOverdraw) glDisable(GL_BLEND);
+        if (usePrepass) {
+            glDepthFunc(GL_LESS);
+            glDepthMask(GL_TRUE);
+        }
+        double submitSeconds = glfwGetTime() - submitStart;
+        submitTimeAccum += submitSeconds;
+        profiler.end();
+
+        if (deferredShading) {
+            profiler.begin("iluminacao deferred");
+            deferredLightingTimer.begin(frameIndex);
+            deferredRenderer.resolve(camera.Position, showOverdraw);
+            deferredLightingTimer.end();
+            profiler.end();
+        }
+
+        // A profundidade do passe opaco vira a pirâmide usada no próximo
+        // quadro; as visualizações de trajetória não ocultam nada.
+        if (useOcclusion) {
+            profiler.begin("piramide Hi-Z");
+            hiZTimer.begin(frameIndex);
+            hiZPyramid.build(projection * view);
+            hiZTimer.end();
+            profiler.end();
         }
 
+        profiler.begin("visualizacao de trajetorias");
+        overlayTimer.begin(frameIndex);
         renderTrajectoryVisualization(simpleShaderProgram, view, projection);
+        overlayTimer.end();
+        profiler.end();
+
+        if (hudEnabled) {
+            profiler.begin("hud");
+            perfHud.draw(viewport[2], viewport[3]);
+            profiler.end();
+        }
+
+        // Tempo de CPU do quadro sem a apresentação, que com vsync espera
+        // pela tela.
+        double cpuMs = 1000.0 * (glfwGetTime() - frameStart);
+        profiler.begin("apresentacao");
+        if (headlessMode) {
+            // Sem swap, o glFlush entrega o quadro ao driver. Com culling na
+            // GPU a contagem de visíveis exigiria ler o buffer de volta e
+            // fica de fora do CSV.
+            glFlush();
+            timingLog.record(frameIndex, glfwGetTime() - frameStart, submitSeconds,
+                             useGpuCulling ? -1 : (long)visibleMeshCount);
+            bool lastFrameOfRun = frameIndex + 1 == (size_t)headlessFrames;
+            if (!pngDir.empty() && (lastFrameOfRun || (pngEvery > 0 && frameIndex % pngEvery == 0))) {
+                char name[32];
+                snprintf(name, sizeof(name), "quadro_%05zu.png", frameIndex);
+                string path = (std::filesystem::path(pngDir) / name).string();
+                if (!offscreen.savePng(path)) cerr << "Erro ao gravar " << path << endl;
+            }
+        } else {
+            glfwSwapBuffers(window);
+        }
+        profiler.end();
+        profiler.endFrame();
+        perfHud.recordFrame(frameIndex, frameStart, cpuMs);
+        frameIndex++;
 
-        glfwSwapBuffers(window);
+        // O tempo conta desde glfwInit; o glFinish garante que o primeiro
+        // quadro (e a compilação adiada que o driver faça no primeiro draw)
+        // terminou de fato.
+        if (firstFrame) {
+            firstFrame = false;
+            glFinish();
+            cout << "Tempo ate o primeiro quadro: " << (1000.0 * glfwGetTime()) << " ms (programas "
+                 << (1000.0 * programSeconds) << " ms: " << programCache.loaded() << " do cache, "
+                 << programCache.compiled() << " compilados)" << endl;
+            if (startupProfiler.enabled()) {
+                startupProfiler.finish(startupProfiler.elapsedMs());
+                startupProfiler.print(stdout);
+                if (!startupJsonFile.empty()) {
+                    if (startupProfiler.writeJson(startupJsonFile)) {
+                        cout << "Tempos da partida gravados em " << startupJsonFile << endl;
+                    } else {
+                        cerr << "Erro ao gravar " << startupJsonFile << endl;
+                    }
+                }
+            }
+        }
     }
 
-    for (auto& mesh : meshes) {
-        glDeleteVertexArrays(1, &mesh.VAO);
-        glDeleteBuffers(1, &mesh.VBO);
-        glDeleteBuffers(1, &mesh.EBO);
-        if (mesh.textureID != 0) {
-            glDeleteTextures(1, &mesh.textureID);
+    if (headlessMode) {
+        double seconds = glfwGetTime() - headlessStart;
+        timingLog.finish();
+        if (timingLog.writeCsv(timingCsvPath)) {
+            cout << "Tempos por quadro gravados em " << timingCsvPath << endl;
+        } else {
+            cerr << "Erro ao gravar " << timingCsvPath << endl;
+        }
+        cout << "Headless: " << frameIndex << " quadros em " << seconds << " s, CPU medio "
+             << timingLog.averageCpuMs() << " ms por quadro, GPU medio " << timingLog.averageGpuMs() << " ms por quadro" << endl;
+        if (profiler.enabled()) {
+            for (GpuQueryRing* timer : { &cullingTimer, &hiZTimer, &overlayTimer }) timer->flush();
+            printProfile();
+            if (!traceFile.empty() && profiler.writeChromeTrace(traceFile)) {
+                cout << "Trace dos ultimos " << profiler.storedFrames() << " quadros gravado em " << traceFile << endl;
+            }
         }
     }
+
+    for (auto& mesh : meshes) {
+        assets.releaseMesh(mesh);
+    }
     glDeleteVertexArrays(1, &pointVAO);
     glDeleteBuffers(1, &pointVBO);
     glDeleteVertexArrays(1, &lineVAO);
     glDeleteBuffers(1, &lineVBO);
     glDeleteVertexArrays(1, &previewPointVAO);
     glDeleteBuffers(1, &previewPointVBO);
-    glDeleteProgram(shaderProgram);
+    glDeleteBuffers(1, &lightUBO);
+    deleteTextureBuffer(lightDataTBO);
+    deleteTextureBuffer(clusterRangesTBO);
+    deleteTextureBuffer(lightIndicesTBO);
+    prepassTimer.destroy();
+    litPassTimer.destroy();
+    deferredLightingTimer.destroy();
+    shadedSamples.destroy();
+    cullingTimer.destroy();
+    hiZTimer.destroy();
+    overlayTimer.destroy();
+    perfHud.destroy();
+    hiZPyramid.destroy();
+    deferredRenderer.destroy();
+    gpuCulling.destroy();
+    multiDraw.destroy();
+    geometryArena.destroy();
+    shaderCompiler.shutdown();
+    mainPrograms.destroy();
     glDeleteProgram(simpleShaderProgram);
+    if (depthProgram.program != 0) glDeleteProgram(depthProgram.program);
+    offscreen.destroy();
 
+#ifdef FINAL_HEADLESS_EGL
+    headlessContext.destroy();
+#endif
     glfwTerminate();
     return 0;
 }
@@ -1125,22 +4617,22 @@ void processInput(GLFWwindow *window) {
         float scaleSpeed = 1.0f * deltaTime;
         
         if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
-            mesh.translation.z -= moveSpeed;
+            mesh.transform.translate(glm::vec3(0.0f, 0.0f, -moveSpeed));
         if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
-            mesh.translation.z += moveSpeed;
+            mesh.transform.translate(glm::vec3(0.0f, 0.0f, moveSpeed));
         if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
-            mesh.translation.x -= moveSpeed;
+            mesh.transform.translate(glm::vec3(-moveSpeed, 0.0f, 0.0f));
         if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
-            mesh.translation.x += moveSpeed;
+            mesh.transform.translate(glm::vec3(moveSpeed, 0.0f, 0.0f));
         if (glfwGetKey(window, GLFW_KEY_PAGE_UP) == GLFW_PRESS)
-            mesh.translation.y += moveSpeed;
+            mesh.transform.translate(glm::vec3(0.0f, moveSpeed, 0.0f));
         if (glfwGetKey(window, GLFW_KEY_PAGE_DOWN) == GLFW_PRESS)
-            mesh.translation.y -= moveSpeed;
+            mesh.transform.translate(glm::vec3(0.0f, -moveSpeed, 0.0f));
             
         if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
-            mesh.scale = max(0.1f, mesh.scale - scaleSpeed);
+            mesh.transform.setScale(max(0.1f, mesh.transform.getScale() - scaleSpeed));
         if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
-            mesh.scale += scaleSpeed;
+            mesh.transform.setScale(mesh.transform.getScale() + scaleSpeed);
     }
 }
 
@@ -1154,6 +4646,7 @@ void key_callback(GLFWwindow* window, int key, int, int action, int) {
             case GLFW_KEY_TAB:
                 if (!meshes.empty()) {
                     meshes[selectedMesh].isSelected = false;
+                    gpuCulling.markDirty(selectedMesh);
                     selectedMesh = (selectedMesh + 1) % meshes.size();
                     meshes[selectedMesh].isSelected = true;
                     cout << "Objeto selecionado: " << meshes[selectedMesh].name << endl;
@@ -1199,21 +4692,98 @@ void key_callback(GLFWwindow* window, int key, int, int action, int) {
                 
             case GLFW_KEY_X:
                 if (!meshes.empty() && selectedMesh < meshes.size()) {
-                    meshes[selectedMesh].rotation.x += glm::radians(15.0f);
+                    meshes[selectedMesh].transform.rotate(glm::vec3(glm::radians(15.0f), 0.0f, 0.0f));
                 }
                 break;
                 
             case GLFW_KEY_Y:
                 if (!meshes.empty() && selectedMesh < meshes.size()) {
-                    meshes[selectedMesh].rotation.y += glm::radians(15.0f);
+                    meshes[selectedMesh].transform.rotate(glm::vec3(0.0f, glm::radians(15.0f), 0.0f));
                 }
                 break;
                 
             case GLFW_KEY_Z:
                 if (!meshes.empty() && selectedMesh < meshes.size()) {
-                    meshes[selectedMesh].rotation.z += glm::radians(15.0f);
+                    meshes[selectedMesh].transform.rotate(glm::vec3(0.0f, 0.0f, glm::radians(15.0f)));
+                }
+                break;
+                
+            case GLFW_KEY_I:
+                instancedRendering = !instancedRendering;
+                cout << "Renderizacao instanciada: " << (instancedRendering ? "ON" : "OFF") << endl;
+                break;
+                
+            case GLFW_KEY_M:
+                multiDrawIndirect = !multiDrawIndirect;
+                cout << "Multi-draw indireto: " << (multiDrawIndirect ? "ON" : "OFF") << endl;
+                break;
+                
+            case GLFW_KEY_F:
+                frustumCulling = !frustumCulling;
+                cout << "Frustum culling: " << (frustumCulling ? "ON" : "OFF") << endl;
+                break;
+
+            case GLFW_KEY_U:
+                gpuCullingEnabled = !gpuCullingEnabled;
+                cout << "Culling na GPU: " << (gpuCullingEnabled ? "ON" : "OFF") << endl;
+                break;
+
+            case GLFW_KEY_H:
+                occlusionCulling = !occlusionCulling;
+                cout << "Culling por oclusao (Hi-Z): " << (occlusionCulling ? "ON" : "OFF")
+                     << (gpuCullingEnabled ? "" : " (requer o culling na GPU, tecla U)") << endl;
+                break;
+
+            case GLFW_KEY_O:
+                softwareOcclusion = !softwareOcclusion;
+                cout << "Culling por oclusao na CPU: " << (softwareOcclusion ? "ON" : "OFF")
+                     << (gpuCullingEnabled ? " (ignorado com o culling na GPU, tecla U)" : "") << endl;
+                break;
+
+            case GLFW_KEY_J:
+                depthPrepass = !depthPrepass;
+                cout << "Pre-passe de profundidade: " << (depthPrepass ? "ON" : "OFF") << endl;
+                break;
+
+            case GLFW_KEY_K:
+                showOverdraw = !showOverdraw;
+                cout << "Visualizacao de overdraw: " << (showOverdraw ? "ON" : "OFF") << endl;
+                break;
+
+            case GLFW_KEY_L:
+                frontToBackSort = !frontToBackSort;
+                cout << "Ordenacao da frente para tras: " << (frontToBackSort ? "ON" : "OFF") << endl;
+                break;
+
+            case GLFW_KEY_B:
+                stateSort = !stateSort;
+                cout << "Ordenacao por estado: " << (stateSort ? "ON" : "OFF") << endl;
+                break;
+
+            case GLFW_KEY_N:
+                shaderPermutations = !shaderPermutations;
+                cout << "Permutacoes de shader: " << (shaderPermutations ? "ON" : "OFF (uber-shader)") << endl;
+                break;
+
+            case GLFW_KEY_T:
+                if (!profiler.enabled()) {
+                    cout << "Perfil de quadros desligado" << endl;
+                } else if (profiler.writeChromeTrace(traceFile)) {
+                    cout << "Trace dos ultimos " << profiler.storedFrames() << " quadros gravado em " << traceFile << endl;
+                } else {
+                    cerr << "Erro ao gravar " << traceFile << endl;
                 }
                 break;
+
+            case GLFW_KEY_F1:
+                hudEnabled = !hudEnabled && perfHud.available();
+                cout << "HUD de desempenho: " << (hudEnabled ? "ON" : "OFF") << endl;
+                break;
+
+            case GLFW_KEY_V:
+                validateGpuCulling = gpuCullingEnabled && gpuCulling.available();
+                if (!validateGpuCulling) cout << "Culling na GPU desligado; nada a validar" << endl;
+                break;
                 
             case GLFW_KEY_1:
             case GLFW_KEY_2:
@@ -1226,6 +4796,7 @@ void key_callback(GLFWwindow* window, int key, int, int action, int) {
                 int lightIndex = key - GLFW_KEY_1;
                 if (lightIndex < lights.size()) {
                     lights[lightIndex].enabled = !lights[lightIndex].enabled;
+                    lightsDirty = true;
                     cout << "Luz " << (lightIndex + 1) << ": " << (lights[lightIndex].enabled ? "ON" : "OFF") << endl;
                 }
                 break;
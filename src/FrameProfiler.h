@@ -0,0 +1,280 @@
+#pragma once
+
+// Perfil de quadros: escopos de CPU aninhados medidos com steady_clock,
+// tempos de GPU por passe que chegam alguns quadros depois (consultas
+// GL_TIME_ELAPSED lidas pelo chamador), médias móveis e percentis de cada
+// medida e exportação no formato JSON de trace do Chrome (chrome://tracing,
+// ui.perfetto.dev). Não faz chamadas OpenGL.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+// As `capacity` amostras mais recentes de uma medida.
+class RollingSamples {
+public:
+    explicit RollingSamples(size_t capacity = 240) : capacity(std::max<size_t>(1, capacity)) {}
+
+    void add(double value) {
+        if (values.size() < capacity) {
+            values.push_back(value);
+        } else {
+            values[next] = value;
+        }
+        next = (next + 1) % capacity;
+    }
+
+    void clear() {
+        values.clear();
+        next = 0;
+    }
+
+    size_t count() const { return values.size(); }
+
+    double average() const {
+        double total = 0.0;
+        for (double value : values) total += value;
+        return values.empty() ? 0.0 : total / values.size();
+    }
+
+    // Percentil `p` (0-100) pelo método do posto mais próximo.
+    double percentile(double p) const {
+        if (values.empty()) return 0.0;
+        std::vector<double> sorted = values;
+        size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+        size_t index = std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0);
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    }
+
+private:
+    size_t capacity;
+    size_t next = 0;
+    std::vector<double> values;
+};
+
+// Um intervalo medido, em microssegundos desde a criação do perfil.
+struct ProfileEvent {
+    uint32_t name;
+    uint32_t depth;
+    double start;
+    double duration;
+};
+
+// Medidas de um quadro guardadas para o trace. Os eventos de GPU trazem só
+// a duração; no trace eles ficam em sequência a partir do início do quadro.
+struct ProfileFrame {
+    uint64_t index = 0;
+    double start = 0.0;
+    double duration = 0.0;
+    double gpuCursor = 0.0;
+    std::vector<ProfileEvent> cpu;
+    std::vector<ProfileEvent> gpu;
+};
+
+class FrameProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FrameProfiler(size_t window = 240) : window(window), frameTimes(window), epoch(Clock::now()) {}
+
+    void setEnabled(bool value) { active = value; }
+    bool enabled() const { return active; }
+
+    // Quantos quadros ficam guardados para o trace (0 = nenhum).
+    void setHistory(size_t frames) {
+        history = frames;
+        while (recorded.size() > history) recorded.pop_front();
+    }
+
+    // `frame` numera o quadro; é o número que as consultas de GPU guardam
+    // para addGpuTime.
+    void beginFrame(uint64_t frame) {
+        if (!active) return;
+        frameIndex = frame;
+        stack.clear();
+        frameStart = now();
+        frameOpen = true;
+        if (history == 0) return;
+        if (recorded.size() == history) recorded.pop_front();
+        recorded.emplace_back();
+        recorded.back().index = frameIndex;
+        recorded.back().start = frameStart;
+    }
+
+    void endFrame() {
+        if (!active) return;
+        while (!stack.empty()) end();
+        frameOpen = false;
+        double duration = now() - frameStart;
+        if (!recorded.empty() && recorded.back().index == frameIndex) recorded.back().duration = duration;
+        frameTimes.add(duration / 1000.0);
+    }
+
+    // Escopos aninham: cada end() fecha o begin() mais recente. Os nomes são
+    // comparados primeiro pelo ponteiro, então literais custam pouco.
+    void begin(const char* name) {
+        if (!active) return;
+        stack.push_back({ nameId(name), now() });
+    }
+
+    void end() {
+        if (!active || stack.empty()) return;
+        OpenScope scope = stack.back();
+        stack.pop_back();
+        double duration = now() - scope.start;
+        stats(scope.name).cpu.add(duration / 1000.0);
+        if (!recorded.empty() && recorded.back().index == frameIndex) {
+            recorded.back().cpu.push_back({ scope.name, (uint32_t)stack.size(), scope.start, duration });
+        }
+    }
+
+    // Tempo de GPU de um passe do quadro `frame`, em nanossegundos.
+    void addGpuTime(const char* name, uint64_t frame, double nanoseconds) {
+        if (!active) return;
+        uint32_t id = nameId(name);
+        double duration = nanoseconds / 1000.0;
+        stats(id).gpu.add(duration / 1000.0);
+        GpuTotal& total = gpuTotals[frame % GPU_TOTAL_FRAMES];
+        if (total.frame != frame + 1) total = { frame + 1, 0.0 };
+        total.milliseconds += duration / 1000.0;
+        if (recorded.empty() || frame < recorded.front().index || frame > recorded.back().index) return;
+        ProfileFrame& record = recorded[(size_t)(frame - recorded.front().index)];
+        if (record.index != frame) return;
+        record.gpu.push_back({ id, 0, record.start + record.gpuCursor, duration });
+        record.gpuCursor += duration;
+    }
+
+    // Soma dos tempos de GPU já recebidos do quadro `frame`, em ms, ou -1 se
+    // nenhum chegou. Vale para os últimos GPU_TOTAL_FRAMES quadros, mesmo
+    // sem quadros guardados para o trace.
+    double gpuFrameTime(uint64_t frame) const {
+        const GpuTotal& total = gpuTotals[frame % GPU_TOTAL_FRAMES];
+        return total.frame == frame + 1 ? total.milliseconds : -1.0;
+    }
+
+    // Tempos de quadro (do beginFrame ao endFrame), em ms.
+    const RollingSamples& frameSamples() const { return frameTimes; }
+
+    // Nomes na ordem em que apareceram e as amostras de CPU e GPU de cada
+    // um, em ms. Um nome pode ter só CPU, só GPU ou os dois.
+    size_t nameCount() const { return names.size(); }
+    const char* name(size_t id) const { return names[id].c_str(); }
+    const RollingSamples& cpuSamples(size_t id) const { return scopes[id].cpu; }
+    const RollingSamples& gpuSamples(size_t id) const { return scopes[id].gpu; }
+
+    void clearSamples() {
+        frameTimes.clear();
+        for (auto& scope : scopes) {
+            scope.cpu.clear();
+            scope.gpu.clear();
+        }
+    }
+
+    // Grava os quadros guardados como trace do Chrome: a CPU na thread 1 e
+    // a GPU na thread 2, com eventos completos ("ph": "X") em microssegundos.
+    // O quadro em andamento fica de fora.
+    bool writeChromeTrace(const std::string& path) const {
+        FILE* f = fopen(path.c_str(), "w");
+        if (!f) return false;
+        fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+        fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+        for (const ProfileFrame& frame : recorded) {
+            if (frame.duration == 0.0) continue;
+            writeEvent(f, "quadro", "cpu", 1, frame.start, frame.duration, frame.index);
+            for (const ProfileEvent& event : frame.cpu) {
+                writeEvent(f, names[event.name].c_str(), "cpu", 1, event.start, event.duration, frame.index);
+            }
+            for (const ProfileEvent& event : frame.gpu) {
+                writeEvent(f, names[event.name].c_str(), "gpu", 2, event.start, event.duration, frame.index);
+            }
+        }
+        fprintf(f, "\n]}\n");
+        return fclose(f) == 0;
+    }
+
+    // Quadros guardados e já terminados, do mais antigo ao mais novo.
+    size_t storedFrames() const { return recorded.size() - (frameOpen && !recorded.empty() ? 1 : 0); }
+    const ProfileFrame& storedFrame(size_t i) const { return recorded[i]; }
+
+private:
+    struct OpenScope {
+        uint32_t name;
+        double start;
+    };
+
+    // `frame` guarda o número do quadro mais um; zero marca vaga livre.
+    struct GpuTotal {
+        uint64_t frame;
+        double milliseconds;
+    };
+
+    static const size_t GPU_TOTAL_FRAMES = 16;
+
+    struct ScopeStats {
+        RollingSamples cpu;
+        RollingSamples gpu;
+    };
+
+    double now() const { return std::chrono::duration<double, std::micro>(Clock::now() - epoch).count(); }
+
+    uint32_t nameId(const char* name) {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] == name) return (uint32_t)i;
+        }
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == name) return (uint32_t)i;
+        }
+        keys.push_back(name);
+        names.push_back(name);
+        scopes.push_back({ RollingSamples(window), RollingSamples(window) });
+        return (uint32_t)(names.size() - 1);
+    }
+
+    ScopeStats& stats(uint32_t id) { return scopes[id]; }
+
+    static void writeEvent(FILE* f, const char* name, const char* category, int thread, double start, double duration,
+                           uint64_t frame) {
+        fprintf(f, ",\n{\"name\":\"");
+        for (const char* c = name; *c; ++c) {
+            if (*c == '"' || *c == '\\') fputc('\\', f);
+            fputc(*c, f);
+        }
+        fprintf(f, "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"quadro\":%llu}}",
+                category, thread, start, duration, (unsigned long long)frame);
+    }
+
+    size_t window;
+    bool active = true;
+    size_t history = 300;
+    uint64_t frameIndex = 0;
+    double frameStart = 0.0;
+    bool frameOpen = false;
+    RollingSamples frameTimes;
+    Clock::time_point epoch;
+    std::vector<OpenScope> stack;
+    std::deque<ProfileFrame> recorded;
+    GpuTotal gpuTotals[GPU_TOTAL_FRAMES] = {};
+    std::vector<const char*> keys;
+    std::vector<std::string> names;
+    std::vector<ScopeStats> scopes;
+};
+
+// Mede o bloco em que é declarado.
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler& profiler, const char* name) : profiler(profiler) { profiler.begin(name); }
+    ~ProfileScope() { profiler.end(); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    FrameProfiler& profiler;
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+// Frustum culling de caixas envolventes (AABB). As caixas já transformadas
+// para o mundo ficam em layout SoA (centros e meias-extensões em vetores
+// separados), de modo que cada instrução SIMD testa 4 (SSE) ou 8 (AVX)
+// caixas contra um plano. Não faz chamadas OpenGL.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_CULLING_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_CULLING_WIDTH 4
+#else
+#define FRUSTUM_CULLING_WIDTH 1
+#endif
+
+// Seis planos (esquerdo, direito, baixo, cima, near, far) com a normal
+// apontando para dentro: um ponto p está dentro se dot(n, p) + w >= 0.
+struct Frustum {
+    glm::vec4 planes[6];
+
+    // Extrai os planos de projection * view (Gribb/Hartmann).
+    static Frustum fromMatrix(const glm::mat4& m) {
+        Frustum f;
+        glm::vec4 row[4];
+        for (int i = 0; i < 4; ++i) row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+        f.planes[0] = row[3] + row[0];
+        f.planes[1] = row[3] - row[0];
+        f.planes[2] = row[3] + row[1];
+        f.planes[3] = row[3] - row[1];
+        f.planes[4] = row[3] + row[2];
+        f.planes[5] = row[3] - row[2];
+        for (auto& plane : f.planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return f;
+    }
+};
+
+// Caixas no espaço do mundo em layout SoA. Os vetores são completados até
+// um múltiplo de 8 com caixas vazias, para o laço SIMD não ter resto.
+class CullingSet {
+public:
+    void clear() {
+        count = 0;
+        for (auto* v : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ }) v->clear();
+    }
+
+    void reserve(size_t n) {
+        for (auto* v : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ }) v->reserve(n + 8);
+    }
+
+    // Transforma a caixa [boundsMin, boundsMax] pela matriz do objeto e
+    // guarda a AABB resultante no mundo (Arvo: |M| aplicado à meia-extensão).
+    size_t add(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model) {
+        if (centerX.size() != count) trim();
+        glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+        glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+        glm::vec3 worldExtent;
+        for (int i = 0; i < 3; ++i) {
+            worldExtent[i] = std::fabs(model[0][i]) * extent.x + std::fabs(model[1][i]) * extent.y + std::fabs(model[2][i]) * extent.z;
+        }
+        centerX.push_back(worldCenter.x);
+        centerY.push_back(worldCenter.y);
+        centerZ.push_back(worldCenter.z);
+        extentX.push_back(worldExtent.x);
+        extentY.push_back(worldExtent.y);
+        extentZ.push_back(worldExtent.z);
+        return count++;
+    }
+
+    size_t size() const { return count; }
+
+    // Remove o preenchimento deixado por pad().
+    void trim() {
+        for (auto* v : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ }) v->resize(count);
+    }
+
+    // Preenche as posições de sobra com caixas de extensão negativa, que
+    // nunca passam no teste.
+    void pad() {
+        size_t padded = (count + 7) & ~(size_t)7;
+        for (auto* v : { &centerX, &centerY, &centerZ }) v->resize(padded, 0.0f);
+        for (auto* v : { &extentX, &extentY, &extentZ }) v->resize(padded, -1e30f);
+    }
+
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+private:
+    size_t count = 0;
+};
+
+// Versão escalar do teste, usada como referência e em plataformas sem SIMD.
+inline size_t cullAABBsScalar(const Frustum& frustum, const CullingSet& set, std::vector<uint8_t>& visible) {
+    visible.assign(set.size(), 0);
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < set.size(); ++i) {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; ++p) {
+            const glm::vec4& plane = frustum.planes[p];
+            float distance = plane.x * set.centerX[i] + plane.y * set.centerY[i] + plane.z * set.centerZ[i] + plane.w;
+            float radius = std::fabs(plane.x) * set.extentX[i] + std::fabs(plane.y) * set.extentY[i] + std::fabs(plane.z) * set.extentZ[i];
+            inside = distance + radius >= 0.0f;
+        }
+        visible[i] = inside ? 1 : 0;
+        visibleCount += inside;
+    }
+    return visibleCount;
+}
+
+// Marca em `visible` (um byte por caixa) quais caixas tocam o frustum e
+// devolve quantas são visíveis. Chama set.pad() antes do laço.
+inline size_t cullAABBs(const Frustum& frustum, CullingSet& set, std::vector<uint8_t>& visible) {
+#if FRUSTUM_CULLING_WIDTH == 1
+    return cullAABBsScalar(frustum, set, visible);
+#else
+    set.pad();
+    size_t count = set.size();
+    size_t padded = set.centerX.size();
+    visible.resize(padded);
+    size_t visibleCount = 0;
+    static const uint8_t bitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+#if FRUSTUM_CULLING_WIDTH == 8
+    __m256 signMask = _mm256_set1_ps(-0.0f);
+    __m256 planeX[6], planeY[6], planeZ[6], planeW[6], absX[6], absY[6], absZ[6];
+    for (int p = 0; p < 6; ++p) {
+        const glm::vec4& plane = frustum.planes[p];
+        planeX[p] = _mm256_set1_ps(plane.x);
+        planeY[p] = _mm256_set1_ps(plane.y);
+        planeZ[p] = _mm256_set1_ps(plane.z);
+        planeW[p] = _mm256_set1_ps(plane.w);
+        absX[p] = _mm256_andnot_ps(signMask, planeX[p]);
+        absY[p] = _mm256_andnot_ps(signMask, planeY[p]);
+        absZ[p] = _mm256_andnot_ps(signMask, planeZ[p]);
+    }
+    for (size_t i = 0; i < padded; i += 8) {
+        __m256 cx = _mm256_loadu_ps(&set.centerX[i]);
+        __m256 cy = _mm256_loadu_ps(&set.centerY[i]);
+        __m256 cz = _mm256_loadu_ps(&set.centerZ[i]);
+        __m256 ex = _mm256_loadu_ps(&set.extentX[i]);
+        __m256 ey = _mm256_loadu_ps(&set.extentY[i]);
+        __m256 ez = _mm256_loadu_ps(&set.extentZ[i]);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[p], cx), _mm256_mul_ps(planeY[p], cy)),
+                                            _mm256_add_ps(_mm256_mul_ps(planeZ[p], cz), planeW[p]));
+            __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absX[p], ex), _mm256_mul_ps(absY[p], ey)),
+                                          _mm256_mul_ps(absZ[p], ez));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        int mask = _mm256_movemask_ps(inside);
+        for (int k = 0; k < 8; ++k) visible[i + k] = (mask >> k) & 1;
+        visibleCount += bitCount[mask & 15] + bitCount[mask >> 4];
+    }
+#else
+    __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6], absX[6], absY[6], absZ[6];
+    for (int p = 0; p < 6; ++p) {
+        const glm::vec4& plane = frustum.planes[p];
+        planeX[p] = _mm_set1_ps(plane.x);
+        planeY[p] = _mm_set1_ps(plane.y);
+        planeZ[p] = _mm_set1_ps(plane.z);
+        planeW[p] = _mm_set1_ps(plane.w);
+        absX[p] = _mm_andnot_ps(signMask, planeX[p]);
+        absY[p] = _mm_andnot_ps(signMask, planeY[p]);
+        absZ[p] = _mm_andnot_ps(signMask, planeZ[p]);
+    }
+    for (size_t i = 0; i < padded; i += 4) {
+        __m128 cx = _mm_loadu_ps(&set.centerX[i]);
+        __m128 cy = _mm_loadu_ps(&set.centerY[i]);
+        __m128 cz = _mm_loadu_ps(&set.centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&set.extentX[i]);
+        __m128 ey = _mm_loadu_ps(&set.extentY[i]);
+        __m128 ez = _mm_loadu_ps(&set.extentZ[i]);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], cx), _mm_mul_ps(planeY[p], cy)),
+                                         _mm_add_ps(_mm_mul_ps(planeZ[p], cz), planeW[p]));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], ex), _mm_mul_ps(absY[p], ey)),
+                                       _mm_mul_ps(absZ[p], ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+        int mask = _mm_movemask_ps(inside);
+        for (int k = 0; k < 4; ++k) visible[i + k] = (mask >> k) & 1;
+        visibleCount += bitCount[mask];
+    }
+#endif
+
+    visible.resize(count);
+    return visibleCount;
+#endif
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+// Atribuição de luzes a clusters (froxels) do frustum de visão para o
+// forward clusterizado. A tela é dividida em gridX x gridY blocos e a
+// profundidade em gridZ fatias exponenciais entre near e far. Cada luz entra
+// em todos os clusters que a esfera de alcance dela toca. Não faz chamadas
+// OpenGL: o resultado são os vetores que vão para os texture buffers.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+struct ClusterLight {
+    glm::vec3 position = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+struct ClusterGrid {
+    uint32_t gridX = 16;
+    uint32_t gridY = 9;
+    uint32_t gridZ = 24;
+    float nearPlane = 0.1f;
+    float farPlane = 100.0f;
+    float fovY = glm::radians(45.0f);
+    float aspect = 4.0f / 3.0f;
+
+    uint32_t clusterCount() const { return gridX * gridY * gridZ; }
+};
+
+// Distância em que a atenuação do shader (1 / (1 + 0.09 d + 0.032 d²)),
+// multiplicada pela intensidade e pela maior componente de cor da luz,
+// cai abaixo de `threshold`.
+inline float lightRadius(float intensity, const glm::vec3& diffuse, const glm::vec3& specular, float threshold = 1.0f / 256.0f) {
+    float peak = intensity * std::max({ diffuse.r, diffuse.g, diffuse.b, specular.r, specular.g, specular.b });
+    if (peak <= threshold) return 0.0f;
+    const float a = 0.032f, b = 0.09f;
+    float c = 1.0f - peak / threshold;
+    return (-b + std::sqrt(b * b - 4.0f * a * c)) / (2.0f * a);
+}
+
+class LightClusterBuilder {
+public:
+    // Monta a lista de luzes por cluster. `view` leva do mundo para o espaço
+    // da câmera; luzes com raio <= 0 são ignoradas.
+    void build(const std::vector<ClusterLight>& lights, const glm::mat4& view, const ClusterGrid& grid) {
+        size_t clusterCount = grid.clusterCount();
+        counts.assign(clusterCount, 0);
+        spans.clear();
+
+        float tanY = std::tan(grid.fovY * 0.5f);
+        float tanX = tanY * grid.aspect;
+        float logRatio = std::log(grid.farPlane / grid.nearPlane);
+
+        for (uint32_t li = 0; li < lights.size(); ++li) {
+            const ClusterLight& light = lights[li];
+            if (light.radius <= 0.0f) continue;
+
+            glm::vec4 viewPos = view * glm::vec4(light.position, 1.0f);
+            float depth = -viewPos.z;
+            float r = light.radius;
+            if (depth + r < grid.nearPlane || depth - r > grid.farPlane) continue;
+
+            uint32_t z0 = sliceOf(std::max(depth - r, grid.nearPlane), grid, logRatio);
+            uint32_t z1 = sliceOf(std::min(depth + r, grid.farPlane), grid, logRatio);
+            for (uint32_t z = z0; z <= z1; ++z) {
+                float sliceNear = std::max(sliceDepth(z, grid), depth - r);
+                float sliceFar = std::min(sliceDepth(z + 1, grid), depth + r);
+                sliceNear = std::max(sliceNear, grid.nearPlane);
+
+                int x0, x1, y0, y1;
+                if (!tileRange(viewPos.x - r, viewPos.x + r, sliceNear, sliceFar, tanX, grid.gridX, x0, x1)) continue;
+                if (!tileRange(viewPos.y - r, viewPos.y + r, sliceNear, sliceFar, tanY, grid.gridY, y0, y1)) continue;
+
+                spans.push_back({ li, z, (uint32_t)x0, (uint32_t)x1, (uint32_t)y0, (uint32_t)y1 });
+                for (int y = y0; y <= y1; ++y) {
+                    for (int x = x0; x <= x1; ++x) {
+                        counts[clusterIndex(x, y, z, grid)]++;
+                    }
+                }
+            }
+        }
+
+        ranges.resize(clusterCount * 2);
+        uint32_t offset = 0;
+        for (size_t c = 0; c < clusterCount; ++c) {
+            ranges[c * 2] = offset;
+            ranges[c * 2 + 1] = 0;
+            offset += counts[c];
+        }
+        indices.resize(offset);
+        for (const Span& span : spans) {
+            for (uint32_t y = span.y0; y <= span.y1; ++y) {
+                for (uint32_t x = span.x0; x <= span.x1; ++x) {
+                    uint32_t c = clusterIndex(x, y, span.z, grid);
+                    indices[ranges[c * 2] + ranges[c * 2 + 1]++] = span.light;
+                }
+            }
+        }
+    }
+
+    // Dois uint32 por cluster: início em indices() e quantidade de luzes.
+    const std::vector<uint32_t>& clusterRanges() const { return ranges; }
+    const std::vector<uint32_t>& lightIndices() const { return indices; }
+
+    static uint32_t clusterIndex(uint32_t x, uint32_t y, uint32_t z, const ClusterGrid& grid) {
+        return (z * grid.gridY + y) * grid.gridX + x;
+    }
+
+    static float sliceDepth(uint32_t slice, const ClusterGrid& grid) {
+        return grid.nearPlane * std::pow(grid.farPlane / grid.nearPlane, (float)slice / grid.gridZ);
+    }
+
+private:
+    struct Span {
+        uint32_t light, z, x0, x1, y0, y1;
+    };
+
+    static uint32_t sliceOf(float depth, const ClusterGrid& grid, float logRatio) {
+        int slice = (int)std::floor(std::log(depth / grid.nearPlane) / logRatio * grid.gridZ);
+        return (uint32_t)std::clamp(slice, 0, (int)grid.gridZ - 1);
+    }
+
+    // Intervalo de blocos coberto por [lo, hi] (coordenada de câmera) entre
+    // as profundidades dNear e dFar, de forma conservadora.
+    static bool tileRange(float lo, float hi, float dNear, float dFar, float tanHalf, uint32_t tiles, int& t0, int& t1) {
+        float ndcLo = lo / ((lo < 0.0f ? dNear : dFar) * tanHalf);
+        float ndcHi = hi / ((hi > 0.0f ? dNear : dFar) * tanHalf);
+        if (ndcHi < -1.0f || ndcLo > 1.0f) return false;
+        t0 = std::clamp((int)std::floor((ndcLo * 0.5f + 0.5f) * tiles), 0, (int)tiles - 1);
+        t1 = std::clamp((int)std::floor((ndcHi * 0.5f + 0.5f) * tiles), 0, (int)tiles - 1);
+        return true;
+    }
+
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> ranges;
+    std::vector<uint32_t> indices;
+    std::vector<Span> spans;
+};
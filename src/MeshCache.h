@@ -0,0 +1,290 @@
+#pragma once
+
+// Cache binário (.meshbin) das malhas já processadas: buffer intercalado de
+// vértices, índices, caixa envolvente e material resolvido. O cache guarda
+// tamanho, data de modificação e hash do conteúdo do OBJ e do MTL; quando a
+// data muda o hash decide se o cache ainda vale, e a data nova é gravada.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ObjParser.h"
+
+const char MESH_CACHE_MAGIC[8] = { 'M', 'E', 'S', 'H', 'B', 'I', 'N', '\0' };
+const uint32_t MESH_CACHE_VERSION = 1;
+const char* const MESH_CACHE_EXTENSION = ".meshbin";
+
+struct MeshCacheMaterial {
+    glm::vec3 Ka = glm::vec3(0.1f);
+    glm::vec3 Kd = glm::vec3(0.7f);
+    glm::vec3 Ks = glm::vec3(0.2f);
+    float Ns = 32.0f;
+    std::string map_Kd_path = "";
+    bool hasTexture = false;
+};
+
+// Visão sobre um cache mapeado em memória; os ponteiros valem enquanto o
+// MappedFile usado na leitura estiver aberto.
+struct MeshCacheData {
+    const float* vertices = nullptr;
+    size_t vertexFloatCount = 0;
+    const uint32_t* indices = nullptr;
+    size_t indexCount = 0;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    MeshCacheMaterial material;
+};
+
+namespace meshcache {
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t dependencyCount;
+    uint64_t vertexFloatCount;
+    uint64_t indexCount;
+    uint64_t dataOffset;
+    float boundsMin[3];
+    float boundsMax[3];
+    float Ka[3];
+    float Kd[3];
+    float Ks[3];
+    float Ns;
+    uint32_t hasTexture;
+};
+
+// Arquivo de origem do qual o cache depende (OBJ e MTL).
+struct Dependency {
+    uint64_t size;
+    int64_t mtime;
+    uint64_t hash;
+};
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCDull;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ull;
+    k ^= k >> 33;
+    return k;
+}
+
+// Hash de 64 bits do conteúdo, processando 8 bytes por iteração.
+inline uint64_t hashBytes(const char* data, size_t size) {
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ (size * 0x87C37B91114253D5ull);
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t k;
+        memcpy(&k, data + i * 8, 8);
+        k *= 0x87C37B91114253D5ull;
+        k = rotl(k, 31);
+        k *= 0x4CF5AD432745937Full;
+        h ^= k;
+        h = rotl(h, 27) * 5 + 0x52DCE729;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data + words * 8, size % 8);
+    h ^= fmix(tail);
+    return fmix(h);
+}
+
+inline bool hashFile(const std::string& path, uint64_t& hash) {
+    MappedFile file(path);
+    if (!file.isOpen()) return false;
+    hash = hashBytes(file.data(), file.size());
+    return true;
+}
+
+inline bool statFile(const std::string& path, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    size = (uint64_t)std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    mtime = (int64_t)time.time_since_epoch().count();
+    return true;
+}
+
+inline bool describeFile(const std::string& path, Dependency& dep) {
+    return statFile(path, dep.size, dep.mtime) && hashFile(path, dep.hash);
+}
+
+// Confere se o arquivo ainda corresponde ao que foi gravado no cache. O hash
+// só é recalculado quando o tamanho bate mas a data de modificação mudou;
+// `mtime` recebe a data atual do arquivo.
+inline bool dependencyIsFresh(const std::string& path, const Dependency& dep, int64_t& mtime) {
+    uint64_t size = 0;
+    if (!statFile(path, size, mtime) || size != dep.size) return false;
+    if (mtime == dep.mtime) return true;
+    uint64_t hash = 0;
+    return hashFile(path, hash) && hash == dep.hash;
+}
+
+// Regrava no lugar a data de modificação de uma dependência que está em
+// `offset` no cache. Sem isso, depois de um touch ou checkout toda partida
+// recalcularia o hash. Uma falha (pasta só de leitura) só mantém o custo.
+inline void refreshDependencyTime(const std::string& cachePath, size_t offset, int64_t mtime) {
+    FILE* f = fopen(cachePath.c_str(), "r+b");
+    if (!f) return;
+    if (fseek(f, (long)(offset + offsetof(Dependency, mtime)), SEEK_SET) == 0) fwrite(&mtime, sizeof(mtime), 1, f);
+    fclose(f);
+}
+
+inline void writeString(std::vector<char>& out, const std::string& str) {
+    uint32_t length = (uint32_t)str.size();
+    out.insert(out.end(), (const char*)&length, (const char*)&length + sizeof(length));
+    out.insert(out.end(), str.begin(), str.end());
+}
+
+inline bool readString(const char*& p, const char* end, std::string& str) {
+    uint32_t length = 0;
+    if (end - p < (ptrdiff_t)sizeof(length)) return false;
+    memcpy(&length, p, sizeof(length));
+    p += sizeof(length);
+    if (end - p < (ptrdiff_t)length) return false;
+    str.assign(p, length);
+    p += length;
+    return true;
+}
+
+inline std::string canonicalPath(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+    return ec ? path : canonical.string();
+}
+
+} // namespace meshcache
+
+// Caminho do cache para `sourcePath`: ao lado do arquivo quando `cacheDir`
+// é vazio, senão dentro de `cacheDir` com o hash do caminho canônico no nome.
+inline std::string meshCachePath(const std::string& sourcePath, const std::string& cacheDir) {
+    if (cacheDir.empty()) return sourcePath + MESH_CACHE_EXTENSION;
+    std::string canonical = meshcache::canonicalPath(sourcePath);
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "-%016llx", (unsigned long long)meshcache::hashBytes(canonical.data(), canonical.size()));
+    std::filesystem::path name = std::filesystem::path(sourcePath).filename();
+    return (std::filesystem::path(cacheDir) / (name.string() + suffix + MESH_CACHE_EXTENSION)).string();
+}
+
+// Mapeia o cache e valida cabeçalho, caminho de origem e dependências.
+// Retorna falso se o cache não existir ou estiver desatualizado.
+inline bool readMeshCache(const std::string& cachePath, const std::string& sourcePath,
+                          MappedFile& file, MeshCacheData& out) {
+    using namespace meshcache;
+
+    if (!file.open(cachePath) || file.size() < sizeof(Header)) return false;
+    Header header;
+    memcpy(&header, file.data(), sizeof(Header));
+    if (memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0 || header.version != MESH_CACHE_VERSION) {
+        return false;
+    }
+
+    const char* p = file.data() + sizeof(Header);
+    const char* end = file.data() + file.size();
+    std::string cachedSource;
+    if (!readString(p, end, cachedSource) || cachedSource != canonicalPath(sourcePath)) return false;
+    if (!readString(p, end, out.material.map_Kd_path)) return false;
+
+    for (uint32_t i = 0; i < header.dependencyCount; ++i) {
+        Dependency dep;
+        std::string depPath;
+        if (!readString(p, end, depPath) || end - p < (ptrdiff_t)sizeof(Dependency)) return false;
+        memcpy(&dep, p, sizeof(Dependency));
+        int64_t mtime = 0;
+        if (!dependencyIsFresh(depPath, dep, mtime)) return false;
+        if (mtime != dep.mtime) refreshDependencyTime(cachePath, (size_t)(p - file.data()), mtime);
+        p += sizeof(Dependency);
+    }
+
+    uint64_t dataBytes = header.vertexFloatCount * sizeof(float) + header.indexCount * sizeof(uint32_t);
+    if (header.dataOffset % 16 != 0 || header.dataOffset + dataBytes > file.size()) return false;
+
+    out.vertices = reinterpret_cast<const float*>(file.data() + header.dataOffset);
+    out.vertexFloatCount = header.vertexFloatCount;
+    out.indices = reinterpret_cast<const uint32_t*>(file.data() + header.dataOffset + header.vertexFloatCount * sizeof(float));
+    out.indexCount = header.indexCount;
+    out.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    out.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    out.material.Ka = glm::vec3(header.Ka[0], header.Ka[1], header.Ka[2]);
+    out.material.Kd = glm::vec3(header.Kd[0], header.Kd[1], header.Kd[2]);
+    out.material.Ks = glm::vec3(header.Ks[0], header.Ks[1], header.Ks[2]);
+    out.material.Ns = header.Ns;
+    out.material.hasTexture = header.hasTexture != 0;
+    return true;
+}
+
+// Grava o cache em um arquivo temporário e o renomeia no final, para que
+// uma gravação interrompida nunca deixe um cache corrompido no lugar.
+inline bool writeMeshCache(const std::string& cachePath, const std::string& sourcePath,
+                           const ObjMeshData& mesh, const MeshCacheMaterial& material) {
+    using namespace meshcache;
+
+    std::vector<std::string> depPaths = { sourcePath };
+    if (!mesh.mtlPath.empty()) depPaths.push_back(mesh.mtlPath);
+
+    std::vector<char> meta;
+    writeString(meta, canonicalPath(sourcePath));
+    writeString(meta, material.map_Kd_path);
+    for (const std::string& depPath : depPaths) {
+        Dependency dep;
+        if (!describeFile(depPath, dep)) return false;
+        writeString(meta, depPath);
+        meta.insert(meta.end(), (const char*)&dep, (const char*)&dep + sizeof(dep));
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+    header.version = MESH_CACHE_VERSION;
+    header.dependencyCount = (uint32_t)depPaths.size();
+    header.vertexFloatCount = mesh.vertices.size();
+    header.indexCount = mesh.indices.size();
+    header.dataOffset = (sizeof(Header) + meta.size() + 15) & ~(uint64_t)15;
+    for (int i = 0; i < 3; ++i) {
+        header.boundsMin[i] = mesh.boundsMin[i];
+        header.boundsMax[i] = mesh.boundsMax[i];
+        header.Ka[i] = material.Ka[i];
+        header.Kd[i] = material.Kd[i];
+        header.Ks[i] = material.Ks[i];
+    }
+    header.Ns = material.Ns;
+    header.hasTexture = material.hasTexture ? 1 : 0;
+
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(cachePath).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+    std::string tempPath = cachePath + ".tmp";
+    FILE* f = fopen(tempPath.c_str(), "wb");
+    if (!f) return false;
+    const char padding[16] = {};
+    size_t padBytes = header.dataOffset - sizeof(Header) - meta.size();
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(meta.data(), 1, meta.size(), f) == meta.size() &&
+              fwrite(padding, 1, padBytes, f) == padBytes &&
+              fwrite(mesh.vertices.data(), sizeof(float), mesh.vertices.size(), f) == mesh.vertices.size() &&
+              fwrite(mesh.indices.data(), sizeof(uint32_t), mesh.indices.size(), f) == mesh.indices.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::filesystem::remove(cachePath, ec);
+        std::filesystem::rename(tempPath, cachePath, ec);
+    }
+    return !ec;
+}
@@ -0,0 +1,641 @@
+#pragma once
+
+// Leitor de arquivos Wavefront .OBJ sem alocações por linha.
+// O arquivo é mapeado em memória e tokenizado no próprio buffer; números são
+// convertidos com std::from_chars. Não faz nenhuma chamada OpenGL.
+
+#include <cfloat>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ThreadPool.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Arquivo somente leitura mapeado em memória. No Windows o conteúdo é lido
+// de uma vez para um buffer (uma única alocação por arquivo).
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+        fallback.resize((size_t)file.tellg());
+        file.seekg(0);
+        file.read(fallback.data(), fallback.size());
+        ptr = fallback.data();
+        length = fallback.size();
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        length = (size_t)st.st_size;
+        if (length > 0) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                length = 0;
+                return false;
+            }
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            ptr = static_cast<const char*>(mapped);
+        }
+        ::close(fd);
+#endif
+        opened = true;
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        fallback.clear();
+        fallback.shrink_to_fit();
+#else
+        if (ptr && length > 0) munmap(const_cast<char*>(ptr), length);
+#endif
+        ptr = nullptr;
+        length = 0;
+        opened = false;
+    }
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return ptr; }
+    size_t size() const { return length; }
+
+private:
+    const char* ptr = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    std::vector<char> fallback;
+#endif
+};
+
+// Alocador que não inicializa os elementos em resize: o parse paralelo
+// preenche os buffers nas próprias threads, sem uma passada sequencial que
+// só escreveria zeros (e tocaria todas as páginas numa thread só).
+template <typename T>
+struct UninitializedAllocator : std::allocator<T> {
+    template <typename U> struct rebind { using other = UninitializedAllocator<U>; };
+    UninitializedAllocator() = default;
+    template <typename U> UninitializedAllocator(const UninitializedAllocator<U>&) {}
+    template <typename U> void construct(U* p) { ::new (static_cast<void*>(p)) U; }
+    template <typename U, typename... Args> void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+};
+
+template <typename T>
+using ObjBuffer = std::vector<T, UninitializedAllocator<T>>;
+
+// Resultado do parse: buffer intercalado de 8 floats por vértice
+// (posição xyz, normal xyz, uv) e índices prontos para VBO/EBO.
+struct ObjMeshData {
+    ObjBuffer<float> vertices;
+    ObjBuffer<uint32_t> indices;
+    glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+    glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+    std::string mtlPath = "";
+};
+
+namespace objparser {
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) ++p;
+    return p;
+}
+
+inline const char* tokenEnd(const char* p, const char* end) {
+    while (p < end && !isBlank(*p)) ++p;
+    return p;
+}
+
+inline const char* parseFloat(const char* p, const char* end, float& out) {
+    p = skipBlanks(p, end);
+    if (p < end && *p == '+') ++p;
+    return std::from_chars(p, end, out).ptr;
+}
+
+inline const char* parseVec3(const char* p, const char* end, glm::vec3& out) {
+    p = parseFloat(p, end, out.x);
+    p = parseFloat(p, end, out.y);
+    return parseFloat(p, end, out.z);
+}
+
+// Converte índice OBJ (1-based, negativo = relativo ao fim) para 0-based; -1 se ausente/inválido.
+inline int resolveIndex(const char* b, const char* e, size_t count) {
+    int value = 0;
+    auto res = std::from_chars(b, e, value);
+    if (res.ec != std::errc() || value == 0) return -1;
+    long long index = value > 0 ? (long long)value - 1 : (long long)count + value;
+    return (index >= 0 && index < (long long)count) ? (int)index : -1;
+}
+
+struct FaceCorner {
+    int v = -1;
+    int vt = -1;
+    int vn = -1;
+};
+
+// Separa um token "v", "v/vt", "v//vn" ou "v/vt/vn".
+inline FaceCorner parseCorner(const char* b, const char* e, size_t nV, size_t nVT, size_t nVN) {
+    FaceCorner corner;
+    const char* slash1 = static_cast<const char*>(memchr(b, '/', e - b));
+    if (!slash1) {
+        corner.v = resolveIndex(b, e, nV);
+        return corner;
+    }
+    corner.v = resolveIndex(b, slash1, nV);
+    const char* vtBegin = slash1 + 1;
+    const char* slash2 = static_cast<const char*>(memchr(vtBegin, '/', e - vtBegin));
+    const char* vtEnd = slash2 ? slash2 : e;
+    if (vtBegin < vtEnd) corner.vt = resolveIndex(vtBegin, vtEnd, nVT);
+    if (slash2 && slash2 + 1 < e) corner.vn = resolveIndex(slash2 + 1, e, nVN);
+    return corner;
+}
+
+// Tabela hash de endereçamento aberto (sondagem linear) que associa a trinca
+// (v, vt, vn) já resolvida ao índice do vértice no buffer final. Vértices
+// como "1/2/3" e "01/2/3" caem na mesma entrada.
+class CornerHashTable {
+public:
+    explicit CornerHashTable(size_t expected = 0) {
+        size_t capacity = 16;
+        while (capacity < expected * 2) capacity <<= 1;
+        slots.assign(capacity, Slot());
+    }
+
+    // Mesmo hash das sondagens; o parse paralelo usa os bits altos para
+    // escolher a partição de cada vértice.
+    static uint32_t hash(const FaceCorner& c) {
+        uint32_t h = (uint32_t)c.v * 0x9E3779B1u;
+        h ^= (uint32_t)c.vt * 0x85EBCA77u + (h << 6) + (h >> 2);
+        h ^= (uint32_t)c.vn * 0xC2B2AE3Du + (h << 6) + (h >> 2);
+        h ^= h >> 16;
+        h *= 0x7FEB352Du;
+        h ^= h >> 15;
+        return h;
+    }
+
+    // Retorna o índice associado a `corner`; se não existir, insere `value`.
+    // `inserted` indica se houve inserção.
+    uint32_t findOrInsert(const FaceCorner& corner, uint32_t value, bool& inserted) {
+        if ((count + 1) * 4 > slots.size() * 3) grow();
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(corner) & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            if (slot.value == EMPTY) {
+                slot.corner = corner;
+                slot.value = value;
+                count++;
+                inserted = true;
+                return value;
+            }
+            if (slot.corner.v == corner.v && slot.corner.vt == corner.vt && slot.corner.vn == corner.vn) {
+                inserted = false;
+                return slot.value;
+            }
+        }
+    }
+
+    size_t size() const { return count; }
+    size_t memoryBytes() const { return slots.size() * sizeof(Slot); }
+
+private:
+    static const uint32_t EMPTY = UINT32_MAX;
+
+    struct Slot {
+        FaceCorner corner;
+        uint32_t value = EMPTY;
+    };
+
+    void grow() {
+        std::vector<Slot> old(slots.size() * 2, Slot());
+        old.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.value == EMPTY) continue;
+            size_t i = hash(slot.corner) & mask;
+            while (slots[i].value != EMPTY) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+    }
+
+    std::vector<Slot> slots;
+    size_t count = 0;
+};
+
+inline void writeVertex(float* dst, const FaceCorner& c,
+                        const ObjBuffer<glm::vec3>& positions,
+                        const ObjBuffer<glm::vec2>& texCoords,
+                        const ObjBuffer<glm::vec3>& normals) {
+    glm::vec3 pos = c.v >= 0 ? positions[c.v] : glm::vec3(0.0f);
+    glm::vec3 normal = c.vn >= 0 ? normals[c.vn] : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec2 uv = c.vt >= 0 ? texCoords[c.vt] : glm::vec2(0.0f);
+    dst[0] = pos.x; dst[1] = pos.y; dst[2] = pos.z;
+    dst[3] = normal.x; dst[4] = normal.y; dst[5] = normal.z;
+    dst[6] = uv.x; dst[7] = uv.y;
+}
+
+inline void appendVertex(ObjBuffer<float>& out, const FaceCorner& c,
+                         const ObjBuffer<glm::vec3>& positions,
+                         const ObjBuffer<glm::vec2>& texCoords,
+                         const ObjBuffer<glm::vec3>& normals) {
+    out.resize(out.size() + 8);
+    writeVertex(out.data() + out.size() - 8, c, positions, texCoords, normals);
+}
+
+inline std::string directoryOf(const std::string& path) {
+    size_t lastSlash = path.find_last_of("\\/");
+    return (lastSlash == std::string::npos) ? "" : path.substr(0, lastSlash + 1);
+}
+
+enum class ObjRecord { Other, Position, TexCoord, Normal, Face, MtlLib };
+
+// Identifica o tipo da linha; `rest` aponta para logo após a palavra-chave.
+inline ObjRecord classifyLine(const char* lineBegin, const char* lineEnd, const char*& rest) {
+    const char* cur = skipBlanks(lineBegin, lineEnd);
+    rest = tokenEnd(cur, lineEnd);
+    std::string_view keyword(cur, rest - cur);
+    if (keyword == "v") return ObjRecord::Position;
+    if (keyword == "vt") return ObjRecord::TexCoord;
+    if (keyword == "vn") return ObjRecord::Normal;
+    if (keyword == "f") return ObjRecord::Face;
+    if (keyword == "mtllib") return ObjRecord::MtlLib;
+    return ObjRecord::Other;
+}
+
+// Retorna o início da próxima linha e o fim da linha atual em `lineEnd`.
+inline const char* nextLine(const char* p, const char* end, const char*& lineEnd) {
+    lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+    if (!lineEnd) lineEnd = end;
+    return lineEnd + 1;
+}
+
+// Lê os três primeiros vértices de uma face; retorna falso se houver menos de três.
+inline bool splitFaceTokens(const char* p, const char* lineEnd, std::string_view (&tokens)[3]) {
+    for (int i = 0; i < 3; ++i) {
+        const char* tokBegin = skipBlanks(p, lineEnd);
+        p = tokenEnd(tokBegin, lineEnd);
+        if (tokBegin == p) return false;
+        tokens[i] = std::string_view(tokBegin, p - tokBegin);
+    }
+    return true;
+}
+
+inline std::string_view mtlLibName(const char* rest, const char* lineEnd) {
+    const char* nameBegin = skipBlanks(rest, lineEnd);
+    return std::string_view(nameBegin, tokenEnd(nameBegin, lineEnd) - nameBegin);
+}
+
+} // namespace objparser
+
+// Faz o parse de um OBJ já em memória. Somente as três primeiras posições de
+// cada face são usadas (malhas trianguladas), como no carregador original.
+inline bool parseOBJ(const char* data, size_t size, const std::string& filePath, ObjMeshData& out) {
+    using namespace objparser;
+
+    ObjBuffer<glm::vec3> positions;
+    ObjBuffer<glm::vec2> texCoords;
+    ObjBuffer<glm::vec3> normals;
+    CornerHashTable cornerToIndex(size / 256);
+
+    out = ObjMeshData();
+    uint32_t nextIndex = 0;
+
+    const char* end = data + size;
+    for (const char* p = data, *next = nullptr; p < end; p = next) {
+        const char* lineEnd = nullptr;
+        const char* rest = nullptr;
+        next = nextLine(p, end, lineEnd);
+
+        switch (classifyLine(p, lineEnd, rest)) {
+        case ObjRecord::Position: {
+            glm::vec3 vert(0.0f);
+            parseVec3(rest, lineEnd, vert);
+            positions.push_back(vert);
+            out.boundsMin = glm::min(out.boundsMin, vert);
+            out.boundsMax = glm::max(out.boundsMax, vert);
+            break;
+        }
+        case ObjRecord::TexCoord: {
+            glm::vec2 tex(0.0f);
+            parseFloat(parseFloat(rest, lineEnd, tex.x), lineEnd, tex.y);
+            texCoords.push_back(tex);
+            break;
+        }
+        case ObjRecord::Normal: {
+            glm::vec3 norm(0.0f);
+            parseVec3(rest, lineEnd, norm);
+            normals.push_back(norm);
+            break;
+        }
+        case ObjRecord::Face: {
+            std::string_view tokens[3];
+            if (!splitFaceTokens(rest, lineEnd, tokens)) break;
+            for (const std::string_view& token : tokens) {
+                FaceCorner corner = parseCorner(token.data(), token.data() + token.size(),
+                                                positions.size(), texCoords.size(), normals.size());
+                bool inserted = false;
+                uint32_t index = cornerToIndex.findOrInsert(corner, nextIndex, inserted);
+                if (inserted) {
+                    appendVertex(out.vertices, corner, positions, texCoords, normals);
+                    nextIndex++;
+                }
+                out.indices.push_back(index);
+            }
+            break;
+        }
+        case ObjRecord::MtlLib:
+            out.mtlPath = directoryOf(filePath) + std::string(mtlLibName(rest, lineEnd));
+            break;
+        case ObjRecord::Other:
+            break;
+        }
+    }
+    return true;
+}
+
+namespace objparser {
+
+// Fatia do arquivo processada por uma tarefa do parse paralelo.
+struct ObjChunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+
+    size_t nPositions = 0, nTexCoords = 0, nNormals = 0;
+    size_t basePosition = 0, baseTexCoord = 0, baseNormal = 0;
+
+    std::vector<FaceCorner> uniqueCorners;
+    std::vector<uint32_t> localIndices;
+    size_t indexOffset = 0;
+
+    // Mesclagem: vértices únicos da fatia separados por partição do hash;
+    // remap[u] guarda primeiro a entrada na tabela da partição (com
+    // OWNER_BIT se esta é a primeira ocorrência no arquivo) e depois o
+    // índice global.
+    std::vector<std::vector<uint32_t>> byShard;
+    ObjBuffer<uint32_t> remap;
+    size_t ownedCount = 0;
+    size_t vertexOffset = 0;
+
+    glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+    glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+    std::string_view mtlLib;
+    bool hasMtlLib = false;
+};
+
+// Divide [data, data + size) em até `count` fatias terminando em '\n'.
+inline std::vector<ObjChunk> splitChunks(const char* data, size_t size, size_t count) {
+    std::vector<ObjChunk> chunks;
+    const char* end = data + size;
+    const char* p = data;
+    for (size_t i = 0; i < count && p < end; ++i) {
+        const char* target = (i + 1 == count) ? end : data + size * (i + 1) / count;
+        if (target < p) target = p;
+        const char* cut = (target < end) ? static_cast<const char*>(memchr(target, '\n', end - target)) : nullptr;
+        const char* chunkEnd = cut ? cut + 1 : end;
+        ObjChunk chunk;
+        chunk.begin = p;
+        chunk.end = chunkEnd;
+        chunks.push_back(std::move(chunk));
+        p = chunkEnd;
+    }
+    return chunks;
+}
+
+inline void countRecords(ObjChunk& chunk) {
+    for (const char* p = chunk.begin, *next = nullptr; p < chunk.end; p = next) {
+        const char* lineEnd = nullptr;
+        const char* rest = nullptr;
+        next = nextLine(p, chunk.end, lineEnd);
+        switch (classifyLine(p, lineEnd, rest)) {
+        case ObjRecord::Position: chunk.nPositions++; break;
+        case ObjRecord::TexCoord: chunk.nTexCoords++; break;
+        case ObjRecord::Normal: chunk.nNormals++; break;
+        default: break;
+        }
+    }
+}
+
+// Segunda passada: grava atributos nas posições globais da fatia e
+// deduplica os vértices das faces localmente. Os atributos chegam sem
+// inicializar e cada um é zerado antes do parse: um número inválido deixa a
+// coordenada em 0, como no leitor original com istringstream.
+inline void parseChunk(ObjChunk& chunk, ObjBuffer<glm::vec3>& positions,
+                       ObjBuffer<glm::vec2>& texCoords, ObjBuffer<glm::vec3>& normals) {
+    CornerHashTable cornerToLocal((chunk.end - chunk.begin) / 256);
+    size_t iV = chunk.basePosition, iVT = chunk.baseTexCoord, iVN = chunk.baseNormal;
+
+    for (const char* p = chunk.begin, *next = nullptr; p < chunk.end; p = next) {
+        const char* lineEnd = nullptr;
+        const char* rest = nullptr;
+        next = nextLine(p, chunk.end, lineEnd);
+
+        switch (classifyLine(p, lineEnd, rest)) {
+        case ObjRecord::Position: {
+            glm::vec3& vert = positions[iV++];
+            vert = glm::vec3(0.0f);
+            parseVec3(rest, lineEnd, vert);
+            chunk.boundsMin = glm::min(chunk.boundsMin, vert);
+            chunk.boundsMax = glm::max(chunk.boundsMax, vert);
+            break;
+        }
+        case ObjRecord::TexCoord: {
+            glm::vec2& tex = texCoords[iVT++];
+            tex = glm::vec2(0.0f);
+            parseFloat(parseFloat(rest, lineEnd, tex.x), lineEnd, tex.y);
+            break;
+        }
+        case ObjRecord::Normal: {
+            glm::vec3& norm = normals[iVN++];
+            norm = glm::vec3(0.0f);
+            parseVec3(rest, lineEnd, norm);
+            break;
+        }
+        case ObjRecord::Face: {
+            std::string_view tokens[3];
+            if (!splitFaceTokens(rest, lineEnd, tokens)) break;
+            for (const std::string_view& token : tokens) {
+                FaceCorner corner = parseCorner(token.data(), token.data() + token.size(), iV, iVT, iVN);
+                bool inserted = false;
+                uint32_t local = cornerToLocal.findOrInsert(corner, (uint32_t)chunk.uniqueCorners.size(), inserted);
+                if (inserted) chunk.uniqueCorners.push_back(corner);
+                chunk.localIndices.push_back(local);
+            }
+            break;
+        }
+        case ObjRecord::MtlLib:
+            chunk.mtlLib = mtlLibName(rest, lineEnd);
+            chunk.hasMtlLib = true;
+            break;
+        case ObjRecord::Other:
+            break;
+        }
+    }
+}
+
+} // namespace objparser
+
+// Tamanho mínimo de arquivo para valer a pena dividir o parse entre threads.
+const size_t OBJ_PARALLEL_MIN_BYTES = 1 << 20;
+
+// Parse paralelo em fatias alinhadas a linhas. O resultado é idêntico, byte a
+// byte, ao de parseOBJ: cada vértice recebe o índice da sua primeira
+// ocorrência no arquivo. A mesclagem também é paralela: os vértices únicos
+// de cada fatia são repartidos pelos bits altos do hash, cada partição
+// escolhe a primeira ocorrência (fatia, índice local) de cada trinca, e os
+// índices globais saem de uma soma de prefixo por fatia.
+inline bool parseOBJParallel(const char* data, size_t size, const std::string& filePath,
+                             ObjMeshData& out, ThreadPool& pool) {
+    using namespace objparser;
+    const uint32_t OWNER_BIT = 0x80000000u;
+
+    out = ObjMeshData();
+    std::vector<ObjChunk> chunks = splitChunks(data, size, (size_t)pool.size() * 4);
+
+    pool.parallelFor(chunks.size(), [&](size_t i) { countRecords(chunks[i]); });
+
+    size_t totalV = 0, totalVT = 0, totalVN = 0;
+    for (ObjChunk& chunk : chunks) {
+        chunk.basePosition = totalV;
+        chunk.baseTexCoord = totalVT;
+        chunk.baseNormal = totalVN;
+        totalV += chunk.nPositions;
+        totalVT += chunk.nTexCoords;
+        totalVN += chunk.nNormals;
+    }
+
+    ObjBuffer<glm::vec3> positions(totalV);
+    ObjBuffer<glm::vec2> texCoords(totalVT);
+    ObjBuffer<glm::vec3> normals(totalVN);
+    pool.parallelFor(chunks.size(), [&](size_t i) { parseChunk(chunks[i], positions, texCoords, normals); });
+
+    // Partições em potência de 2, algumas por thread para equilibrar a carga.
+    unsigned shardBits = 0;
+    while ((1u << shardBits) < pool.size() * 4 && shardBits < 8) shardBits++;
+    size_t shardCount = (size_t)1 << shardBits;
+    auto shardOf = [shardBits](const FaceCorner& corner) -> size_t {
+        return shardBits == 0 ? 0 : CornerHashTable::hash(corner) >> (32 - shardBits);
+    };
+
+    pool.parallelFor(chunks.size(), [&](size_t i) {
+        ObjChunk& chunk = chunks[i];
+        chunk.byShard.assign(shardCount, std::vector<uint32_t>());
+        chunk.remap.resize(chunk.uniqueCorners.size());
+        for (size_t u = 0; u < chunk.uniqueCorners.size(); ++u) {
+            chunk.byShard[shardOf(chunk.uniqueCorners[u])].push_back((uint32_t)u);
+        }
+    });
+
+    // Cada partição percorre as fatias em ordem; a primeira inserção de uma
+    // trinca é a sua primeira ocorrência no arquivo. Partições distintas
+    // escrevem entradas distintas de remap.
+    std::vector<ObjBuffer<uint32_t>> shardIndex(shardCount);
+    pool.parallelFor(shardCount, [&](size_t shard) {
+        size_t expected = 0;
+        for (const ObjChunk& chunk : chunks) expected += chunk.byShard[shard].size();
+        CornerHashTable cornerToEntry(expected);
+        uint32_t entries = 0;
+        for (ObjChunk& chunk : chunks) {
+            for (uint32_t u : chunk.byShard[shard]) {
+                bool inserted = false;
+                uint32_t entry = cornerToEntry.findOrInsert(chunk.uniqueCorners[u], entries, inserted);
+                if (inserted) entries++;
+                chunk.remap[u] = inserted ? entry | OWNER_BIT : entry;
+            }
+        }
+        shardIndex[shard].resize(entries);
+        for (ObjChunk& chunk : chunks) std::vector<uint32_t>().swap(chunk.byShard[shard]);
+    });
+
+    pool.parallelFor(chunks.size(), [&](size_t i) {
+        ObjChunk& chunk = chunks[i];
+        for (uint32_t entry : chunk.remap) chunk.ownedCount += (entry & OWNER_BIT) ? 1 : 0;
+    });
+
+    size_t totalVertices = 0, totalIndices = 0;
+    for (ObjChunk& chunk : chunks) {
+        chunk.vertexOffset = totalVertices;
+        chunk.indexOffset = totalIndices;
+        totalVertices += chunk.ownedCount;
+        totalIndices += chunk.localIndices.size();
+
+        out.boundsMin = glm::min(out.boundsMin, chunk.boundsMin);
+        out.boundsMax = glm::max(out.boundsMax, chunk.boundsMax);
+        if (chunk.hasMtlLib) out.mtlPath = directoryOf(filePath) + std::string(chunk.mtlLib);
+    }
+
+    // Sem inicialização: cada vértice e cada índice é escrito uma vez,
+    // pela thread da fatia que o produz.
+    out.vertices.resize(totalVertices * 8);
+    out.indices.resize(totalIndices);
+
+    // As primeiras ocorrências recebem os índices globais, em ordem dentro
+    // da fatia, e gravam o vértice.
+    pool.parallelFor(chunks.size(), [&](size_t i) {
+        ObjChunk& chunk = chunks[i];
+        uint32_t next = (uint32_t)chunk.vertexOffset;
+        for (size_t u = 0; u < chunk.uniqueCorners.size(); ++u) {
+            if (!(chunk.remap[u] & OWNER_BIT)) continue;
+            const FaceCorner& corner = chunk.uniqueCorners[u];
+            shardIndex[shardOf(corner)][chunk.remap[u] & ~OWNER_BIT] = next;
+            writeVertex(out.vertices.data() + (size_t)next * 8, corner, positions, texCoords, normals);
+            next++;
+        }
+    });
+
+    pool.parallelFor(chunks.size(), [&](size_t i) {
+        ObjChunk& chunk = chunks[i];
+        for (size_t u = 0; u < chunk.uniqueCorners.size(); ++u) {
+            chunk.remap[u] = shardIndex[shardOf(chunk.uniqueCorners[u])][chunk.remap[u] & ~OWNER_BIT];
+        }
+        uint32_t* dst = out.indices.data() + chunk.indexOffset;
+        for (size_t k = 0; k < chunk.localIndices.size(); ++k) {
+            dst[k] = chunk.remap[chunk.localIndices[k]];
+        }
+    });
+    return true;
+}
+
+// `pool`: threads do chamador para o parse paralelo, reaproveitadas entre
+// arquivos; nulo (ou com uma thread só) = parse sequencial. Arquivos
+// pequenos sempre usam o caminho sequencial.
+inline bool loadOBJData(const std::string& filePath, ObjMeshData& out, ThreadPool* pool = nullptr) {
+    MappedFile file(filePath);
+    if (!file.isOpen()) return false;
+    if (pool && pool->size() > 1 && file.size() >= OBJ_PARALLEL_MIN_BYTES) {
+        return parseOBJParallel(file.data(), file.size(), filePath, out, *pool);
+    }
+    return parseOBJ(file.data(), file.size(), filePath, out);
+}
@@ -0,0 +1,318 @@
+#pragma once
+
+// HUD de desempenho: fonte bitmap 5x7 embutida, atlas de glifos em um canal
+// (com uma célula branca para retângulos e barras), montagem de todos os
+// quads do quadro em um único vetor de vértices, séries dos gráficos de
+// tempo e os contadores que o laço de renderização alimenta (draws,
+// triângulos, memória de buffers e texturas). Não faz chamadas OpenGL; quem
+// envia o atlas e desenha os vértices é o chamador.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+// Glifos de ' ' (32) a '_' (95); minúsculas são desenhadas como maiúsculas.
+// Cada glifo tem 7 linhas de 5 bits, o bit 4 é a coluna da esquerda.
+const int HUD_GLYPH_WIDTH = 5;
+const int HUD_GLYPH_HEIGHT = 7;
+const int HUD_FIRST_GLYPH = 32;
+const int HUD_GLYPH_COUNT = 64;
+
+const uint8_t HUD_FONT[HUD_GLYPH_COUNT][HUD_GLYPH_HEIGHT] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // '!'
+    { 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '"'
+    { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A }, // '#'
+    { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 }, // '$'
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // '%'
+    { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D }, // '&'
+    { 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 }, // "'"
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // '('
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // ')'
+    { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 }, // '*'
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // '+'
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ','
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // '-'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // '.'
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // '/'
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // '0'
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // '1'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // '2'
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // '3'
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // '4'
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // '5'
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // '6'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // '7'
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // '8'
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // '9'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // ':'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 }, // ';'
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // '<'
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // '='
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // '>'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // '?'
+    { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E }, // '@'
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // 'A'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // 'B'
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // 'C'
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // 'D'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // 'E'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // 'F'
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // 'G'
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // 'H'
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 'I'
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // 'J'
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // 'K'
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // 'L'
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // 'M'
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // 'N'
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'O'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // 'P'
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // 'Q'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // 'R'
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // 'S'
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // 'T'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'U'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // 'V'
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // 'W'
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // 'X'
+    { 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04 }, // 'Y'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // 'Z'
+    { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E }, // '['
+    { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 }, // '\\'
+    { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E }, // ']'
+    { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 }, // '^'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // '_'
+};
+
+// Atlas de 16x5 células de 8x8: os 64 glifos nas 4 primeiras linhas e a
+// célula branca no início da quinta.
+const int HUD_ATLAS_CELL = 8;
+const int HUD_ATLAS_COLUMNS = 16;
+const int HUD_ATLAS_WIDTH = HUD_ATLAS_COLUMNS * HUD_ATLAS_CELL;
+const int HUD_ATLAS_HEIGHT = 5 * HUD_ATLAS_CELL;
+const int HUD_SOLID_CELL = HUD_GLYPH_COUNT;
+
+// Texels do atlas (um byte por texel, linha 0 em cima), prontos para uma
+// textura GL_R8 com filtro GL_NEAREST.
+inline std::vector<uint8_t> buildHudAtlas() {
+    std::vector<uint8_t> pixels(HUD_ATLAS_WIDTH * HUD_ATLAS_HEIGHT, 0);
+    for (int glyph = 0; glyph < HUD_GLYPH_COUNT; ++glyph) {
+        int cellX = (glyph % HUD_ATLAS_COLUMNS) * HUD_ATLAS_CELL;
+        int cellY = (glyph / HUD_ATLAS_COLUMNS) * HUD_ATLAS_CELL;
+        for (int row = 0; row < HUD_GLYPH_HEIGHT; ++row) {
+            for (int column = 0; column < HUD_GLYPH_WIDTH; ++column) {
+                if (HUD_FONT[glyph][row] & (0x10 >> column)) {
+                    pixels[(cellY + row) * HUD_ATLAS_WIDTH + cellX + column] = 255;
+                }
+            }
+        }
+    }
+    int solidX = (HUD_SOLID_CELL % HUD_ATLAS_COLUMNS) * HUD_ATLAS_CELL;
+    int solidY = (HUD_SOLID_CELL / HUD_ATLAS_COLUMNS) * HUD_ATLAS_CELL;
+    for (int y = 0; y < HUD_ATLAS_CELL; ++y) {
+        for (int x = 0; x < HUD_ATLAS_CELL; ++x) pixels[(solidY + y) * HUD_ATLAS_WIDTH + solidX + x] = 255;
+    }
+    return pixels;
+}
+
+inline int hudGlyphIndex(char c) {
+    if (c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+    int index = (unsigned char)c - HUD_FIRST_GLYPH;
+    return (index >= 0 && index < HUD_GLYPH_COUNT) ? index : '?' - HUD_FIRST_GLYPH;
+}
+
+// Cor RGBA8 na ordem dos bytes na memória (R no primeiro), lida no vertex
+// shader como vec4 normalizado.
+inline uint32_t hudColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+    return (uint32_t)r | (uint32_t)g << 8 | (uint32_t)b << 16 | (uint32_t)a << 24;
+}
+
+// Posição em pixels com a origem no canto superior esquerdo da tela e
+// coordenada de textura normalizada no atlas.
+struct HudVertex {
+    float x, y;
+    float u, v;
+    uint32_t color;
+};
+
+// Valores mais recentes de uma medida, do mais antigo ao mais novo.
+class HudSeries {
+public:
+    explicit HudSeries(size_t capacity = 120) : values(std::max<size_t>(1, capacity), 0.0f) {}
+
+    void push(float value) {
+        values[next] = value;
+        next = (next + 1) % values.size();
+        filled = std::min(filled + 1, values.size());
+    }
+
+    size_t size() const { return filled; }
+    size_t capacity() const { return values.size(); }
+    float operator[](size_t i) const { return values[(next + values.size() - filled + i) % values.size()]; }
+    float latest() const { return filled ? (*this)[filled - 1] : 0.0f; }
+
+    float max() const {
+        float result = 0.0f;
+        for (size_t i = 0; i < filled; ++i) result = std::max(result, (*this)[i]);
+        return result;
+    }
+
+    float average() const {
+        float total = 0.0f;
+        for (size_t i = 0; i < filled; ++i) total += (*this)[i];
+        return filled ? total / filled : 0.0f;
+    }
+
+private:
+    std::vector<float> values;
+    size_t next = 0;
+    size_t filled = 0;
+};
+
+// Todos os quads do HUD de um quadro, em triângulos soltos (6 vértices por
+// quad), para um único glDrawArrays com o atlas ligado.
+class HudBatch {
+public:
+    void clear() { vertexData.clear(); }
+    const std::vector<HudVertex>& vertices() const { return vertexData; }
+    size_t quadCount() const { return vertexData.size() / 6; }
+
+    void rect(float x, float y, float width, float height, uint32_t color) {
+        float u = (cellX(HUD_SOLID_CELL) + 0.5f * HUD_ATLAS_CELL) / HUD_ATLAS_WIDTH;
+        float v = (cellY(HUD_SOLID_CELL) + 0.5f * HUD_ATLAS_CELL) / HUD_ATLAS_HEIGHT;
+        quad(x, y, x + width, y + height, u, v, u, v, color);
+    }
+
+    // Escreve `text` com cada texel do glifo virando `scale` pixels e
+    // devolve o x onde o próximo caractere começaria. '\n' não é tratado.
+    float text(float x, float y, const char* text, uint32_t color, float scale = 2.0f) {
+        for (const char* c = text; *c; ++c) {
+            if (*c != ' ') {
+                int glyph = hudGlyphIndex(*c);
+                float u0 = (float)cellX(glyph) / HUD_ATLAS_WIDTH;
+                float v0 = (float)cellY(glyph) / HUD_ATLAS_HEIGHT;
+                float u1 = (float)(cellX(glyph) + HUD_GLYPH_WIDTH) / HUD_ATLAS_WIDTH;
+                float v1 = (float)(cellY(glyph) + HUD_GLYPH_HEIGHT) / HUD_ATLAS_HEIGHT;
+                quad(x, y, x + HUD_GLYPH_WIDTH * scale, y + HUD_GLYPH_HEIGHT * scale, u0, v0, u1, v1, color);
+            }
+            x += advance(scale);
+        }
+        return x;
+    }
+
+    // Uma barra por amostra, da mais antiga (à esquerda) à mais nova, com a
+    // altura proporcional a `maxValue`; valores negativos ficam sem barra.
+    // `reference` desenha uma linha horizontal no valor dado (0 = nenhuma).
+    void graph(float x, float y, float width, float height, const HudSeries& series, float maxValue, uint32_t color,
+               uint32_t background, float reference = 0.0f, uint32_t referenceColor = 0) {
+        rect(x, y, width, height, background);
+        if (maxValue <= 0.0f || series.capacity() == 0) return;
+        float barWidth = width / series.capacity();
+        float start = x + width - barWidth * series.size();
+        for (size_t i = 0; i < series.size(); ++i) {
+            float value = series[i];
+            if (value <= 0.0f) continue;
+            float barHeight = std::min(height, height * value / maxValue);
+            rect(start + i * barWidth, y + height - barHeight, barWidth, barHeight, color);
+        }
+        if (reference > 0.0f && reference < maxValue) {
+            rect(x, y + height - height * reference / maxValue, width, 1.0f, referenceColor);
+        }
+    }
+
+    static float advance(float scale) { return (HUD_GLYPH_WIDTH + 1) * scale; }
+    static float lineHeight(float scale) { return (HUD_GLYPH_HEIGHT + 3) * scale; }
+
+private:
+    static int cellX(int cell) { return (cell % HUD_ATLAS_COLUMNS) * HUD_ATLAS_CELL; }
+    static int cellY(int cell) { return (cell / HUD_ATLAS_COLUMNS) * HUD_ATLAS_CELL; }
+
+    void quad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, uint32_t color) {
+        HudVertex a = { x0, y0, u0, v0, color };
+        HudVertex b = { x1, y0, u1, v0, color };
+        HudVertex c = { x1, y1, u1, v1, color };
+        HudVertex d = { x0, y1, u0, v1, color };
+        vertexData.insert(vertexData.end(), { a, b, c, a, c, d });
+    }
+
+    std::vector<HudVertex> vertexData;
+};
+
+// Contadores de um quadro. Os triângulos enviados somam todos os passes
+// (pré-passe e passe opaco contam cada um); os descartados são os dos
+// objetos que o culling na CPU tirou do quadro. Com o culling na GPU a CPU
+// não sabe quantos triângulos sobram sem ler os comandos de volta, então o
+// quadro fica marcado como decidido na GPU.
+struct RenderCounters {
+    size_t drawCalls = 0;
+    uint64_t trianglesSubmitted = 0;
+    uint64_t trianglesCulled = 0;
+    bool gpuDriven = false;
+
+    void reset() { *this = RenderCounters(); }
+
+    void addDraw(uint64_t triangles = 0) {
+        drawCalls++;
+        trianglesSubmitted += triangles;
+    }
+};
+
+enum GpuMemoryKind { GPU_MEMORY_BUFFER = 0, GPU_MEMORY_TEXTURE = 1 };
+
+// Bytes alocados na GPU por nome de objeto GL, estimados pelos tamanhos
+// passados a glBufferData/glTexImage2D/glRenderbufferStorage. Renderbuffers
+// contam como texturas. Registrar de novo o mesmo nome substitui o tamanho.
+class GpuMemoryCounter {
+public:
+    void set(GpuMemoryKind kind, uint32_t name, uint64_t bytes) {
+        if (name == 0) return;
+        uint64_t& entry = sizes[key(kind, name)];
+        totals[kind] += bytes - entry;
+        entry = bytes;
+    }
+
+    void release(GpuMemoryKind kind, uint32_t name) {
+        auto it = sizes.find(key(kind, name));
+        if (it == sizes.end()) return;
+        totals[kind] -= it->second;
+        sizes.erase(it);
+    }
+
+    uint64_t total(GpuMemoryKind kind) const { return totals[kind]; }
+    size_t objectCount() const { return sizes.size(); }
+
+private:
+    static uint64_t key(GpuMemoryKind kind, uint32_t name) { return (uint64_t)kind << 32 | name; }
+
+    std::unordered_map<uint64_t, uint64_t> sizes;
+    uint64_t totals[2] = { 0, 0 };
+};
+
+// Bytes de uma textura 2D com todos os níveis de mipmap até 1x1.
+inline uint64_t mipmappedTextureBytes(int width, int height, int bytesPerTexel) {
+    uint64_t total = 0;
+    while (true) {
+        total += (uint64_t)width * height * bytesPerTexel;
+        if (width == 1 && height == 1) break;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return total;
+}
+
+// "12.3 MB", "850 KB": a unidade muda quando o valor passa de 1024.
+inline void formatHudBytes(char* out, size_t size, uint64_t bytes) {
+    if (bytes >= 1024ull * 1024ull) snprintf(out, size, "%.1f MB", bytes / (1024.0 * 1024.0));
+    else if (bytes >= 1024ull) snprintf(out, size, "%.1f KB", bytes / 1024.0);
+    else snprintf(out, size, "%llu B", (unsigned long long)bytes);
+}
+
+// "1.25M", "830K", "512": contagens grandes abreviadas.
+inline void formatHudCount(char* out, size_t size, uint64_t count) {
+    if (count >= 1000000ull) snprintf(out, size, "%.2fM", count / 1e6);
+    else if (count >= 10000ull) snprintf(out, size, "%.0fK", count / 1e3);
+    else snprintf(out, size, "%llu", (unsigned long long)count);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+// Cache em disco (.progbin) dos programas de shader já linkados, no formato
+// devolvido por glGetProgramBinary. A chave combina o hash de todos os
+// trechos de código do programa com o fabricante, o renderer e a versão do
+// driver: qualquer mudança em um deles invalida o binário. Não faz chamadas
+// OpenGL; quem lê e grava os binários no GL é o chamador.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "MeshCache.h"
+
+const char PROGRAM_CACHE_MAGIC[8] = { 'P', 'R', 'O', 'G', 'B', 'I', 'N', '\0' };
+const uint32_t PROGRAM_CACHE_VERSION = 1;
+const char* const PROGRAM_CACHE_EXTENSION = ".progbin";
+
+namespace programcache {
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t binaryFormat;
+    uint64_t key;
+    uint64_t binarySize;
+};
+
+} // namespace programcache
+
+// `sources` são os trechos de todos os estágios, na ordem de compilação;
+// `driver` identifica o driver (GL_VENDOR, GL_RENDERER e GL_VERSION).
+inline uint64_t programCacheKey(const std::vector<const char*>& sources, const std::string& driver) {
+    uint64_t key = meshcache::hashBytes(driver.data(), driver.size());
+    for (const char* source : sources) {
+        key = meshcache::fmix(meshcache::rotl(key, 29) ^ meshcache::hashBytes(source, strlen(source)));
+    }
+    return key;
+}
+
+inline std::string programCachePath(const std::string& cacheDir, const std::string& programName) {
+    return (std::filesystem::path(cacheDir) / (programName + PROGRAM_CACHE_EXTENSION)).string();
+}
+
+// Lê o binário gravado para `key`. Retorna falso se o arquivo não existir,
+// estiver truncado ou tiver sido gravado para outra chave.
+inline bool readProgramCache(const std::string& cachePath, uint64_t key, uint32_t& binaryFormat, std::vector<char>& binary) {
+    using namespace programcache;
+
+    MappedFile file(cachePath);
+    if (!file.isOpen() || file.size() < sizeof(Header)) return false;
+    Header header;
+    memcpy(&header, file.data(), sizeof(Header));
+    if (memcmp(header.magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC)) != 0 ||
+        header.version != PROGRAM_CACHE_VERSION || header.key != key) {
+        return false;
+    }
+    if (header.binarySize == 0 || sizeof(Header) + header.binarySize != file.size()) return false;
+    binaryFormat = header.binaryFormat;
+    binary.assign(file.data() + sizeof(Header), file.data() + file.size());
+    return true;
+}
+
+// Grava em um arquivo temporário e renomeia, como writeMeshCache.
+inline bool writeProgramCache(const std::string& cachePath, uint64_t key, uint32_t binaryFormat, const std::vector<char>& binary) {
+    using namespace programcache;
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC));
+    header.version = PROGRAM_CACHE_VERSION;
+    header.binaryFormat = binaryFormat;
+    header.key = key;
+    header.binarySize = binary.size();
+
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(cachePath).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+    std::string tempPath = cachePath + ".tmp";
+    FILE* f = fopen(tempPath.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(binary.data(), 1, binary.size(), f) == binary.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::filesystem::remove(cachePath, ec);
+        std::filesystem::rename(tempPath, cachePath, ec);
+    }
+    return !ec;
+}
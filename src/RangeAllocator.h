@@ -0,0 +1,70 @@
+#pragma once
+
+// Suballocador de intervalos [offset, offset + size) dentro de um buffer
+// maior, com lista de blocos livres ordenada por offset (first-fit) e fusão
+// de vizinhos na liberação. Não faz chamadas OpenGL: quem usa decide o que
+// fazer quando falta espaço (tipicamente crescer o buffer e chamar grow()).
+
+#include <cstddef>
+#include <iterator>
+#include <map>
+
+class RangeAllocator {
+public:
+    static const size_t INVALID = (size_t)-1;
+
+    explicit RangeAllocator(size_t capacity = 0) { grow(capacity); }
+
+    size_t capacity() const { return total; }
+    size_t used() const { return inUse; }
+
+    // Devolve o offset do intervalo ou INVALID se não houver bloco livre
+    // grande o bastante.
+    size_t allocate(size_t size) {
+        if (size == 0) return INVALID;
+        for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+            if (it->second < size) continue;
+            size_t offset = it->first;
+            size_t remaining = it->second - size;
+            freeBlocks.erase(it);
+            if (remaining > 0) freeBlocks.emplace(offset + size, remaining);
+            inUse += size;
+            return offset;
+        }
+        return INVALID;
+    }
+
+    void free(size_t offset, size_t size) {
+        if (offset == INVALID || size == 0) return;
+        inUse -= size;
+        auto next = freeBlocks.lower_bound(offset);
+        if (next != freeBlocks.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset) {
+                offset = prev->first;
+                size += prev->second;
+                freeBlocks.erase(prev);
+            }
+        }
+        if (next != freeBlocks.end() && offset + size == next->first) {
+            size += next->second;
+            freeBlocks.erase(next);
+        }
+        freeBlocks.emplace(offset, size);
+    }
+
+    // Aumenta a capacidade; o espaço novo entra no fim da lista de livres.
+    void grow(size_t newCapacity) {
+        if (newCapacity <= total) return;
+        size_t added = newCapacity - total;
+        size_t offset = total;
+        total = newCapacity;
+        inUse += added;
+        free(offset, added);
+    }
+
+private:
+    std::map<size_t, size_t> freeBlocks;
+    size_t total = 0;
+    size_t inUse = 0;
+};
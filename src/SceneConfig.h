@@ -0,0 +1,158 @@
+#pragma once
+
+// Leitura do arquivo de configuração de cena (scene_config.txt) sem efeitos
+// colaterais: as opções, as luzes e os objetos ficam em um SceneConfig, e o
+// Final aplica o resultado (globais de renderização, câmera e carregamento
+// das malhas). Não faz chamadas OpenGL.
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "SceneData.h"
+
+inline std::string trim(const std::string& str) {
+    size_t first = str.find_first_not_of(' ');
+    if (std::string::npos == first) {
+        return str;
+    }
+    size_t last = str.find_last_not_of(' ');
+    return str.substr(first, (last - first + 1));
+}
+
+inline std::vector<std::string> split(const std::string& str, char delimiter) {
+    std::vector<std::string> tokens;
+    std::stringstream ss(str);
+    std::string token;
+    while (getline(ss, token, delimiter)) {
+        tokens.push_back(trim(token));
+    }
+    return tokens;
+}
+
+// "x, y, z"; falso com menos de três coordenadas.
+inline bool parseConfigVec3(const std::string& value, glm::vec3& out) {
+    std::vector<std::string> coords = split(value, ',');
+    if (coords.size() < 3) return false;
+    out = glm::vec3(std::stof(coords[0]), std::stof(coords[1]), std::stof(coords[2]));
+    return true;
+}
+
+// Uma linha "chave = valor" das seções de opções ([render], [loader],
+// [profiler], [headless], [camera] e outras que o Final reconheça).
+struct SceneSetting {
+    std::string section;
+    std::string key;
+    std::string value;
+};
+
+// Um bloco da seção [objects], até o "end". A rotação já está em radianos.
+struct SceneObjectConfig {
+    std::string name = "";
+    std::string file = "";
+    Transform transform;
+    Trajectory trajectory;
+    int instanceCount = 1;
+    float instanceSpacing = 2.5f;
+    bool occluder = false;
+};
+
+struct SceneConfig {
+    std::vector<SceneSetting> settings;
+    std::vector<Light> lights;
+    std::vector<SceneObjectConfig> objects;
+};
+
+// Uma luz só entra com "position" antes do "end" e um objeto só com
+// "name"; blocos incompletos são descartados. Opções ficam na ordem do
+// arquivo.
+inline bool parseSceneConfig(const std::string& configPath, SceneConfig& out) {
+    std::ifstream file(configPath);
+    if (!file.is_open()) {
+        std::cerr << "Erro ao abrir arquivo de configuracao: " << configPath << std::endl;
+        return false;
+    }
+
+    out = SceneConfig();
+    std::string line;
+    std::string currentSection = "";
+    Light currentLight;
+    bool lightInProgress = false;
+    SceneObjectConfig currentObject;
+    bool objectInProgress = false;
+
+    while (getline(file, line)) {
+        line = trim(line);
+
+        if (line.empty() || line[0] == '#') continue;
+
+        if (line[0] == '[' && line.back() == ']') {
+            currentSection = line.substr(1, line.length() - 2);
+            continue;
+        }
+
+        size_t equalPos = line.find('=');
+        if (equalPos == std::string::npos) continue;
+
+        std::string key = trim(line.substr(0, equalPos));
+        std::string value = trim(line.substr(equalPos + 1));
+
+        if (currentSection == "lights") {
+            if (key == "position") {
+                if (parseConfigVec3(value, currentLight.position)) lightInProgress = true;
+            } else if (key == "ambient") {
+                parseConfigVec3(value, currentLight.ambient);
+            } else if (key == "diffuse") {
+                parseConfigVec3(value, currentLight.diffuse);
+            } else if (key == "specular") {
+                parseConfigVec3(value, currentLight.specular);
+            } else if (key == "intensity") {
+                currentLight.intensity = std::stof(value);
+            } else if (key == "enabled") {
+                currentLight.enabled = (value == "true" || value == "1");
+            } else if (key == "end") {
+                if (lightInProgress) out.lights.push_back(currentLight);
+                currentLight = Light();
+                lightInProgress = false;
+            }
+        } else if (currentSection == "objects") {
+            glm::vec3 vector;
+            if (key == "name") {
+                currentObject.name = value;
+                objectInProgress = true;
+            } else if (key == "file") {
+                currentObject.file = value;
+            } else if (key == "translation") {
+                if (parseConfigVec3(value, vector)) currentObject.transform.setTranslation(vector);
+            } else if (key == "rotation") {
+                if (parseConfigVec3(value, vector)) currentObject.transform.setRotation(glm::radians(vector));
+            } else if (key == "scale") {
+                currentObject.transform.setScale(std::stof(value));
+            } else if (key == "trajectory_points") {
+                for (const std::string& pointStr : split(value, ';')) {
+                    if (parseConfigVec3(pointStr, vector)) currentObject.trajectory.addPoint(vector);
+                }
+            } else if (key == "trajectory_speed") {
+                currentObject.trajectory.speed = std::stof(value);
+            } else if (key == "instances") {
+                currentObject.instanceCount = std::max(1, std::stoi(value));
+            } else if (key == "instance_spacing") {
+                currentObject.instanceSpacing = std::stof(value);
+            } else if (key == "occluder") {
+                currentObject.occluder = (value == "true" || value == "1");
+            } else if (key == "end") {
+                if (objectInProgress) out.objects.push_back(currentObject);
+                currentObject = SceneObjectConfig();
+                objectInProgress = false;
+            }
+        } else {
+            out.settings.push_back({ currentSection, key, value });
+        }
+    }
+    return true;
+}
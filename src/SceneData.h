@@ -0,0 +1,259 @@
+#pragma once
+
+// Dados de cena sem OpenGL: trajetórias, transformações com as matrizes em
+// cache, material e luz, a leitura do MTL e a preparação da geometria de um
+// OBJ (do cache binário ou do parse) antes do envio à GPU. O Final só faz
+// o envio; os benchmarks usam o resto sem contexto.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "MeshCache.h"
+#include "ObjParser.h"
+
+struct TrajectoryPoint {
+    glm::vec3 position;
+    TrajectoryPoint(glm::vec3 pos) : position(pos) {}
+};
+
+struct Trajectory {
+    std::vector<TrajectoryPoint> points;
+    int currentPointIndex = 0;
+    float t = 0.0f;
+    float speed = 2.0f;
+    bool isActive = false;
+    
+    void addPoint(glm::vec3 point) {
+        points.push_back(TrajectoryPoint(point));
+        if (points.size() >= 2) {
+            isActive = true;
+        }
+    }
+    
+    glm::vec3 getCurrentPosition(float deltaTime) {
+        if (points.empty()) return glm::vec3(0.0f);
+        if (points.size() == 1) return points[0].position;
+        
+        int nextIndex = (currentPointIndex + 1) % points.size();
+        float segmentDistance = glm::distance(points[currentPointIndex].position, points[nextIndex].position);
+        
+        float tIncrement = (segmentDistance > 0.0f) ? (speed * deltaTime) / segmentDistance : 1.0f;
+        
+        t += tIncrement;
+        
+        if (t >= 1.0f) {
+            t = 0.0f;
+            currentPointIndex = (currentPointIndex + 1) % points.size();
+        }
+        
+        nextIndex = (currentPointIndex + 1) % points.size();
+        return glm::mix(points[currentPointIndex].position, points[nextIndex].position, t);
+    }
+    
+    void clear() {
+        points.clear();
+        currentPointIndex = 0;
+        t = 0.0f;
+        isActive = false;
+    }
+};
+
+// Posição, rotação (radianos, aplicada na ordem X, Y, Z) e escala uniforme
+// de um objeto. As matrizes model e normal ficam em cache e só são
+// recalculadas quando algum componente muda.
+class Transform {
+public:
+    const glm::vec3& getTranslation() const { return translation; }
+    const glm::vec3& getRotation() const { return rotation; }
+    float getScale() const { return scale; }
+
+    void setTranslation(const glm::vec3& value) { translation = value; dirty = true; }
+    void setRotation(const glm::vec3& value) { rotation = value; dirty = true; }
+    void setScale(float value) { scale = value; dirty = true; }
+    void translate(const glm::vec3& delta) { setTranslation(translation + delta); }
+    void rotate(const glm::vec3& delta) { setRotation(rotation + delta); }
+
+    const glm::mat4& getModelMatrix() {
+        if (dirty) update();
+        return modelMatrix;
+    }
+
+    const glm::mat3& getNormalMatrix() {
+        if (dirty) update();
+        return normalMatrix;
+    }
+
+private:
+    // Com escala uniforme, transpose(inverse(R * s)) = R / s; como o shader
+    // normaliza a normal, basta a parte de rotação (com o sinal de s).
+    void update() {
+        glm::mat4 rotationMatrix = glm::rotate(glm::mat4(1.0f), rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
+        rotationMatrix = glm::rotate(rotationMatrix, rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
+        rotationMatrix = glm::rotate(rotationMatrix, rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
+        glm::mat3 linear = glm::mat3(rotationMatrix);
+
+        modelMatrix = glm::mat4(linear * scale);
+        modelMatrix[3] = glm::vec4(translation, 1.0f);
+        normalMatrix = scale < 0.0f ? linear * -1.0f : linear;
+        dirty = false;
+    }
+
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f);
+    float scale = 1.0f;
+    glm::mat4 modelMatrix = glm::mat4(1.0f);
+    glm::mat3 normalMatrix = glm::mat3(1.0f);
+    bool dirty = true;
+};
+
+struct Material {
+    glm::vec3 Ka = glm::vec3(0.1f);
+    glm::vec3 Kd = glm::vec3(0.7f);
+    glm::vec3 Ks = glm::vec3(0.2f);
+    float Ns = 32.0f;
+    std::string map_Kd_path = "";
+    bool hasTexture = false;
+};
+
+struct Light {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 ambient = glm::vec3(0.2f);
+    glm::vec3 diffuse = glm::vec3(0.8f);
+    glm::vec3 specular = glm::vec3(1.0f);
+    bool enabled = true;
+    float intensity = 1.0f;
+};
+
+inline Material loadMTL(const std::string& mtlPath) {
+    Material material;
+    std::ifstream file(mtlPath);
+    if (!file.is_open()) {
+        std::cerr << "Erro ao abrir MTL: " << mtlPath << std::endl;
+        return material;
+    }
+
+    std::string line;
+    while (getline(file, line)) {
+        std::istringstream ss(line);
+        std::string word;
+        ss >> word;
+
+        if (word == "Ka") {
+            ss >> material.Ka.r >> material.Ka.g >> material.Ka.b;
+        } else if (word == "Kd") {
+            ss >> material.Kd.r >> material.Kd.g >> material.Kd.b;
+        } else if (word == "Ks") {
+            ss >> material.Ks.r >> material.Ks.g >> material.Ks.b;
+        } else if (word == "Ns") {
+            ss >> material.Ns;
+        } else if (word == "map_Kd") {
+            std::string textureFile;
+            ss >> textureFile;
+            size_t lastSlash = mtlPath.find_last_of("\\/");
+            std::string basePath = (lastSlash == std::string::npos) ? "" : mtlPath.substr(0, lastSlash + 1);
+            material.map_Kd_path = basePath + textureFile;
+            material.hasTexture = true;
+        }
+    }
+    file.close();
+    return material;
+}
+
+// Opções de carregamento das malhas (seção [loader]). O pool é do chamador
+// e serve a todos os arquivos da cena; nulo = parse sequencial.
+struct MeshLoadOptions {
+    bool cache = true;
+    std::string cacheDir = "";
+    ThreadPool* pool = nullptr;
+};
+
+// Geometria e material de um OBJ prontos para o envio: 8 floats por vértice
+// e índices, como em ObjMeshData. Os ponteiros apontam para `cacheFile`
+// (cache válido) ou para `parsed` e valem enquanto a MeshSource existir.
+struct MeshSource {
+    MappedFile cacheFile;
+    ObjMeshData parsed;
+    const float* vertices = nullptr;
+    size_t vertexFloatCount = 0;
+    const uint32_t* indices = nullptr;
+    size_t indexCount = 0;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    Material material;
+    bool fromCache = false;
+    // Tempos em ms: leitura do cache ou parse do OBJ, parse do MTL e
+    // gravação do cache.
+    double readMs = 0.0;
+    double materialMs = 0.0;
+    double cacheWriteMs = 0.0;
+};
+
+inline double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Lê o cache binário da malha ou, sem cache válido, faz o parse do OBJ e do
+// MTL e grava o cache para a próxima execução.
+inline bool loadMeshSource(const std::string& filePath, const MeshLoadOptions& options, MeshSource& out) {
+    std::string cachePath = options.cache ? meshCachePath(filePath, options.cacheDir) : "";
+    auto start = std::chrono::steady_clock::now();
+
+    MeshCacheData cached;
+    if (options.cache && readMeshCache(cachePath, filePath, out.cacheFile, cached)) {
+        out.vertices = cached.vertices;
+        out.vertexFloatCount = cached.vertexFloatCount;
+        out.indices = cached.indices;
+        out.indexCount = cached.indexCount;
+        out.boundsMin = cached.boundsMin;
+        out.boundsMax = cached.boundsMax;
+        out.material.Ka = cached.material.Ka;
+        out.material.Kd = cached.material.Kd;
+        out.material.Ks = cached.material.Ks;
+        out.material.Ns = cached.material.Ns;
+        out.material.map_Kd_path = cached.material.map_Kd_path;
+        out.material.hasTexture = cached.material.hasTexture;
+        out.fromCache = true;
+        out.readMs = millisecondsSince(start);
+        return true;
+    }
+
+    if (!loadOBJData(filePath, out.parsed, options.pool)) {
+        std::cerr << "Erro ao abrir OBJ: " << filePath << std::endl;
+        return false;
+    }
+    out.readMs = millisecondsSince(start);
+    const ObjMeshData& objData = out.parsed;
+    out.vertices = objData.vertices.data();
+    out.vertexFloatCount = objData.vertices.size();
+    out.indices = objData.indices.data();
+    out.indexCount = objData.indices.size();
+    out.boundsMin = objData.boundsMin;
+    out.boundsMax = objData.boundsMax;
+    start = std::chrono::steady_clock::now();
+    out.material = objData.mtlPath.empty() ? Material() : loadMTL(objData.mtlPath);
+    out.materialMs = millisecondsSince(start);
+    out.fromCache = false;
+
+    if (options.cache) {
+        start = std::chrono::steady_clock::now();
+        MeshCacheMaterial cacheMaterial;
+        cacheMaterial.Ka = out.material.Ka;
+        cacheMaterial.Kd = out.material.Kd;
+        cacheMaterial.Ks = out.material.Ks;
+        cacheMaterial.Ns = out.material.Ns;
+        cacheMaterial.map_Kd_path = out.material.map_Kd_path;
+        cacheMaterial.hasTexture = out.material.hasTexture;
+        if (!writeMeshCache(cachePath, filePath, objData, cacheMaterial)) {
+            std::cerr << "Aviso: nao foi possivel gravar o cache da malha: " << cachePath << std::endl;
+        }
+        out.cacheWriteMs = millisecondsSince(start);
+    }
+    return true;
+}
@@ -0,0 +1,335 @@
+#pragma once
+
+// Culling por oclusão na CPU, no estilo "masked software occlusion culling"
+// (Andersson et al., 2015). Malhas marcadas como oclusoras são rasterizadas
+// em um buffer de profundidade de baixa resolução dividido em blocos de 8x4
+// pixels. Cada bloco guarda só uma máscara de cobertura de 32 bits e duas
+// profundidades máximas: zMax0 vale para o bloco inteiro e zMax1 para os
+// pixels da máscara (a camada de trabalho). Depois as caixas envolventes dos
+// objetos são projetadas e testadas contra esses limites. Não faz chamadas
+// OpenGL, então roda sem contexto (benchmarks e modo headless).
+//
+// Profundidade em [0, 1], com 0 no near plane (z/w do NDC remapeado).
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "FrustumCulling.h"
+#include "ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_OCCLUSION_SIMD 1
+#else
+#define SOFTWARE_OCCLUSION_SIMD 0
+#endif
+
+// Geometria de um oclusor no espaço do objeto: posições e triângulos
+// (índices de 3 em 3). Pode ser a malha original ou um proxy simplificado.
+struct OccluderMesh {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+};
+
+class MaskedOcclusionBuffer {
+public:
+    static const int TILE_WIDTH = 8;
+    static const int TILE_HEIGHT = 4;
+
+    // Largura e altura são arredondadas para múltiplos do bloco.
+    void resize(int width, int height) {
+        tilesX = std::max(1, (width + TILE_WIDTH - 1) / TILE_WIDTH);
+        tilesY = std::max(1, (height + TILE_HEIGHT - 1) / TILE_HEIGHT);
+        bufferWidth = tilesX * TILE_WIDTH;
+        bufferHeight = tilesY * TILE_HEIGHT;
+        masks.resize((size_t)tilesX * tilesY);
+        zMax0.resize(masks.size());
+        zMax1.resize(masks.size());
+        clear();
+    }
+
+    int width() const { return bufferWidth; }
+    int height() const { return bufferHeight; }
+    size_t triangleCount() const { return triangles.size(); }
+
+    // Começa um quadro: esvazia o buffer e a lista de triângulos.
+    void begin(const glm::mat4& viewProjection) {
+        this->viewProjection = viewProjection;
+        triangles.clear();
+        clear();
+    }
+
+    // Projeta os triângulos do oclusor para a tela. Triângulos de costas,
+    // degenerados ou que cruzam o near plane são ignorados: sem recorte,
+    // descartar é a escolha conservadora (só reduz a oclusão).
+    void addOccluder(const OccluderMesh& mesh, const glm::mat4& model) {
+        glm::mat4 mvp = viewProjection * model;
+        clipPositions.resize(mesh.positions.size());
+        for (size_t i = 0; i < mesh.positions.size(); ++i) {
+            clipPositions[i] = mvp * glm::vec4(mesh.positions[i], 1.0f);
+        }
+        float halfWidth = bufferWidth * 0.5f;
+        float halfHeight = bufferHeight * 0.5f;
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            glm::vec3 screen[3];
+            bool usable = true;
+            for (int k = 0; k < 3 && usable; ++k) {
+                uint32_t index = mesh.indices[i + k];
+                if (index >= clipPositions.size()) { usable = false; break; }
+                const glm::vec4& clip = clipPositions[index];
+                if (clip.w <= 0.0f || clip.z < -clip.w) { usable = false; break; }
+                float invW = 1.0f / clip.w;
+                screen[k] = glm::vec3((clip.x * invW + 1.0f) * halfWidth,
+                                      (clip.y * invW + 1.0f) * halfHeight,
+                                      clip.z * invW * 0.5f + 0.5f);
+            }
+            if (usable) setupTriangle(screen);
+        }
+    }
+
+    // Rasteriza os triângulos acumulados. Cada tarefa cuida de uma faixa de
+    // linhas de blocos, então as threads nunca escrevem no mesmo bloco.
+    void rasterize(ThreadPool* pool = nullptr) {
+        size_t bands = pool ? std::min<size_t>((size_t)tilesY, pool->size() * 4) : 1;
+        auto task = [&](size_t band) {
+            int rowBegin = (int)(band * tilesY / bands);
+            int rowEnd = (int)((band + 1) * tilesY / bands);
+            for (const ScreenTriangle& triangle : triangles) {
+                rasterizeTriangle(triangle, rowBegin, rowEnd);
+            }
+        };
+        if (pool) pool->parallelFor(bands, task);
+        else task(0);
+    }
+
+    // true se a caixa (no mundo) está certamente atrás dos oclusores. Caixas
+    // que cruzam o near plane ou saem da tela nunca são dadas como ocultas.
+    bool isOccluded(const glm::vec3& center, const glm::vec3& extent) const {
+        float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, nearest = 1e30f;
+        for (int c = 0; c < 8; ++c) {
+            glm::vec3 corner = center + glm::vec3((c & 1) ? extent.x : -extent.x,
+                                                  (c & 2) ? extent.y : -extent.y,
+                                                  (c & 4) ? extent.z : -extent.z);
+            glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+            if (clip.w <= 0.0f || clip.z < -clip.w) return false;
+            float invW = 1.0f / clip.w;
+            float x = (clip.x * invW + 1.0f) * 0.5f * bufferWidth;
+            float y = (clip.y * invW + 1.0f) * 0.5f * bufferHeight;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            nearest = std::min(nearest, clip.z * invW * 0.5f + 0.5f);
+        }
+        // Os oclusores só cobrem pixels cujo centro está dentro do
+        // triângulo; a margem de um pixel compensa a borda não coberta.
+        int x0 = (int)std::floor(minX) - 1;
+        int x1 = (int)std::floor(maxX) + 1;
+        int y0 = (int)std::floor(minY) - 1;
+        int y1 = (int)std::floor(maxY) + 1;
+        if (x0 < 0 || y0 < 0 || x1 >= bufferWidth || y1 >= bufferHeight) return false;
+
+        for (int ty = y0 / TILE_HEIGHT; ty <= y1 / TILE_HEIGHT; ++ty) {
+            int rowFirst = std::max(y0 - ty * TILE_HEIGHT, 0);
+            int rowLast = std::min(y1 - ty * TILE_HEIGHT, TILE_HEIGHT - 1);
+            for (int tx = x0 / TILE_WIDTH; tx <= x1 / TILE_WIDTH; ++tx) {
+                int colFirst = std::max(x0 - tx * TILE_WIDTH, 0);
+                int colLast = std::min(x1 - tx * TILE_WIDTH, TILE_WIDTH - 1);
+                uint32_t rowBits = (0xFFu >> (TILE_WIDTH - 1 - colLast)) & (0xFFu << colFirst);
+                uint32_t query = 0;
+                for (int row = rowFirst; row <= rowLast; ++row) query |= rowBits << (row * TILE_WIDTH);
+
+                size_t tile = (size_t)ty * tilesX + tx;
+                float bound = (query & ~masks[tile]) == 0 ? std::min(zMax0[tile], zMax1[tile]) : zMax0[tile];
+                if (nearest <= bound) return false;
+            }
+        }
+        return true;
+    }
+
+    // Zera em `visible` as caixas ainda visíveis que estão ocultas e devolve
+    // quantas foram descartadas.
+    size_t cullOccluded(const CullingSet& set, std::vector<uint8_t>& visible, ThreadPool* pool = nullptr) const {
+        const size_t chunk = 256;
+        size_t chunks = (set.size() + chunk - 1) / chunk;
+        std::vector<size_t> culled(chunks, 0);
+        auto task = [&](size_t c) {
+            size_t end = std::min(set.size(), (c + 1) * chunk);
+            for (size_t i = c * chunk; i < end; ++i) {
+                if (!visible[i]) continue;
+                glm::vec3 center(set.centerX[i], set.centerY[i], set.centerZ[i]);
+                glm::vec3 extent(set.extentX[i], set.extentY[i], set.extentZ[i]);
+                if (isOccluded(center, extent)) {
+                    visible[i] = 0;
+                    culled[c]++;
+                }
+            }
+        };
+        if (pool) pool->parallelFor(chunks, task);
+        else for (size_t c = 0; c < chunks; ++c) task(c);
+        size_t total = 0;
+        for (size_t count : culled) total += count;
+        return total;
+    }
+
+    // Fração dos blocos com algum oclusor (zMax0 < 1 ou máscara não vazia).
+    float coverage() const {
+        size_t covered = 0;
+        for (size_t i = 0; i < masks.size(); ++i) covered += (masks[i] != 0 || zMax0[i] < 1.0f);
+        return masks.empty() ? 0.0f : (float)covered / masks.size();
+    }
+
+private:
+    // Triângulo na tela, com as equações de aresta A*x + B*y + C (positivas
+    // no interior) e o plano de profundidade z = z0 + dzdx*x + dzdy*y.
+    struct ScreenTriangle {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float z0, dzdx, dzdy, zMin, zMax;
+        int tileX0, tileX1, tileY0, tileY1;
+    };
+
+    void clear() {
+        std::fill(masks.begin(), masks.end(), 0u);
+        std::fill(zMax0.begin(), zMax0.end(), 1.0f);
+        std::fill(zMax1.begin(), zMax1.end(), 0.0f);
+    }
+
+    void setupTriangle(const glm::vec3 v[3]) {
+        float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+        if (area <= 0.0f) return;
+
+        float minX = std::min({ v[0].x, v[1].x, v[2].x });
+        float maxX = std::max({ v[0].x, v[1].x, v[2].x });
+        float minY = std::min({ v[0].y, v[1].y, v[2].y });
+        float maxY = std::max({ v[0].y, v[1].y, v[2].y });
+        if (maxX < 0.0f || maxY < 0.0f || minX >= bufferWidth || minY >= bufferHeight) return;
+
+        ScreenTriangle t;
+        t.zMin = std::min({ v[0].z, v[1].z, v[2].z });
+        t.zMax = std::min(1.0f, std::max({ v[0].z, v[1].z, v[2].z }));
+        if (t.zMin >= 1.0f) return;
+        // A aresta é sempre montada a partir do vértice "menor", e o vizinho
+        // que a compartilha obtém exatamente os valores negados: um pixel
+        // sobre a emenda nunca fica de fora dos dois triângulos.
+        for (int e = 0; e < 3; ++e) {
+            const glm::vec3* a = &v[e];
+            const glm::vec3* b = &v[(e + 1) % 3];
+            bool flipped = b->x < a->x || (b->x == a->x && b->y < a->y);
+            if (flipped) std::swap(a, b);
+            float sign = flipped ? -1.0f : 1.0f;
+            float edgeA = a->y - b->y;
+            float edgeB = b->x - a->x;
+            t.edgeA[e] = sign * edgeA;
+            t.edgeB[e] = sign * edgeB;
+            t.edgeC[e] = sign * -(edgeA * a->x + edgeB * a->y);
+        }
+        glm::vec3 e1 = v[1] - v[0];
+        glm::vec3 e2 = v[2] - v[0];
+        t.dzdx = (e1.z * e2.y - e2.z * e1.y) / area;
+        t.dzdy = (e2.z * e1.x - e1.z * e2.x) / area;
+        t.z0 = v[0].z - t.dzdx * v[0].x - t.dzdy * v[0].y;
+        t.tileX0 = std::max(0, (int)std::floor(minX) / TILE_WIDTH);
+        t.tileX1 = std::min(tilesX - 1, (int)std::floor(maxX) / TILE_WIDTH);
+        t.tileY0 = std::max(0, (int)std::floor(minY) / TILE_HEIGHT);
+        t.tileY1 = std::min(tilesY - 1, (int)std::floor(maxY) / TILE_HEIGHT);
+        triangles.push_back(t);
+    }
+
+    // Máscara dos pixels do bloco (bit y * 8 + x) cujo centro está dentro
+    // do triângulo.
+    static uint32_t coverageMask(const ScreenTriangle& t, float tileX, float tileY) {
+        uint32_t mask = 0;
+#if SOFTWARE_OCCLUSION_SIMD
+        __m128 zero = _mm_setzero_ps();
+        __m128 offsetLow = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        __m128 offsetHigh = _mm_setr_ps(4.5f, 5.5f, 6.5f, 7.5f);
+        __m128 rowStart[3], stepLow[3], stepHigh[3];
+        for (int e = 0; e < 3; ++e) {
+            __m128 a = _mm_set1_ps(t.edgeA[e]);
+            __m128 base = _mm_set1_ps(t.edgeA[e] * tileX + t.edgeB[e] * (tileY + 0.5f) + t.edgeC[e]);
+            stepLow[e] = _mm_add_ps(base, _mm_mul_ps(a, offsetLow));
+            stepHigh[e] = _mm_add_ps(base, _mm_mul_ps(a, offsetHigh));
+            rowStart[e] = _mm_set1_ps(t.edgeB[e]);
+        }
+        for (int row = 0; row < TILE_HEIGHT; ++row) {
+            __m128 insideLow = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(stepLow[0], zero), _mm_cmpge_ps(stepLow[1], zero)),
+                                          _mm_cmpge_ps(stepLow[2], zero));
+            __m128 insideHigh = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(stepHigh[0], zero), _mm_cmpge_ps(stepHigh[1], zero)),
+                                           _mm_cmpge_ps(stepHigh[2], zero));
+            uint32_t bits = (uint32_t)_mm_movemask_ps(insideLow) | ((uint32_t)_mm_movemask_ps(insideHigh) << 4);
+            mask |= bits << (row * TILE_WIDTH);
+            for (int e = 0; e < 3; ++e) {
+                stepLow[e] = _mm_add_ps(stepLow[e], rowStart[e]);
+                stepHigh[e] = _mm_add_ps(stepHigh[e], rowStart[e]);
+            }
+        }
+#else
+        for (int row = 0; row < TILE_HEIGHT; ++row) {
+            float y = tileY + row + 0.5f;
+            for (int col = 0; col < TILE_WIDTH; ++col) {
+                float x = tileX + col + 0.5f;
+                bool inside = true;
+                for (int e = 0; e < 3; ++e) inside = inside && t.edgeA[e] * x + t.edgeB[e] * y + t.edgeC[e] >= 0.0f;
+                if (inside) mask |= 1u << (row * TILE_WIDTH + col);
+            }
+        }
+#endif
+        return mask;
+    }
+
+    void rasterizeTriangle(const ScreenTriangle& t, int rowBegin, int rowEnd) {
+        int ty0 = std::max(t.tileY0, rowBegin);
+        int ty1 = std::min(t.tileY1, rowEnd - 1);
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            float tileY = (float)(ty * TILE_HEIGHT);
+            for (int tx = t.tileX0; tx <= t.tileX1; ++tx) {
+                size_t tile = (size_t)ty * tilesX + tx;
+                // Descarte rápido: o triângulo inteiro está atrás do bloco.
+                if (t.zMin >= zMax0[tile]) continue;
+                float tileX = (float)(tx * TILE_WIDTH);
+                uint32_t triangleMask = coverageMask(t, tileX, tileY);
+                if (triangleMask == 0) continue;
+
+                // Maior profundidade do plano no bloco: o canto na direção
+                // do gradiente, limitada aos vértices do triângulo.
+                float cornerX = tileX + (t.dzdx > 0.0f ? TILE_WIDTH : 0);
+                float cornerY = tileY + (t.dzdy > 0.0f ? TILE_HEIGHT : 0);
+                float triangleZ = t.z0 + t.dzdx * cornerX + t.dzdy * cornerY;
+                triangleZ = std::min(std::min(triangleZ, t.zMax), zMax0[tile]);
+                updateTile(tile, triangleMask, triangleZ);
+            }
+        }
+    }
+
+    // Heurística de mescla do artigo: se o triângulo está bem mais perto
+    // que a camada de trabalho, ela é descartada e recomeça com ele; quando
+    // a máscara enche, a camada de trabalho vira o novo limite do bloco.
+    void updateTile(size_t tile, uint32_t triangleMask, float triangleZ) {
+        float distanceToWorking = zMax1[tile] - triangleZ;
+        float distanceWorkingToBase = zMax0[tile] - zMax1[tile];
+        if (distanceToWorking > distanceWorkingToBase) {
+            zMax1[tile] = 0.0f;
+            masks[tile] = 0;
+        }
+        zMax1[tile] = std::max(zMax1[tile], triangleZ);
+        masks[tile] |= triangleMask;
+        if (masks[tile] == 0xFFFFFFFFu) {
+            zMax0[tile] = zMax1[tile];
+            zMax1[tile] = 0.0f;
+            masks[tile] = 0;
+        }
+    }
+
+    int tilesX = 0, tilesY = 0;
+    int bufferWidth = 0, bufferHeight = 0;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    std::vector<uint32_t> masks;
+    std::vector<float> zMax0, zMax1;
+    std::vector<ScreenTriangle> triangles;
+    std::vector<glm::vec4> clipPositions;
+};
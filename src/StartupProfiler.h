@@ -0,0 +1,202 @@
+#pragma once
+
+// Tempos da partida do Final, do início do processo ao primeiro quadro:
+// fases (inicialização do GLFW/GL, shaders, configuração, parse de OBJ e
+// MTL, cache de malhas, decodificação de imagens, mipmaps e envio à GPU)
+// somadas no total e por recurso, com a tabela de resumo, os recursos acima
+// de um orçamento e a gravação em JSON. Não faz chamadas OpenGL.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum StartupPhase {
+    STARTUP_PHASE_INIT,
+    STARTUP_PHASE_SHADERS,
+    STARTUP_PHASE_CONFIG,
+    STARTUP_PHASE_OBJ_PARSE,
+    STARTUP_PHASE_MESH_CACHE,
+    STARTUP_PHASE_MTL_PARSE,
+    STARTUP_PHASE_IMAGE_DECODE,
+    STARTUP_PHASE_MIPMAPS,
+    STARTUP_PHASE_GPU_UPLOAD,
+    STARTUP_PHASE_COUNT
+};
+
+inline const char* startupPhaseName(int phase) {
+    static const char* const NAMES[STARTUP_PHASE_COUNT] = {
+        "inicializacao GLFW/GL", "shaders", "configuracao", "parse de OBJ", "cache de malhas",
+        "parse de MTL", "decodificacao de imagens", "mipmaps", "envio a GPU",
+    };
+    return phase >= 0 && phase < STARTUP_PHASE_COUNT ? NAMES[phase] : "?";
+}
+
+// Tempo de um recurso (OBJ, textura, arquivo de cena) em cada fase, em ms.
+struct StartupAsset {
+    std::string name;
+    double phases[STARTUP_PHASE_COUNT] = {};
+    double total = 0.0;
+};
+
+class StartupProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    StartupProfiler() : epoch(Clock::now()) {}
+
+    void setEnabled(bool value) { active = value; }
+    bool enabled() const { return active; }
+
+    // Recursos cujo tempo somado passa de `ms` são marcados como lentos.
+    void setBudget(double ms) { budgetMs = ms; }
+    double budget() const { return budgetMs; }
+
+    // Milissegundos desde a criação do perfil (a inicialização estática).
+    double elapsedMs() const { return std::chrono::duration<double, std::milli>(Clock::now() - epoch).count(); }
+
+    // Soma `ms` na fase e, com `asset` não vazio, no recurso. Depois de
+    // finish() nada mais é somado: recursos carregados durante a execução
+    // não entram no relatório da partida.
+    void add(StartupPhase phase, const std::string& asset, double ms) {
+        if (!active || done) return;
+        phaseTotals[phase] += ms;
+        phaseCounts[phase]++;
+        if (asset.empty()) return;
+        auto it = assetIndex.find(asset);
+        if (it == assetIndex.end()) {
+            it = assetIndex.emplace(asset, assetList.size()).first;
+            assetList.emplace_back();
+            assetList.back().name = asset;
+        }
+        StartupAsset& entry = assetList[it->second];
+        entry.phases[phase] += ms;
+        entry.total += ms;
+    }
+
+    // Fecha a medida; `totalMs` é o tempo até o primeiro quadro.
+    void finish(double totalMs) {
+        if (done) return;
+        total = totalMs;
+        done = true;
+    }
+
+    bool finished() const { return done; }
+    double totalMs() const { return total; }
+    double phaseTime(int phase) const { return phaseTotals[phase]; }
+    size_t phaseCount(int phase) const { return phaseCounts[phase]; }
+
+    // O que as fases não cobrem: criação de buffers, luzes, o primeiro quadro.
+    double otherMs() const {
+        double measured = 0.0;
+        for (double ms : phaseTotals) measured += ms;
+        return std::max(0.0, total - measured);
+    }
+
+    // Recursos na ordem em que apareceram.
+    const std::vector<StartupAsset>& assets() const { return assetList; }
+    bool slow(const StartupAsset& asset) const { return budgetMs > 0.0 && asset.total > budgetMs; }
+
+    size_t slowCount() const {
+        size_t count = 0;
+        for (const StartupAsset& asset : assetList) count += slow(asset) ? 1 : 0;
+        return count;
+    }
+
+    // Tabela das fases e dos recursos, do mais lento ao mais rápido.
+    void print(FILE* out) const {
+        fprintf(out, "Partida: %.1f ms ate o primeiro quadro\n", total);
+        fprintf(out, "  %-26s %10s %7s %7s\n", "fase", "ms", "%", "vezes");
+        for (int phase = 0; phase < STARTUP_PHASE_COUNT; ++phase) {
+            if (phaseCounts[phase] == 0) continue;
+            fprintf(out, "  %-26s %10.2f %6.1f%% %7zu\n", startupPhaseName(phase), phaseTotals[phase], percent(phaseTotals[phase]),
+                    phaseCounts[phase]);
+        }
+        fprintf(out, "  %-26s %10.2f %6.1f%%\n", "outros", otherMs(), percent(otherMs()));
+        if (assetList.empty()) return;
+
+        std::vector<const StartupAsset*> sorted;
+        for (const StartupAsset& asset : assetList) sorted.push_back(&asset);
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [](const StartupAsset* a, const StartupAsset* b) { return a->total > b->total; });
+        fprintf(out, "  %-40s %10s  fases (ms)\n", "recurso", "ms");
+        for (const StartupAsset* asset : sorted) {
+            std::string breakdown;
+            char part[64];
+            for (int phase = 0; phase < STARTUP_PHASE_COUNT; ++phase) {
+                if (asset->phases[phase] <= 0.0) continue;
+                snprintf(part, sizeof(part), "%s%s %.2f", breakdown.empty() ? "" : ", ", startupPhaseName(phase), asset->phases[phase]);
+                breakdown += part;
+            }
+            fprintf(out, "  %-40s %10.2f  %s%s\n", asset->name.c_str(), asset->total, breakdown.c_str(), slow(*asset) ? "  LENTO" : "");
+        }
+        if (size_t count = slowCount()) fprintf(out, "  %zu recurso(s) acima do orcamento de %.1f ms\n", count, budgetMs);
+    }
+
+    // {"total_ms", "other_ms", "budget_ms", "phases": [{"name", "ms", "count"}],
+    //  "assets": [{"name", "ms", "slow", "phases": {"fase": ms}}]}
+    bool writeJson(const std::string& path) const {
+        FILE* f = fopen(path.c_str(), "w");
+        if (!f) return false;
+        fprintf(f, "{\"total_ms\":%.3f,\"other_ms\":%.3f,\"budget_ms\":%.3f,\"phases\":[", total, otherMs(), budgetMs);
+        bool first = true;
+        for (int phase = 0; phase < STARTUP_PHASE_COUNT; ++phase) {
+            if (phaseCounts[phase] == 0) continue;
+            fprintf(f, "%s\n{\"name\":\"%s\",\"ms\":%.3f,\"count\":%zu}", first ? "" : ",", startupPhaseName(phase), phaseTotals[phase],
+                    phaseCounts[phase]);
+            first = false;
+        }
+        fprintf(f, "\n],\"assets\":[");
+        for (size_t i = 0; i < assetList.size(); ++i) {
+            const StartupAsset& asset = assetList[i];
+            fprintf(f, "%s\n{\"name\":\"", i == 0 ? "" : ",");
+            for (char c : asset.name) {
+                if (c == '"' || c == '\\') fputc('\\', f);
+                fputc(c, f);
+            }
+            fprintf(f, "\",\"ms\":%.3f,\"slow\":%s,\"phases\":{", asset.total, slow(asset) ? "true" : "false");
+            bool firstPhase = true;
+            for (int phase = 0; phase < STARTUP_PHASE_COUNT; ++phase) {
+                if (asset.phases[phase] <= 0.0) continue;
+                fprintf(f, "%s\"%s\":%.3f", firstPhase ? "" : ",", startupPhaseName(phase), asset.phases[phase]);
+                firstPhase = false;
+            }
+            fprintf(f, "}}");
+        }
+        fprintf(f, "\n]}\n");
+        return fclose(f) == 0;
+    }
+
+private:
+    double percent(double ms) const { return total > 0.0 ? 100.0 * ms / total : 0.0; }
+
+    bool active = true;
+    bool done = false;
+    double budgetMs = 100.0;
+    double total = 0.0;
+    double phaseTotals[STARTUP_PHASE_COUNT] = {};
+    size_t phaseCounts[STARTUP_PHASE_COUNT] = {};
+    Clock::time_point epoch;
+    std::vector<StartupAsset> assetList;
+    std::unordered_map<std::string, size_t> assetIndex;
+};
+
+// Mede o bloco em que é declarado e soma na fase e no recurso.
+class StartupScope {
+public:
+    StartupScope(StartupProfiler& profiler, StartupPhase phase, const std::string& asset)
+        : profiler(profiler), phase(phase), asset(asset), start(StartupProfiler::Clock::now()) {}
+    ~StartupScope() {
+        profiler.add(phase, asset, std::chrono::duration<double, std::milli>(StartupProfiler::Clock::now() - start).count());
+    }
+    StartupScope(const StartupScope&) = delete;
+    StartupScope& operator=(const StartupScope&) = delete;
+
+private:
+    StartupProfiler& profiler;
+    StartupPhase phase;
+    std::string asset;
+    StartupProfiler::Clock::time_point start;
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+// Pool de threads fixo para laços paralelos. A thread que chama parallelFor
+// também executa tarefas e só retorna quando todas terminarem.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // 0 = número de núcleos da máquina.
+    explicit ThreadPool(unsigned threadCount = 0) {
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 1; i < threadCount; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeWorkers.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return (unsigned)workers.size() + 1; }
+
+    // Executa task(i) para i em [0, count), com count < 2^32.
+    void parallelFor(size_t count, const std::function<void(size_t)>& task) {
+        if (count == 0) return;
+        if (workers.empty() || count == 1) {
+            for (size_t i = 0; i < count; ++i) task(i);
+            return;
+        }
+        Batch batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            generation++;
+            batch = { (uint32_t)generation, &task, count };
+            currentBatch = batch;
+            pending = count;
+            cursor = (uint64_t)batch.generation << 32;
+        }
+        wakeWorkers.notify_all();
+        runTasks(batch);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        allDone.wait(lock, [this] { return pending == 0; });
+        currentBatch = Batch();
+    }
+
+private:
+    // Um parallelFor: a geração, a tarefa e a quantidade são lidas juntas,
+    // sob o mutex, por quem vai executar o lote.
+    struct Batch {
+        uint32_t generation = 0;
+        const std::function<void(size_t)>* task = nullptr;
+        size_t count = 0;
+    };
+
+    // O cursor guarda a geração nos 32 bits altos e o próximo índice nos
+    // baixos. Um índice só é tomado se a geração ainda for a do lote, então
+    // uma thread atrasada nunca pega índices (nem a tarefa) do lote seguinte.
+    bool claim(const Batch& batch, size_t& index) {
+        uint64_t current = cursor.load();
+        while (true) {
+            if ((uint32_t)(current >> 32) != batch.generation || (current & 0xffffffffu) >= batch.count) return false;
+            if (cursor.compare_exchange_weak(current, current + 1)) {
+                index = (size_t)(current & 0xffffffffu);
+                return true;
+            }
+        }
+    }
+
+    void runTasks(const Batch& batch) {
+        size_t done = 0;
+        size_t i = 0;
+        while (claim(batch, i)) {
+            (*batch.task)(i);
+            done++;
+        }
+        if (done > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending -= done;
+            if (pending == 0) allDone.notify_all();
+        }
+    }
+
+    void workerLoop() {
+        size_t seenGeneration = 0;
+        while (true) {
+            Batch batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeWorkers.wait(lock, [&] { return stopping || generation != seenGeneration; });
+                if (stopping) return;
+                seenGeneration = generation;
+                batch = currentBatch;
+            }
+            if (batch.task) runTasks(batch);
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable allDone;
+    Batch currentBatch;
+    std::atomic<uint64_t> cursor{0};
+    size_t pending = 0;
+    size_t generation = 0;
+    bool stopping = false;
+};